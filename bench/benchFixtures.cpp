@@ -0,0 +1,365 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "oamlCore.h"
+#include "benchFixtures.h"
+
+#ifdef HAVE_VORBISENC
+#include <vorbis/vorbisenc.h>
+#endif
+
+#define BENCH_PI		3.14159265358979323846
+#define BENCH_BLOCK_FRAMES	4096
+
+typedef struct {
+	int type;
+	unsigned int sampleRate;
+	int format;
+	int channels;
+	int seconds;
+} benchFixtureSpec;
+
+static const benchFixtureSpec fixtureSpecs[] = {
+	{ BENCH_WAV, 44100, AF_FORMAT_SINT16, 2, 30 },
+	{ BENCH_WAV, 22050, AF_FORMAT_SINT16, 1, 30 },
+	{ BENCH_WAV, 48000, AF_FORMAT_SINT24, 2, 30 },
+	{ BENCH_WAV, 96000, AF_FORMAT_SINT32, 2, 10 },
+	{ BENCH_WAV, 48000, AF_FORMAT_FLOAT32, 2, 10 },
+	{ BENCH_AIF, 44100, AF_FORMAT_SINT16, 2, 30 },
+	{ BENCH_AIF, 22050, AF_FORMAT_SINT8, 1, 30 },
+	{ BENCH_AIF, 48000, AF_FORMAT_SINT24, 2, 30 },
+	{ BENCH_OGG, 44100, AF_FORMAT_SINT16, 2, 30 },
+	{ BENCH_OGG, 22050, AF_FORMAT_SINT16, 1, 30 }
+};
+
+static const char *FormatName(int format) {
+	switch (format) {
+		case AF_FORMAT_SINT8: return "8";
+		case AF_FORMAT_SINT16: return "16";
+		case AF_FORMAT_SINT24: return "24";
+		case AF_FORMAT_SINT32: return "32";
+		case AF_FORMAT_FLOAT32: return "32f";
+	}
+	return "?";
+}
+
+static int FormatBytes(int format) {
+	switch (format) {
+		case AF_FORMAT_SINT8: return 1;
+		case AF_FORMAT_SINT24: return 3;
+		case AF_FORMAT_SINT32: return 4;
+		case AF_FORMAT_FLOAT32: return 4;
+	}
+	return 2;
+}
+
+bool BenchCanWriteOgg() {
+#ifdef HAVE_VORBISENC
+	return true;
+#else
+	return false;
+#endif
+}
+
+void BenchFixtureList(std::vector<benchFixture>& list, bool quick) {
+	static const char *typeNames[] = { "wav", "aif", "ogg" };
+
+	list.clear();
+	for (size_t i=0; i<sizeof(fixtureSpecs)/sizeof(fixtureSpecs[0]); i++) {
+		const benchFixtureSpec& spec = fixtureSpecs[i];
+
+		benchFixture fixture;
+		fixture.type = spec.type;
+		fixture.sampleRate = spec.sampleRate;
+		fixture.format = spec.format;
+		fixture.channels = spec.channels;
+		fixture.seconds = quick ? 5 : spec.seconds;
+
+		char name[64];
+		snprintf(name, sizeof(name), "%s_%u_%s_%dch_%ds", typeNames[spec.type], spec.sampleRate, spec.type == BENCH_OGG ? "q4" : FormatName(spec.format), spec.channels, (int)fixture.seconds);
+		fixture.name = name;
+
+		list.push_back(fixture);
+	}
+}
+
+// Two detuned tones per channel plus some noise, so the encoders and the
+// peak reduction see something closer to music than silence
+static void Synthesize(float *out, int frames, int channels, unsigned int sampleRate, long long start, unsigned int *seed) {
+	for (int i=0; i<frames; i++) {
+		double t = (double)(start + i) / sampleRate;
+		for (int c=0; c<channels; c++) {
+			double freq = 220.0 * (c + 1);
+			*seed = *seed * 1103515245 + 12345;
+			float noise = ((*seed >> 16) & 0x7fff) / 32768.0f - 0.5f;
+
+			out[i*channels+c] = (float)(0.4 * sin(2 * BENCH_PI * freq * t) + 0.2 * sin(2 * BENCH_PI * freq * 2.01 * t)) + noise * 0.1f;
+		}
+	}
+}
+
+static int WriteWav(benchFixture& fixture) {
+	wavWriter writer;
+	if (writer.Open(fixture.path.c_str(), fixture.channels, fixture.sampleRate, fixture.format) == -1)
+		return -1;
+
+	std::vector<float> buf(BENCH_BLOCK_FRAMES * fixture.channels);
+	long long total = (long long)(fixture.sampleRate * fixture.seconds);
+	unsigned int seed = 1;
+
+	for (long long pos = 0; pos < total; pos+= BENCH_BLOCK_FRAMES) {
+		int frames = total - pos < BENCH_BLOCK_FRAMES ? (int)(total - pos) : BENCH_BLOCK_FRAMES;
+		Synthesize(&buf[0], frames, fixture.channels, fixture.sampleRate, pos, &seed);
+		if (writer.WriteFloat(&buf[0], frames * fixture.channels) == -1) {
+			writer.Close();
+			return -1;
+		}
+	}
+
+	return writer.Close();
+}
+
+static void put16be(uint8_t *p, unsigned int value) {
+	p[0] = (value >> 8) & 0xff;
+	p[1] = value & 0xff;
+}
+
+static void put32be(uint8_t *p, unsigned int value) {
+	p[0] = (value >> 24) & 0xff;
+	p[1] = (value >> 16) & 0xff;
+	p[2] = (value >> 8) & 0xff;
+	p[3] = value & 0xff;
+}
+
+// Inverse of ConvertFromIeeeExtended in aif.cpp, for integer rates only
+static void putExtended(uint8_t *p, unsigned int value) {
+	memset(p, 0, 10);
+	if (value == 0)
+		return;
+
+	int shift = 0;
+	while ((value >> shift) > 1) shift++;
+
+	int expon = 16383 + shift;
+	uint64_t mant = (uint64_t)value << (63 - shift);
+
+	p[0] = (expon >> 8) & 0x7f;
+	p[1] = expon & 0xff;
+	for (int i=0; i<8; i++) {
+		p[2+i] = (mant >> (56 - i*8)) & 0xff;
+	}
+}
+
+static int WriteAif(benchFixture& fixture) {
+	int bytesPerSample = FormatBytes(fixture.format);
+	if (fixture.format == AF_FORMAT_FLOAT32)
+		return -1;
+
+	FILE *f = fopen(fixture.path.c_str(), "wb");
+	if (f == NULL)
+		return -1;
+
+	unsigned int frames = (unsigned int)(fixture.sampleRate * fixture.seconds);
+	unsigned int dataBytes = frames * fixture.channels * bytesPerSample;
+
+	uint8_t header[54];
+	memcpy(header, "FORM", 4);
+	put32be(header + 4, 4 + 26 + 16 + dataBytes + (dataBytes & 1));
+	memcpy(header + 8, "AIFF", 4);
+	memcpy(header + 12, "COMM", 4);
+	put32be(header + 16, 18);
+	put16be(header + 20, fixture.channels);
+	put32be(header + 22, frames);
+	put16be(header + 26, bytesPerSample * 8);
+	putExtended(header + 28, fixture.sampleRate);
+	memcpy(header + 38, "SSND", 4);
+	put32be(header + 42, 8 + dataBytes);
+	put32be(header + 46, 0);
+	put32be(header + 50, 0);
+
+	if (fwrite(header, 1, sizeof(header), f) != sizeof(header)) {
+		fclose(f);
+		return -1;
+	}
+
+	std::vector<float> buf(BENCH_BLOCK_FRAMES * fixture.channels);
+	std::vector<uint8_t> out(BENCH_BLOCK_FRAMES * fixture.channels * bytesPerSample);
+	unsigned int seed = 1;
+
+	for (unsigned int pos = 0; pos < frames; pos+= BENCH_BLOCK_FRAMES) {
+		int count = frames - pos < BENCH_BLOCK_FRAMES ? (int)(frames - pos) : BENCH_BLOCK_FRAMES;
+		Synthesize(&buf[0], count, fixture.channels, fixture.sampleRate, pos, &seed);
+
+		uint8_t *p = &out[0];
+		for (int i=0; i<count * fixture.channels; i++) {
+			int32_t s = (int32_t)(buf[i] * 2147483647.0);
+			for (int b=0; b<bytesPerSample; b++) {
+				p[b] = (s >> (24 - b*8)) & 0xff;
+			}
+			p+= bytesPerSample;
+		}
+
+		size_t bytes = count * fixture.channels * bytesPerSample;
+		if (fwrite(&out[0], 1, bytes, f) != bytes) {
+			fclose(f);
+			return -1;
+		}
+	}
+
+	if (dataBytes & 1) {
+		fputc(0, f);
+	}
+
+	return fclose(f) == 0 ? 0 : -1;
+}
+
+#ifdef HAVE_VORBISENC
+static int WriteOggPages(FILE *f, ogg_stream_state *os, bool flush) {
+	ogg_page og;
+
+	while (flush ? ogg_stream_flush(os, &og) : ogg_stream_pageout(os, &og)) {
+		if (fwrite(og.header, 1, og.header_len, f) != (size_t)og.header_len)
+			return -1;
+		if (fwrite(og.body, 1, og.body_len, f) != (size_t)og.body_len)
+			return -1;
+	}
+
+	return 0;
+}
+
+static int EncodeOggBlocks(FILE *f, vorbis_dsp_state *vd, vorbis_block *vb, ogg_stream_state *os) {
+	ogg_packet op;
+
+	while (vorbis_analysis_blockout(vd, vb) == 1) {
+		vorbis_analysis(vb, NULL);
+		vorbis_bitrate_addblock(vb);
+
+		while (vorbis_bitrate_flushpacket(vd, &op)) {
+			ogg_stream_packetin(os, &op);
+			if (WriteOggPages(f, os, false) == -1)
+				return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int WriteOgg(benchFixture& fixture) {
+	FILE *f = fopen(fixture.path.c_str(), "wb");
+	if (f == NULL)
+		return -1;
+
+	vorbis_info vi;
+	vorbis_info_init(&vi);
+	if (vorbis_encode_init_vbr(&vi, fixture.channels, fixture.sampleRate, 0.4f) != 0) {
+		vorbis_info_clear(&vi);
+		fclose(f);
+		return -1;
+	}
+
+	vorbis_comment vc;
+	vorbis_dsp_state vd;
+	vorbis_block vb;
+	ogg_stream_state os;
+
+	vorbis_comment_init(&vc);
+	vorbis_analysis_init(&vd, &vi);
+	vorbis_block_init(&vd, &vb);
+	ogg_stream_init(&os, 1);
+
+	ogg_packet header, headerComm, headerCode;
+	vorbis_analysis_headerout(&vd, &vc, &header, &headerComm, &headerCode);
+	ogg_stream_packetin(&os, &header);
+	ogg_stream_packetin(&os, &headerComm);
+	ogg_stream_packetin(&os, &headerCode);
+
+	int ret = WriteOggPages(f, &os, true);
+
+	std::vector<float> buf(BENCH_BLOCK_FRAMES * fixture.channels);
+	long long total = (long long)(fixture.sampleRate * fixture.seconds);
+	unsigned int seed = 1;
+
+	for (long long pos = 0; pos < total && ret == 0; pos+= BENCH_BLOCK_FRAMES) {
+		int frames = total - pos < BENCH_BLOCK_FRAMES ? (int)(total - pos) : BENCH_BLOCK_FRAMES;
+		Synthesize(&buf[0], frames, fixture.channels, fixture.sampleRate, pos, &seed);
+
+		float **in = vorbis_analysis_buffer(&vd, frames);
+		for (int i=0; i<frames; i++) {
+			for (int c=0; c<fixture.channels; c++) {
+				in[c][i] = buf[i*fixture.channels+c];
+			}
+		}
+		vorbis_analysis_wrote(&vd, frames);
+
+		ret = EncodeOggBlocks(f, &vd, &vb, &os);
+	}
+
+	if (ret == 0) {
+		vorbis_analysis_wrote(&vd, 0);
+		ret = EncodeOggBlocks(f, &vd, &vb, &os);
+	}
+	if (ret == 0) {
+		ret = WriteOggPages(f, &os, true);
+	}
+
+	ogg_stream_clear(&os);
+	vorbis_block_clear(&vb);
+	vorbis_dsp_clear(&vd);
+	vorbis_comment_clear(&vc);
+	vorbis_info_clear(&vi);
+
+	if (fclose(f) != 0)
+		return -1;
+	return ret;
+}
+#endif
+
+int BenchWriteFixture(benchFixture& fixture, std::string dir) {
+	static const char *extensions[] = { ".wav", ".aif", ".ogg" };
+
+	fixture.path = dir + "bench_" + fixture.name + extensions[fixture.type];
+	return BenchWriteFile(fixture);
+}
+
+int BenchWriteFile(benchFixture& fixture) {
+	switch (fixture.type) {
+		case BENCH_WAV:
+			return WriteWav(fixture);
+
+		case BENCH_AIF:
+			return WriteAif(fixture);
+
+		case BENCH_OGG:
+#ifdef HAVE_VORBISENC
+			return WriteOgg(fixture);
+#else
+			return -1;
+#endif
+	}
+
+	return -1;
+}
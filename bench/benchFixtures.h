@@ -0,0 +1,50 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __BENCHFIXTURES_H__
+#define __BENCHFIXTURES_H__
+
+enum {
+	BENCH_WAV,
+	BENCH_AIF,
+	BENCH_OGG
+};
+
+typedef struct {
+	int type;
+	unsigned int sampleRate;
+	int format;
+	int channels;
+	double seconds;
+	std::string name;
+	std::string path;
+} benchFixture;
+
+// Synthetic audio files used by oamlStudio-bench. The signal is a mix of
+// tones and noise generated from a fixed seed, so every run decodes the
+// same data and results can be compared between builds.
+void BenchFixtureList(std::vector<benchFixture>& list, bool quick);
+int BenchWriteFixture(benchFixture& fixture, std::string dir);
+int BenchWriteFile(benchFixture& fixture);
+bool BenchCanWriteOgg();
+
+#endif /* __BENCHFIXTURES_H__ */
@@ -0,0 +1,340 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "oamlCore.h"
+#include "benchFixtures.h"
+
+
+typedef struct {
+	const char *name;
+	int tracks;
+	int audios;
+	int layers;
+	int sfxTracks;
+	int pool;
+} genPreset;
+
+// Standard sizes, see the README before changing them as scaling results
+// are only comparable between runs of the same preset
+static const genPreset presets[] = {
+	{ "S",    4,  4, 1, 0,   0 },
+	{ "M",   16,  8, 2, 1,   0 },
+	{ "L",   64, 12, 3, 2,   0 },
+	{ "XL", 256, 16, 4, 4, 512 }
+};
+
+typedef struct {
+	int tracks;
+	int audios;
+	int layers;
+	int sfxTracks;
+	float condDensity;
+	int bars;
+	float bpm;
+	int beatsPerBar;
+	int type;
+	int format;
+	unsigned int sampleRate;
+	int channels;
+	int pool;
+	unsigned int seed;
+} genOptions;
+
+static void GenUsage() {
+	fprintf(stderr, "usage: oamlStudio-gen --out <dir> [options]\n");
+	fprintf(stderr, "  --size <S|M|L|XL>     standard project size (default S)\n");
+	fprintf(stderr, "  --tracks <n>          music tracks\n");
+	fprintf(stderr, "  --audios <n>          audios per track\n");
+	fprintf(stderr, "  --layers <n>          files per audio, one per layer\n");
+	fprintf(stderr, "  --sfx-tracks <n>      sfx tracks, with --audios sfxs each\n");
+	fprintf(stderr, "  --cond-density <f>    fraction of the loops that are conditional (default 0.5)\n");
+	fprintf(stderr, "  --bars <n>            length of every audio in bars (default 2)\n");
+	fprintf(stderr, "  --bpm <n>             tempo (default 120)\n");
+	fprintf(stderr, "  --format <name>       wav16, wav24, wavf, aif16, aif24 or ogg (default wav16)\n");
+	fprintf(stderr, "  --rate <n>            sample rate (default 22050)\n");
+	fprintf(stderr, "  --channels <n>        channels (default 1)\n");
+	fprintf(stderr, "  --pool <n>            distinct audio files to generate, 0 for one per reference\n");
+	fprintf(stderr, "  --seed <n>            random seed (default 1)\n");
+}
+
+static bool GenSetFormat(genOptions& opts, const char *name) {
+	static const struct { const char *name; int type; int format; } formats[] = {
+		{ "wav16", BENCH_WAV, AF_FORMAT_SINT16 },
+		{ "wav24", BENCH_WAV, AF_FORMAT_SINT24 },
+		{ "wavf",  BENCH_WAV, AF_FORMAT_FLOAT32 },
+		{ "aif16", BENCH_AIF, AF_FORMAT_SINT16 },
+		{ "aif24", BENCH_AIF, AF_FORMAT_SINT24 },
+		{ "ogg",   BENCH_OGG, AF_FORMAT_SINT16 }
+	};
+
+	for (size_t i=0; i<sizeof(formats)/sizeof(formats[0]); i++) {
+		if (strcmp(formats[i].name, name) == 0) {
+			opts.type = formats[i].type;
+			opts.format = formats[i].format;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool GenSetPreset(genOptions& opts, const char *name) {
+	for (size_t i=0; i<sizeof(presets)/sizeof(presets[0]); i++) {
+		if (strcmp(presets[i].name, name) == 0) {
+			opts.tracks = presets[i].tracks;
+			opts.audios = presets[i].audios;
+			opts.layers = presets[i].layers;
+			opts.sfxTracks = presets[i].sfxTracks;
+			opts.pool = presets[i].pool;
+			return true;
+		}
+	}
+	return false;
+}
+
+static unsigned int GenRandom(unsigned int *seed) {
+	*seed = *seed * 1103515245 + 12345;
+	return (*seed >> 16) & 0x7fff;
+}
+
+// Returns the filename for the n-th file reference, files are shared
+// round robin once the pool is used up
+static std::string GenFileName(const genOptions& opts, int ref, std::vector<std::string>& files) {
+	static const char *extensions[] = { ".wav", ".aif", ".ogg" };
+
+	int index = opts.pool > 0 ? ref % opts.pool : ref;
+	if (index < (int)files.size())
+		return files[index];
+
+	char name[64];
+	snprintf(name, sizeof(name), "gen_%05d%s", index, extensions[opts.type]);
+	files.push_back(name);
+	return files[index];
+}
+
+static void GenProject(const genOptions& opts, oamlTracksInfo& info, std::vector<std::string>& files) {
+	static const char *layerNames[] = { "", "drums", "bass", "strings", "brass", "choir", "fx", "perc" };
+
+	unsigned int seed = opts.seed;
+	int ref = 0;
+
+	info.bpm = opts.bpm;
+	info.beatsPerBar = opts.beatsPerBar;
+	info.tracks.clear();
+
+	for (int t=0; t<opts.tracks + opts.sfxTracks; t++) {
+		bool sfx = t >= opts.tracks;
+		char name[64];
+
+		oamlTrackInfo track = oamlTrackInfo();
+		if (sfx) {
+			snprintf(name, sizeof(name), "Sfx %03d", t - opts.tracks + 1);
+		} else {
+			snprintf(name, sizeof(name), "Track %03d", t + 1);
+		}
+		track.name = name;
+		track.musicTrack = !sfx;
+		track.sfxTrack = sfx;
+		track.volume = 1.0f;
+		if (!sfx) {
+			track.fadeIn = 500;
+			track.xfadeIn = 1000;
+			track.xfadeOut = 1000;
+		}
+
+		int condValue = 1;
+		for (int a=0; a<opts.audios; a++) {
+			oamlAudioInfo audio = oamlAudioInfo();
+			snprintf(name, sizeof(name), "%s %02d", sfx ? "sfx" : "audio", a + 1);
+			audio.name = name;
+			audio.volume = 1.0f;
+
+			if (!sfx) {
+				// First audio is the intro, the rest are loops and some of them
+				// play only on a condition value
+				if (a == 0 && opts.audios > 1) {
+					audio.type = 1;
+				} else if (a > 1 && GenRandom(&seed) < opts.condDensity * 32768.0f) {
+					audio.type = 4;
+					audio.condId = 1;
+					audio.condType = 0;
+					audio.condValue = condValue++;
+					audio.xfadeIn = 500;
+					audio.xfadeOut = 500;
+				} else {
+					audio.type = 2;
+				}
+				audio.bpm = opts.bpm;
+				audio.beatsPerBar = opts.beatsPerBar;
+				audio.bars = opts.bars;
+				audio.minMovementBars = 1;
+			}
+
+			int layers = sfx ? 1 : opts.layers;
+			for (int l=0; l<layers; l++) {
+				oamlAudioFileInfo file;
+				file.filename = GenFileName(opts, ref++, files);
+				file.layer = layerNames[l % (sizeof(layerNames)/sizeof(layerNames[0]))];
+				file.randomChance = -1;
+				audio.files.push_back(file);
+			}
+
+			track.audios.push_back(audio);
+		}
+
+		info.tracks.push_back(track);
+	}
+}
+
+int main(int argc, char **argv) {
+	genOptions opts;
+	memset(&opts, 0, sizeof(opts));
+	GenSetPreset(opts, "S");
+	GenSetFormat(opts, "wav16");
+	opts.condDensity = 0.5f;
+	opts.bars = 2;
+	opts.bpm = 120;
+	opts.beatsPerBar = 4;
+	opts.sampleRate = 22050;
+	opts.channels = 1;
+	opts.seed = 1;
+
+	std::string dir;
+
+	// The preset goes first so the other options can override it
+	for (int i=1; i+1<argc; i++) {
+		if (strcmp(argv[i], "--size") == 0 && GenSetPreset(opts, argv[i+1]) == false) {
+			fprintf(stderr, "oamlStudio-gen: unknown size %s\n", argv[i+1]);
+			return 1;
+		}
+	}
+
+	for (int i=1; i<argc; i++) {
+		std::string arg = argv[i];
+		if (i+1 >= argc) {
+			GenUsage();
+			return 1;
+		}
+
+		const char *value = argv[++i];
+		if (arg == "--size") {
+			// Already applied
+		} else if (arg == "--out") {
+			dir = value;
+		} else if (arg == "--tracks") {
+			opts.tracks = atoi(value);
+		} else if (arg == "--audios") {
+			opts.audios = atoi(value);
+		} else if (arg == "--layers") {
+			opts.layers = atoi(value);
+		} else if (arg == "--sfx-tracks") {
+			opts.sfxTracks = atoi(value);
+		} else if (arg == "--cond-density") {
+			opts.condDensity = (float)atof(value);
+		} else if (arg == "--bars") {
+			opts.bars = atoi(value);
+		} else if (arg == "--bpm") {
+			opts.bpm = (float)atof(value);
+		} else if (arg == "--format") {
+			if (GenSetFormat(opts, value) == false) {
+				fprintf(stderr, "oamlStudio-gen: unknown format %s\n", value);
+				return 1;
+			}
+		} else if (arg == "--rate") {
+			opts.sampleRate = atoi(value);
+		} else if (arg == "--channels") {
+			opts.channels = atoi(value);
+		} else if (arg == "--pool") {
+			opts.pool = atoi(value);
+		} else if (arg == "--seed") {
+			opts.seed = atoi(value);
+		} else {
+			GenUsage();
+			return 1;
+		}
+	}
+
+	if (dir.empty() || opts.tracks < 0 || opts.audios < 1 || opts.layers < 1 || opts.bars < 1 || opts.bpm <= 0 || opts.sampleRate == 0 || opts.channels < 1 || opts.pool < 0) {
+		GenUsage();
+		return 1;
+	}
+
+	if (opts.type == BENCH_OGG && BenchCanWriteOgg() == false) {
+		fprintf(stderr, "oamlStudio-gen: built without vorbisenc, ogg files can't be generated\n");
+		return 1;
+	}
+
+	if (dir[dir.size()-1] != '/' && dir[dir.size()-1] != '\\') {
+		dir+= PATH_SEPARATOR;
+	}
+
+	oamlTracksInfo info;
+	std::vector<std::string> files;
+	GenProject(opts, info, files);
+
+	// Filenames in the defs are relative to the defs, like the studio saves them
+	tinyxml2::XMLDocument xmlDoc;
+	ExportCreateDefs(xmlDoc, &info);
+	std::string defsPath = dir + "oaml.defs";
+	if (xmlDoc.SaveFile(defsPath.c_str()) != tinyxml2::XML_SUCCESS) {
+		fprintf(stderr, "oamlStudio-gen: can't write %s\n", defsPath.c_str());
+		return 1;
+	}
+
+	double seconds = opts.bars * opts.beatsPerBar * 60.0 / opts.bpm;
+	for (size_t i=0; i<files.size(); i++) {
+		benchFixture fixture;
+		fixture.type = opts.type;
+		fixture.sampleRate = opts.sampleRate;
+		fixture.format = opts.format;
+		fixture.channels = opts.channels;
+		fixture.seconds = seconds;
+		fixture.name = files[i];
+		fixture.path = dir + files[i];
+
+		if (BenchWriteFile(fixture) == -1) {
+			fprintf(stderr, "oamlStudio-gen: can't write %s\n", fixture.path.c_str());
+			return 1;
+		}
+
+		if ((i+1) % 100 == 0 || i+1 == files.size()) {
+			fprintf(stderr, "\roamlStudio-gen: %d/%d files", (int)(i+1), (int)files.size());
+		}
+	}
+	fprintf(stderr, "\n");
+
+	int audios = 0;
+	int refs = 0;
+	for (size_t t=0; t<info.tracks.size(); t++) {
+		audios+= info.tracks[t].audios.size();
+		for (size_t a=0; a<info.tracks[t].audios.size(); a++) {
+			refs+= info.tracks[t].audios[a].files.size();
+		}
+	}
+
+	printf("%s: %d tracks, %d audios, %d file references, %d files of %.1f s\n", defsPath.c_str(), (int)info.tracks.size(), audios, refs, (int)files.size(), seconds);
+
+	return 0;
+}
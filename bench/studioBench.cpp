@@ -0,0 +1,786 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "oamlCore.h"
+#include "benchFixtures.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+
+#define BENCH_READ_SIZE		4096
+#define BENCH_SEEKS			64
+#define BENCH_OPENS			100
+#define BENCH_BATCH_AUDIOS	4096
+#define BENCH_METER_CALLBACKS	4000
+#define BENCH_METER_RATE	44100
+#define BENCH_SEEK_FRAMES	4096
+#define BENCH_LATENCY_EVENTS	20000
+
+typedef struct {
+	std::string name;
+	std::string fixture;
+	unsigned long long bytes;
+	double audioSeconds;
+	std::vector<double> timesMs;
+	// Figures of a benchmark that don't fit the ones above
+	std::vector<std::pair<std::string, double> > extra;
+} benchResult;
+
+// Fixture paths are used as given, so the context has no root
+static std::shared_ptr<FileContext> benchFiles;
+
+static double BenchNowMs() {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void BenchUsage() {
+	fprintf(stderr, "usage: oamlStudio-bench [options]\n");
+	fprintf(stderr, "  --iterations <n>      timed runs per benchmark (default 5)\n");
+	fprintf(stderr, "  --dir <path>          where the fixtures are generated (default .)\n");
+	fprintf(stderr, "  --out <file>          write the json results to a file instead of stdout\n");
+	fprintf(stderr, "  --quick               5 second fixtures, for a fast sanity check\n");
+	fprintf(stderr, "  --keep                keep the generated fixtures\n");
+	fprintf(stderr, "  --read-ahead <bytes>  stdio buffer size of the decoded files (default libc's)\n");
+}
+
+// Decodes the whole file with the same read size the studio uses, into buf
+// when one is given. Returns the number of decoded bytes or -1.
+static long long DecodeFile(const std::string& path, std::vector<uint8_t> *buf, int *format, int *bytesPerSample) {
+	audioFile *handle = CreateAudioFile(path, benchFiles->GetCallbacks());
+	if (handle == NULL)
+		return -1;
+
+	if (handle->Open(path.c_str()) == -1) {
+		delete handle;
+		return -1;
+	}
+
+	if (format) *format = handle->GetFormat();
+	if (bytesPerSample) *bytesPerSample = handle->GetBytesPerSample();
+
+	char data[BENCH_READ_SIZE];
+	long long total = 0;
+	for (;;) {
+		int bytes = handle->Read(data, sizeof(data));
+		if (bytes <= 0)
+			break;
+
+		if (buf) {
+			buf->insert(buf->end(), (uint8_t*)data, (uint8_t*)data + bytes);
+		}
+		total+= bytes;
+	}
+
+	delete handle;
+	return total;
+}
+
+static void BenchDecode(std::vector<benchFixture>& fixtures, int iterations, std::vector<benchResult>& results) {
+	for (size_t i=0; i<fixtures.size(); i++) {
+		benchResult res;
+		res.name = "decode";
+		res.fixture = fixtures[i].name;
+		res.audioSeconds = fixtures[i].seconds;
+
+		// Untimed first pass so every run reads from the page cache
+		res.bytes = DecodeFile(fixtures[i].path, NULL, NULL, NULL);
+
+		for (int it=0; it<iterations; it++) {
+			double start = BenchNowMs();
+			DecodeFile(fixtures[i].path, NULL, NULL, NULL);
+			res.timesMs.push_back(BenchNowMs() - start);
+		}
+
+		results.push_back(res);
+	}
+}
+
+// What sizing a waveform panel costs, headers and length but no samples
+static void BenchOpen(std::vector<benchFixture>& fixtures, int iterations, std::vector<benchResult>& results) {
+	for (size_t i=0; i<fixtures.size(); i++) {
+		benchResult res;
+		res.name = "open";
+		res.fixture = fixtures[i].name;
+		res.audioSeconds = fixtures[i].seconds;
+		res.bytes = 0;
+
+		for (int it=0; it<iterations; it++) {
+			double start = BenchNowMs();
+			for (int n=0; n<BENCH_OPENS; n++) {
+				audioFile *handle = CreateAudioFile(fixtures[i].path, benchFiles->GetCallbacks());
+				if (handle == NULL)
+					break;
+
+				if (handle->Open(fixtures[i].path.c_str()) == 0) {
+					res.bytes = (unsigned long long)handle->GetTotalSamples() * handle->GetBytesPerSample();
+				}
+				delete handle;
+			}
+			res.timesMs.push_back(BenchNowMs() - start);
+		}
+
+		results.push_back(res);
+	}
+}
+
+// Reads short windows all over the file the way a zoomed view or a preview
+// started from a click would
+static void BenchSeek(std::vector<benchFixture>& fixtures, int iterations, std::vector<benchResult>& results) {
+	for (size_t i=0; i<fixtures.size(); i++) {
+		audioFile *handle = CreateAudioFile(fixtures[i].path, benchFiles->GetCallbacks());
+		if (handle == NULL)
+			continue;
+
+		if (handle->Open(fixtures[i].path.c_str()) == -1 || handle->GetFrameBytes() <= 0) {
+			delete handle;
+			continue;
+		}
+
+		int64_t totalFrames = handle->GetTotalSamples() / handle->GetChannels();
+		std::vector<char> buf(BENCH_SEEK_FRAMES * handle->GetFrameBytes());
+
+		benchResult res;
+		res.name = "seek";
+		res.fixture = fixtures[i].name;
+		res.audioSeconds = fixtures[i].seconds;
+		res.bytes = 0;
+
+		for (int it=0; it<iterations; it++) {
+			// Same positions every run, spread over the whole file
+			unsigned int seed = 12345;
+			unsigned long long bytes = 0;
+
+			double start = BenchNowMs();
+			for (int n=0; n<BENCH_SEEKS; n++) {
+				seed = seed * 1103515245 + 12345;
+				int64_t frame = totalFrames > 0 ? (int64_t)(seed >> 8) % totalFrames : 0;
+				int frames = handle->ReadFramesAt(frame, &buf[0], BENCH_SEEK_FRAMES);
+				if (frames > 0) {
+					bytes+= frames * handle->GetFrameBytes();
+				}
+			}
+			res.timesMs.push_back(BenchNowMs() - start);
+			res.bytes = bytes;
+		}
+
+		delete handle;
+		results.push_back(res);
+	}
+}
+
+static void BenchPeaks(std::vector<benchFixture>& fixtures, int iterations, std::vector<benchResult>& results) {
+	for (size_t i=0; i<fixtures.size(); i++) {
+		std::vector<uint8_t> pcm;
+		int format = AF_FORMAT_SINT16;
+		int bytesPerSample = 2;
+		if (DecodeFile(fixtures[i].path, &pcm, &format, &bytesPerSample) <= 0)
+			continue;
+
+		// Same pixel density WaveformDisplay uses for music audios
+		int frames = (int)(pcm.size() / (bytesPerSample * fixtures[i].channels));
+		int framesPerPixel = fixtures[i].sampleRate / (fixtures[i].seconds < 10 ? 20 : 10);
+		int width = frames / (framesPerPixel > 0 ? framesPerPixel : 1);
+		int samplesPerPixel = frames / (width > 0 ? width : 1);
+
+		benchResult res;
+		res.name = "peaks";
+		res.fixture = fixtures[i].name;
+		res.audioSeconds = fixtures[i].seconds;
+		res.bytes = pcm.size();
+
+		PeakBuilder builder;
+		for (int it=0; it<iterations; it++) {
+			double start = BenchNowMs();
+			builder.Reset(format, bytesPerSample, samplesPerPixel);
+			for (size_t pos=0; pos<pcm.size(); pos+= BENCH_READ_SIZE) {
+				size_t bytes = pcm.size() - pos < BENCH_READ_SIZE ? pcm.size() - pos : BENCH_READ_SIZE;
+				builder.Feed(&pcm[pos], (int)bytes);
+			}
+			res.timesMs.push_back(BenchNowMs() - start);
+		}
+
+		results.push_back(res);
+	}
+}
+
+static uint64_t BenchNowNs() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+typedef SpscRing<meterBlock, METER_RING_BLOCKS> benchMeterRing;
+
+static void BenchMeterConsumer(benchMeterRing *ring, std::atomic<bool> *done) {
+	meterBlock block;
+	while (*done == false) {
+		ring->Pop(block);
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+// The metering half of the audio callback: analyze the mixed block and
+// queue it for the UI. A stalled consumer leaves the ring full so every push
+// fails, a slow one takes a block now and then like a busy UI thread.
+static void BenchMeter(int iterations, std::vector<benchResult>& results) {
+	static const int blockFrames[] = { 256, 512, 1024 };
+
+	for (size_t b=0; b<sizeof(blockFrames)/sizeof(blockFrames[0]); b++) {
+		int frames = blockFrames[b];
+		std::vector<int16_t> buffer(frames * 2);
+		for (int i=0; i<frames; i++) {
+			buffer[i*2] = (int16_t)(sinf(i * 0.05f) * 32767.0f);
+			buffer[i*2+1] = (int16_t)(i * 7919);
+		}
+
+		for (int slow=0; slow<2; slow++) {
+			char name[64];
+			snprintf(name, sizeof(name), "%d_frames_%s", frames, slow ? "slow" : "stalled");
+
+			benchResult res;
+			res.name = "meter";
+			res.fixture = name;
+			res.audioSeconds = (double)BENCH_METER_CALLBACKS * frames / BENCH_METER_RATE;
+			res.bytes = (unsigned long long)BENCH_METER_CALLBACKS * frames * 2 * sizeof(int16_t);
+
+			std::vector<uint64_t> callbackNs;
+			callbackNs.reserve(iterations * BENCH_METER_CALLBACKS);
+			unsigned long long dropped = 0;
+
+			for (int it=0; it<iterations; it++) {
+				benchMeterRing ring;
+				std::atomic<bool> done(false);
+				std::thread consumer;
+				if (slow) {
+					consumer = std::thread(BenchMeterConsumer, &ring, &done);
+				}
+
+				dropped = 0;
+				double start = BenchNowMs();
+				for (int n=0; n<BENCH_METER_CALLBACKS; n++) {
+					uint64_t startNs = BenchNowNs();
+
+					meterBlock block;
+					MeterAnalyze(&buffer[0], frames, 2, block);
+					if (ring.Push(block) == false) {
+						dropped++;
+					}
+
+					callbackNs.push_back(BenchNowNs() - startNs);
+				}
+				res.timesMs.push_back(BenchNowMs() - start);
+
+				done = true;
+				if (consumer.joinable()) {
+					consumer.join();
+				}
+			}
+
+			std::sort(callbackNs.begin(), callbackNs.end());
+			res.extra.push_back(std::make_pair(std::string("budgetNs"), (double)frames * 1000000000.0 / BENCH_METER_RATE));
+			res.extra.push_back(std::make_pair(std::string("p99Ns"), (double)callbackNs[callbackNs.size() * 99 / 100]));
+			res.extra.push_back(std::make_pair(std::string("maxNs"), (double)callbackNs.back()));
+			res.extra.push_back(std::make_pair(std::string("dropped"), (double)dropped));
+			results.push_back(res);
+		}
+	}
+}
+
+typedef struct {
+	bool set;
+	double timeMs;
+	std::string audio;
+	int condId;
+	int condValue;
+	bool expected;
+	double latencyMs;
+} benchLatencyStep;
+
+static oamlAudioInfo BenchLatencyAudio(const char *name, int condId, int condType, int condValue, int condValue2) {
+	oamlAudioInfo audio;
+	audio.name = name;
+	audio.condId = condId;
+	audio.condType = condType;
+	audio.condValue = condValue;
+	audio.condValue2 = condValue2;
+	return audio;
+}
+
+// Plays the playback panel's part against a scripted oaml: condition
+// changes, the loops they select starting after a while and unrelated
+// switches in between. Only the selected loops, or the main loop when a
+// loop is left, may be counted as condition latency.
+static int BenchLatency(int iterations, std::vector<benchResult>& results) {
+	oamlTrackInfo track;
+	track.name = "bench";
+	track.audios.push_back(BenchLatencyAudio("main1", 0, LATENCY_COND_EQUAL, 0, 0));
+	track.audios.push_back(BenchLatencyAudio("main2", 0, LATENCY_COND_EQUAL, 0, 0));
+	track.audios.push_back(BenchLatencyAudio("main3", 0, LATENCY_COND_EQUAL, 0, 0));
+	track.audios.push_back(BenchLatencyAudio("fight", 1, LATENCY_COND_EQUAL, 1, 0));
+	track.audios.push_back(BenchLatencyAudio("chase", 1, LATENCY_COND_EQUAL, 2, 0));
+	track.audios.push_back(BenchLatencyAudio("boss", 1, LATENCY_COND_RANGE, 5, 9));
+	track.audios.push_back(BenchLatencyAudio("night", 2, LATENCY_COND_LESS, 3, 0));
+	track.audios.push_back(BenchLatencyAudio("storm", 3, LATENCY_COND_GREATER, 10, 0));
+
+	// Values no loop of each condition plays on
+	static const int noMatch[4] = { 0, 1000, 1000, 0 };
+
+	std::vector<benchLatencyStep> script;
+	unsigned int seed = 12345;
+	double time = 0;
+	int current = 0;
+	int expectedSwitches = 0;
+	double expectedSumMs = 0;
+	for (int n=0; n<BENCH_LATENCY_EVENTS; n++) {
+		seed = seed * 1103515245 + 12345;
+		const oamlAudioInfo& playing = track.audios[current];
+
+		benchLatencyStep set;
+		set.set = true;
+		set.timeMs = time;
+		set.audio = playing.name;
+		set.expected = false;
+		set.latencyMs = 0;
+
+		int target = -1;
+		if (playing.condId != 0) {
+			// Leave the loop, any main audio answers
+			set.condId = playing.condId;
+			set.condValue = noMatch[playing.condId];
+			target = (seed >> 8) % 3;
+		} else if ((seed >> 4) % 4 == 0) {
+			// Nothing plays on this value, no switch is expected
+			set.condId = 1 + (seed >> 8) % 3;
+			set.condValue = noMatch[set.condId];
+		} else {
+			target = 3 + (seed >> 8) % 5;
+			const oamlAudioInfo& loop = track.audios[target];
+			set.condId = loop.condId;
+			switch (loop.condType) {
+				case LATENCY_COND_EQUAL: set.condValue = loop.condValue; break;
+				case LATENCY_COND_GREATER: set.condValue = loop.condValue + 1 + (seed >> 12) % 5; break;
+				case LATENCY_COND_LESS: set.condValue = loop.condValue - 1 - (seed >> 12) % 5; break;
+				default: set.condValue = loop.condValue + (seed >> 12) % (loop.condValue2 - loop.condValue + 1); break;
+			}
+		}
+		script.push_back(set);
+
+		// Unrelated switches first: the main loop moving on and a loop of
+		// another value of the same condition
+		benchLatencyStep play = set;
+		play.set = false;
+		play.timeMs = time + 100 + (seed >> 16) % 400;
+		play.audio = track.audios[(current + 1) % 3].name;
+		if (playing.condId == 0) {
+			script.push_back(play);
+		}
+
+		if (set.condId == 1 && target != 3) {
+			play.audio = "fight";
+			play.timeMs+= 50;
+			script.push_back(play);
+		}
+
+		if (target >= 0) {
+			play.timeMs = time + 1000 + (seed >> 20) % 8000;
+			play.audio = track.audios[target].name;
+			play.expected = true;
+			play.latencyMs = play.timeMs - time;
+			script.push_back(play);
+
+			expectedSwitches++;
+			expectedSumMs+= play.latencyMs;
+			current = target;
+		}
+
+		time+= 10000;
+	}
+
+	benchResult res;
+	res.name = "latency";
+	res.fixture = "scripted";
+	res.bytes = 0;
+	res.audioSeconds = time / 1000.0;
+
+	int wrong = 0;
+	double sumMs = 0;
+	for (int it=0; it<iterations; it++) {
+		ConditionLatency latency;
+		wrong = 0;
+
+		double start = BenchNowMs();
+		for (size_t i=0; i<script.size(); i++) {
+			const benchLatencyStep& step = script[i];
+			if (step.set) {
+				latency.OnSetCondition(step.timeMs, track.name, step.audio, step.condId, step.condValue);
+			} else if (latency.OnAudioPlaying(step.timeMs, track, step.audio) != step.expected) {
+				wrong++;
+			}
+		}
+		res.timesMs.push_back(BenchNowMs() - start);
+
+		const latencyHistogram *hist = latency.GetHistogram(track.name);
+		if (hist == NULL || hist->total != expectedSwitches) {
+			wrong++;
+		}
+		sumMs = hist ? hist->sumMs : 0;
+	}
+
+	if (fabs(sumMs - expectedSumMs) > 0.001 * expectedSwitches) {
+		wrong++;
+	}
+
+	res.extra.push_back(std::make_pair(std::string("events"), (double)BENCH_LATENCY_EVENTS));
+	res.extra.push_back(std::make_pair(std::string("switches"), (double)expectedSwitches));
+	res.extra.push_back(std::make_pair(std::string("wrong"), (double)wrong));
+	results.push_back(res);
+
+	if (wrong > 0) {
+		fprintf(stderr, "oamlStudio-bench: latency: %d switches attributed wrongly\n", wrong);
+	}
+	return wrong;
+}
+
+static void BuildProject(oamlTracksInfo& info, int tracks, int audios, std::vector<benchFixture>& fixtures) {
+	info.bpm = 120;
+	info.beatsPerBar = 4;
+	info.tracks.clear();
+
+	for (int t=0; t<tracks; t++) {
+		oamlTrackInfo track = oamlTrackInfo();
+		char name[64];
+		snprintf(name, sizeof(name), "track%d", t);
+		track.name = name;
+		track.musicTrack = true;
+		track.volume = 1.0f;
+		track.fadeIn = 1000;
+		track.xfadeIn = 500;
+		track.groups.push_back("combat");
+
+		for (int a=0; a<audios; a++) {
+			oamlAudioInfo audio = oamlAudioInfo();
+			snprintf(name, sizeof(name), "%s_audio%d", track.name.c_str(), a);
+			audio.name = name;
+			audio.type = a == 0 ? 1 : 2;
+			audio.volume = 1.0f;
+			audio.bpm = 120;
+			audio.beatsPerBar = 4;
+			audio.bars = 16;
+			audio.minMovementBars = 4;
+			audio.condId = a > 1 ? 1 : 0;
+			audio.condValue = a;
+
+			for (size_t f=0; f<fixtures.size() && f<3; f++) {
+				oamlAudioFileInfo file;
+				file.filename = fixtures[(a + f) % fixtures.size()].path;
+				file.layer = f == 0 ? "" : (f == 1 ? "drums" : "strings");
+				file.randomChance = -1;
+				audio.files.push_back(file);
+			}
+
+			track.audios.push_back(audio);
+		}
+
+		info.tracks.push_back(track);
+	}
+}
+
+static void BenchDefs(std::vector<benchFixture>& fixtures, int iterations, std::vector<benchResult>& results) {
+	static const int sizes[][2] = { { 8, 8 }, { 64, 16 } };
+
+	for (size_t i=0; i<sizeof(sizes)/sizeof(sizes[0]); i++) {
+		oamlTracksInfo info;
+		BuildProject(info, sizes[i][0], sizes[i][1], fixtures);
+
+		char name[64];
+		snprintf(name, sizeof(name), "%d_tracks_%d_audios", sizes[i][0], sizes[i][1]);
+
+		benchResult res;
+		res.name = "defs";
+		res.fixture = name;
+		res.audioSeconds = 0;
+		res.bytes = 0;
+
+		for (int it=0; it<iterations; it++) {
+			double start = BenchNowMs();
+			tinyxml2::XMLDocument xmlDoc;
+			tinyxml2::XMLPrinter printer;
+			ExportCreateDefs(xmlDoc, &info);
+			xmlDoc.Accept(&printer);
+			res.timesMs.push_back(BenchNowMs() - start);
+			res.bytes = printer.CStrSize() - 1;
+		}
+
+		results.push_back(res);
+	}
+}
+
+// One change applied to every audio of a big track at once, the way the
+// control panel does it for a multi-selection
+static void BenchBatch(std::vector<benchFixture>& fixtures, std::string dir, int iterations, std::vector<benchResult>& results) {
+	oamlTracksInfo info;
+	BuildProject(info, 1, BENCH_BATCH_AUDIOS, fixtures);
+
+	std::string defsFile = dir + "bench_batch.defs";
+	tinyxml2::XMLDocument xmlDoc;
+	ExportCreateDefs(xmlDoc, &info);
+	if (xmlDoc.SaveFile(defsFile.c_str()) != tinyxml2::XML_SUCCESS) {
+		fprintf(stderr, "oamlStudio-bench: can't write %s\n", defsFile.c_str());
+		return;
+	}
+
+	oamlApi *api = new oamlApi();
+	api->SetFileCallbacks(benchFiles->GetCallbacks());
+	if (api->Init(defsFile.c_str()) != OAML_OK) {
+		fprintf(stderr, "oamlStudio-bench: can't load %s\n", defsFile.c_str());
+		delete api;
+		remove(defsFile.c_str());
+		return;
+	}
+
+	std::vector<audioSelection> selection;
+	const oamlTrackInfo& track = info.tracks[0];
+	for (std::vector<oamlAudioInfo>::const_iterator audio=track.audios.begin(); audio<track.audios.end(); ++audio) {
+		for (std::vector<oamlAudioFileInfo>::const_iterator file=audio->files.begin(); file<audio->files.end(); ++file) {
+			audioSelection sel;
+			sel.audioName = audio->name;
+			sel.filename = file->filename;
+			selection.push_back(sel);
+		}
+	}
+
+	char name[64];
+	snprintf(name, sizeof(name), "%d_audios", BENCH_BATCH_AUDIOS);
+
+	benchResult res;
+	res.name = "batch";
+	res.fixture = name;
+	res.audioSeconds = 0;
+	res.bytes = 0;
+
+	for (int it=0; it<iterations; it++) {
+		// A different value every run so every audio really changes
+		double start = BenchNowMs();
+		AudioBatchEdit batch(api->GetStudioApi(), track.name, selection);
+		batch.SetProperty(AUDIO_PROP_VOLUME, 0.5f + (it % 2) * 0.25f);
+		res.timesMs.push_back(BenchNowMs() - start);
+
+		if (it == 0) {
+			res.extra.push_back(std::make_pair(std::string("audios"), (double)batch.GetAudioCount()));
+			res.extra.push_back(std::make_pair(std::string("changes"), (double)batch.GetChanges()));
+		}
+	}
+
+	results.push_back(res);
+
+	api->Shutdown();
+	delete api;
+	remove(defsFile.c_str());
+}
+
+static void BenchZip(std::vector<benchFixture>& fixtures, std::string dir, int iterations, std::vector<benchResult>& results) {
+	oamlTracksInfo info;
+	BuildProject(info, 4, 4, fixtures);
+
+	std::vector<std::string> files;
+	benchResult res;
+	res.name = "zip";
+	res.fixture = "all_fixtures";
+	res.audioSeconds = 0;
+	res.bytes = 0;
+
+	for (size_t i=0; i<fixtures.size(); i++) {
+		FILE *f = fopen(fixtures[i].path.c_str(), "rb");
+		if (f == NULL)
+			continue;
+		fseek(f, 0, SEEK_END);
+		res.bytes+= ftell(f);
+		fclose(f);
+
+		files.push_back(fixtures[i].path);
+		res.audioSeconds+= fixtures[i].seconds;
+	}
+
+	std::string zfile = dir + "bench_package.zip";
+	for (int it=0; it<iterations; it++) {
+		std::string error;
+		double start = BenchNowMs();
+		if (ExportCreateZip(zfile, &info, files, error) == -1) {
+			fprintf(stderr, "oamlStudio-bench: zip: %s\n", error.c_str());
+			remove(zfile.c_str());
+			return;
+		}
+		res.timesMs.push_back(BenchNowMs() - start);
+	}
+	remove(zfile.c_str());
+
+	results.push_back(res);
+}
+
+static void WriteJson(FILE *f, std::vector<benchResult>& results, int iterations, bool quick) {
+	fprintf(f, "{\n");
+	fprintf(f, "  \"benchmark\": \"oamlStudio-bench\",\n");
+	fprintf(f, "  \"iterations\": %d,\n", iterations);
+	fprintf(f, "  \"quick\": %s,\n", quick ? "true" : "false");
+	fprintf(f, "  \"results\": [");
+
+	for (size_t i=0; i<results.size(); i++) {
+		benchResult& res = results[i];
+		std::vector<double> times = res.timesMs;
+		std::sort(times.begin(), times.end());
+
+		double sum = 0;
+		for (size_t j=0; j<times.size(); j++) {
+			sum+= times[j];
+		}
+
+		double minMs = times.size() ? times[0] : 0;
+		double maxMs = times.size() ? times[times.size()-1] : 0;
+		double medianMs = times.size() ? times[times.size()/2] : 0;
+		double meanMs = times.size() ? sum / times.size() : 0;
+
+		fprintf(f, "%s\n    {\"name\": \"%s\", \"fixture\": \"%s\", \"bytes\": %llu", i ? "," : "", res.name.c_str(), res.fixture.c_str(), res.bytes);
+		fprintf(f, ", \"minMs\": %.3f, \"medianMs\": %.3f, \"meanMs\": %.3f, \"maxMs\": %.3f", minMs, medianMs, meanMs, maxMs);
+		fprintf(f, ", \"mbPerSec\": %.2f", medianMs > 0 ? res.bytes / (medianMs * 1000.0) : 0.0);
+		if (res.audioSeconds > 0) {
+			fprintf(f, ", \"realtime\": %.1f", medianMs > 0 ? res.audioSeconds * 1000.0 / medianMs : 0.0);
+		}
+		for (size_t j=0; j<res.extra.size(); j++) {
+			fprintf(f, ", \"%s\": %.3f", res.extra[j].first.c_str(), res.extra[j].second);
+		}
+		fprintf(f, "}");
+	}
+
+	fprintf(f, "\n  ]\n}\n");
+}
+
+int main(int argc, char **argv) {
+	int iterations = 5;
+	std::string dir = ".";
+	std::string outFile;
+	bool quick = false;
+	bool keep = false;
+	long readAhead = 0;
+
+	for (int i=1; i<argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i+1 < argc;
+
+		if (arg == "--iterations" && hasValue) {
+			iterations = atoi(argv[++i]);
+		} else if (arg == "--dir" && hasValue) {
+			dir = argv[++i];
+		} else if (arg == "--out" && hasValue) {
+			outFile = argv[++i];
+		} else if (arg == "--quick") {
+			quick = true;
+		} else if (arg == "--keep") {
+			keep = true;
+		} else if (arg == "--read-ahead" && hasValue) {
+			readAhead = atol(argv[++i]);
+		} else {
+			BenchUsage();
+			return 1;
+		}
+	}
+
+	if (iterations < 1 || readAhead < 0) {
+		BenchUsage();
+		return 1;
+	}
+
+	benchFiles = FileContext::Create("", (size_t)readAhead);
+
+	if (dir.empty() == false && dir[dir.size()-1] != '/' && dir[dir.size()-1] != '\\') {
+		dir+= PATH_SEPARATOR;
+	}
+
+	std::vector<benchFixture> list;
+	std::vector<benchFixture> fixtures;
+	BenchFixtureList(list, quick);
+
+	for (size_t i=0; i<list.size(); i++) {
+		if (list[i].type == BENCH_OGG && BenchCanWriteOgg() == false) {
+			fprintf(stderr, "oamlStudio-bench: skipping %s, built without vorbisenc\n", list[i].name.c_str());
+			continue;
+		}
+
+		fprintf(stderr, "oamlStudio-bench: generating %s\n", list[i].name.c_str());
+		if (BenchWriteFixture(list[i], dir) == -1) {
+			fprintf(stderr, "oamlStudio-bench: can't write %s\n", list[i].path.c_str());
+			remove(list[i].path.c_str());
+			continue;
+		}
+
+		fixtures.push_back(list[i]);
+	}
+
+	std::vector<benchResult> results;
+
+	fprintf(stderr, "oamlStudio-bench: decode\n");
+	BenchDecode(fixtures, iterations, results);
+	fprintf(stderr, "oamlStudio-bench: open\n");
+	BenchOpen(fixtures, iterations, results);
+	fprintf(stderr, "oamlStudio-bench: seek\n");
+	BenchSeek(fixtures, iterations, results);
+	fprintf(stderr, "oamlStudio-bench: peaks\n");
+	BenchPeaks(fixtures, iterations, results);
+	fprintf(stderr, "oamlStudio-bench: meter\n");
+	BenchMeter(iterations, results);
+	fprintf(stderr, "oamlStudio-bench: latency\n");
+	int wrong = BenchLatency(iterations, results);
+	fprintf(stderr, "oamlStudio-bench: defs\n");
+	BenchDefs(fixtures, iterations, results);
+	fprintf(stderr, "oamlStudio-bench: batch\n");
+	BenchBatch(fixtures, dir, iterations, results);
+	fprintf(stderr, "oamlStudio-bench: zip\n");
+	BenchZip(fixtures, dir, iterations, results);
+
+	if (keep == false) {
+		for (size_t i=0; i<fixtures.size(); i++) {
+			remove(fixtures[i].path.c_str());
+		}
+	}
+
+	FILE *f = stdout;
+	if (outFile.empty() == false) {
+		f = fopen(outFile.c_str(), "w");
+		if (f == NULL) {
+			fprintf(stderr, "oamlStudio-bench: can't write %s\n", outFile.c_str());
+			return 1;
+		}
+	}
+
+	WriteJson(f, results, iterations, quick);
+
+	if (f != stdout) {
+		fclose(f);
+	}
+
+	// A benchmark of code that counts the wrong thing is no use
+	return wrong > 0 ? 1 : 0;
+}
@@ -0,0 +1,94 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __ADAPTIVESIM_H__
+#define __ADAPTIVESIM_H__
+
+// Frames mixed per simulation step, the audio playing is sampled after each step
+#define SIM_BLOCK_FRAMES	1024
+#define SIM_SAMPLE_RATE		44100
+
+typedef struct {
+	condEvent event;
+	std::string audioBefore;
+	std::string audioAfter;
+	double latencyMs;
+	double latencyBars;
+} simEventResult;
+
+typedef struct {
+	std::string audioName;
+	float bpm;
+	int beatsPerBar;
+	int condId;
+	int condType;
+	int condValue;
+	int condValue2;
+	int plays;
+	double seconds;
+} simAudioCoverage;
+
+// Plays a track on its own oaml instance with no audio device, applies a
+// condition timeline and records which audios oaml picks and how long the
+// switches take. Runs as fast as oaml can mix.
+class AdaptiveSim {
+private:
+	std::string defsFile;
+	std::shared_ptr<FileContext> fileContext;
+	std::string trackName;
+	CondTimeline timeline;
+	double seconds;
+	unsigned int seed;
+
+	float projectBpm;
+	int projectBeatsPerBar;
+	oamlTrackInfo trackInfo;
+
+	std::vector<simEventResult> results;
+	std::vector<simAudioCoverage> coverage;
+	std::vector<std::string> audioNames;
+	double worstCaseMs;
+	double simulatedSeconds;
+	double elapsedSeconds;
+
+	int LoadTrackInfo(oamlApi *api, std::string *error);
+	double BarsFromMs(const std::string& audioName, double ms);
+
+public:
+	AdaptiveSim(std::string _defsFile, std::string _trackName);
+
+	void SetTimeline(const CondTimeline& _timeline) { timeline = _timeline; }
+	void SetLength(double _seconds) { seconds = _seconds; }
+	void SetSeed(unsigned int _seed) { seed = _seed; }
+
+	int Run(std::string *error);
+
+	const std::vector<simEventResult>& GetResults() const { return results; }
+	const std::vector<simAudioCoverage>& GetCoverage() const { return coverage; }
+	int GetUncoveredCount() const;
+	double GetWorstCaseMs() const { return worstCaseMs; }
+
+	void WriteReport(FILE *f) const;
+	void WriteJson(FILE *f) const;
+};
+
+#endif
@@ -31,9 +31,12 @@ private:
 	int bitsPerSample;
 	int totalSamples;
 
-	int chunkSize;
+	int64_t chunkSize;
 	int status;
 
+	int64_t dataOffset;
+	int64_t dataSize;
+
 	int ReadChunk();
 public:
 	aifFile(oamlFileCallbacks *cbs);
@@ -48,6 +51,7 @@ public:
 
 	int Open(const char *filename);
 	int Read(char *buffer, int size);
+	int SeekFrame(int64_t frame);
 
 	void WriteToFile(const char *filename, ByteBuffer *buffer, int channels, unsigned int sampleRate, int bytesPerSample);
 
@@ -0,0 +1,76 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __AUDIOBATCH_H__
+#define __AUDIOBATCH_H__
+
+enum {
+	AUDIO_PROP_VOLUME,
+	AUDIO_PROP_BPM,
+	AUDIO_PROP_BEATS_PER_BAR,
+	AUDIO_PROP_BARS,
+	AUDIO_PROP_RANDOM_CHANCE,
+	AUDIO_PROP_MIN_MOVEMENT_BARS,
+	AUDIO_PROP_FADE_IN,
+	AUDIO_PROP_FADE_OUT,
+	AUDIO_PROP_XFADE_IN,
+	AUDIO_PROP_XFADE_OUT,
+	AUDIO_PROP_COND_ID,
+	AUDIO_PROP_COND_TYPE,
+	AUDIO_PROP_COND_VALUE,
+	AUDIO_PROP_COND_VALUE2,
+	AUDIO_PROP_FILE_RANDOM_CHANCE
+};
+
+typedef struct {
+	std::string audioName;
+	std::string filename;
+} audioSelection;
+
+extern bool AudioSelectionLess(const audioSelection& a, const audioSelection& b);
+extern float AudioGetProperty(oamlStudioApi *api, std::string trackName, const audioSelection& sel, int prop);
+extern bool AudioSetProperty(oamlStudioApi *api, std::string trackName, const audioSelection& sel, int prop, float value);
+
+// Applies property changes to a set of audios (or audio files) of a single
+// track as one transaction, the caller only has to notify the rest of the
+// studio once per transaction instead of once per audio.
+class AudioBatchEdit {
+private:
+	oamlStudioApi *api;
+	std::string trackName;
+	std::vector<audioSelection> audios;
+	std::vector<audioSelection> files;
+
+	int changes;
+
+public:
+	AudioBatchEdit(oamlStudioApi *_api, std::string _trackName, const std::vector<audioSelection>& selection);
+
+	int SetProperty(int prop, float value);
+	int SetLayer(std::string layer);
+
+	int GetAudioCount() const { return (int)audios.size(); }
+	int GetFileCount() const { return (int)files.size(); }
+	int GetChanges() const { return changes; }
+};
+
+#endif
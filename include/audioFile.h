@@ -37,6 +37,9 @@ protected:
 
 	void *fd;
 
+	// Bytes left from the current position up to size, whichever ends first
+	int64_t ClampToFile(int64_t size);
+
 public:
 
 	audioFile(oamlFileCallbacks *cbs);
@@ -51,6 +54,15 @@ public:
 	virtual int Open(const char *filename) = 0;
 	virtual int Read(char *, int size) = 0;
 
+	// Moves to a frame of the file, the next Read starts there. Returns -1
+	// when the frame is out of range or the reader can't get there.
+	virtual int SeekFrame(int64_t frame) = 0;
+
+	// Reads up to frames frames starting at frame. Returns the number of
+	// frames read, fewer near the end of the file, or -1.
+	int ReadFramesAt(int64_t frame, char *buffer, int frames);
+	int GetFrameBytes() const { return GetBytesPerSample() * GetChannels(); }
+
 	virtual void WriteToFile(const char *filename, ByteBuffer *buffer, int channels, unsigned int sampleRate, int bytesPerSample) = 0;
 
 	virtual void Close() = 0;
@@ -59,4 +71,6 @@ public:
 	void* GetFD() const { return fd; }
 };
 
+audioFile* CreateAudioFile(std::string filename, oamlFileCallbacks *cbs);
+
 #endif /* __AUDIOFILE_H__ */
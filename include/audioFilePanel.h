@@ -44,6 +44,8 @@ public:
 	void AddWaveform(std::string filename);
 	void RemoveWaveform(std::string filename);
 	void UpdateAudioName(std::string oldName, std::string newName);
+	void UpdateSelection(const std::vector<audioSelection>& sorted);
+	void SetPlayTime(std::string playingAudio, double ms);
 
 	void OnMenuEvent(wxCommandEvent& event);
 	void OnPaint(wxPaintEvent& evt);
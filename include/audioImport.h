@@ -0,0 +1,98 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __AUDIOIMPORT_H__
+#define __AUDIOIMPORT_H__
+
+#include <atomic>
+#include <set>
+#include <thread>
+
+// Don't flood the panel with progress events on big imports
+#define IMPORT_PROGRESS_STEP	8
+
+typedef struct {
+	int done;
+	int total;
+	bool finished;
+} importProgress;
+
+typedef struct {
+	std::string filename;
+	std::string audioName;
+	bool ok;
+} audioImportFile;
+
+// Hands out the lowest free "audioN" names without asking oaml about each
+// candidate, the names already used are read once when it's created.
+class AudioNameAllocator {
+private:
+	std::set<std::string> taken;
+	int next;
+
+public:
+	AudioNameAllocator(const std::vector<std::string>& existing);
+
+	std::string Next();
+};
+
+// Imports many audio files into a track at once. Headers are probed and the
+// waveform peaks computed on a pool of worker threads, then the files that
+// could be read are added to the track in a single pass. Start() probes in
+// the background and posts EVENT_IMPORT_PROGRESS to the sink, Commit() must
+// be called on the UI thread once the last event says it's finished.
+class AudioImport {
+private:
+	oamlStudioApi *api;
+	std::string trackName;
+	bool sfxMode;
+	std::shared_ptr<FileContext> fileContext;
+
+	std::vector<audioImportFile> files;
+
+	wxEvtHandler *sink;
+	std::thread thread;
+	std::atomic<int> probed;
+	std::atomic<bool> cancelled;
+
+	void ProbeFile(audioImportFile& file);
+	void ProbeWorker(std::atomic<int> *index);
+	void Run(int threads);
+	void Post(int done, bool finished);
+
+public:
+	AudioImport(oamlStudioApi *_api, std::string _trackName, bool _sfxMode);
+	~AudioImport();
+
+	void SetTrackName(std::string name) { trackName = name; }
+	void AddFile(std::string filename);
+	void Probe(int threads = 0);
+	void Start(wxEvtHandler *_sink, int threads = 0);
+	void Cancel();
+	void Join();
+	int Commit(int type);
+
+	std::vector<audioImportFile>& GetFiles() { return files; }
+	int GetFailedCount() const;
+};
+
+#endif
@@ -32,19 +32,30 @@ private:
 	int panelIndex;
 	bool sfxMode;
 
+	AudioImport *import;
+	int importType;
+
 public:
 	AudioPanel(wxFrame* parent, int index, std::string name, wxString labelStr, bool mode);
+	~AudioPanel();
 
 	void OnPaint(wxPaintEvent& WXUNUSED(evt));
 	void OnMenuEvent(wxCommandEvent& event);
 	void OnRightUp(wxMouseEvent& WXUNUSED(event));
+	void OnImportProgress(wxThreadEvent& event);
 
 	void AddAudio(std::string filename);
 	void RemoveAudio(std::string filename);
+	void RemoveFilePanel(AudioFilePanel *afp);
 	void AddAudioPath(wxString path);
+	void AddAudioPaths(const wxArrayString& paths);
 	void AddAudioDialog();
+	void AddAudioDirDialog();
 	void UpdateTrackName(std::string newName);
 	void UpdateAudioName(std::string oldName, std::string newName);
+	void UpdateSelection(const std::vector<audioSelection>& sorted);
+	void SetPlayTime(std::string playingAudio, double ms);
+	void UpdateLayout();
 };
 
 #endif
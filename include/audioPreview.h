@@ -0,0 +1,112 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __AUDIOPREVIEW_H__
+#define __AUDIOPREVIEW_H__
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#define PREVIEW_BLOCK_FRAMES	256
+#define PREVIEW_RING_BLOCKS		128
+
+// Stereo frames decoded ahead by the preview worker. Blocks from before the
+// last Play/Seek/Stop carry an old generation and are dropped unheard.
+typedef struct {
+	unsigned int generation;
+	int frames;
+	bool eof;
+	double position;
+	double step;
+	int16_t samples[PREVIEW_BLOCK_FRAMES * 2];
+} previewBlock;
+
+// Plays a single audio file next to whatever oaml is playing. The file is
+// decoded and resampled to the device rate on a worker thread, the audio
+// callback only pops ready blocks from a lock-free ring in Mix().
+class AudioPreview {
+private:
+	int outputRate;
+
+	SpscRing<previewBlock, PREVIEW_RING_BLOCKS> ring;
+	std::atomic<unsigned int> generation;
+	std::atomic<unsigned int> session;
+	std::atomic<unsigned int> endedGeneration;
+	std::atomic<long long> playFrame;
+	std::atomic<unsigned int> underruns;
+
+	// Audio thread only
+	previewBlock current;
+	int currentOffset;
+	unsigned int primedGeneration;
+
+	// Requests for the worker
+	std::mutex mutex;
+	std::condition_variable cond;
+	std::thread worker;
+	bool workerStarted;
+	bool quit;
+	std::string requestFile;
+	long long requestFrame;
+	unsigned int requestGeneration;
+
+	// Worker thread only
+	audioFile *handle;
+	std::string sourceFile;
+	unsigned int decodeGeneration;
+	std::vector<float> srcBuf;
+	long long srcStart;
+	int srcFrames;
+	bool srcEof;
+	std::vector<uint8_t> pending;
+	double readPos;
+	double step;
+	MemAccount mem;
+
+	void Worker();
+	bool OpenSource(std::string filename, long long frame);
+	bool SeekSource(long long frame);
+	void CloseSource();
+	bool FillSource(long long needFrame);
+	bool DecodeBlock(previewBlock& block);
+	void UpdateMemory();
+
+public:
+	AudioPreview();
+	~AudioPreview();
+
+	void SetOutputRate(int rate) { outputRate = rate; }
+
+	unsigned int Play(std::string filename, long long frame = 0);
+	void Seek(unsigned int _session, long long frame);
+	void Stop();
+
+	bool IsPlaying(unsigned int _session) const { return session == _session && endedGeneration != generation; }
+	long long GetPosition() const { return playFrame.load(std::memory_order_relaxed); }
+	unsigned int GetUnderruns() const { return underruns.load(std::memory_order_relaxed); }
+
+	void Mix(int16_t *buffer, int frames, int channels);
+};
+
+#endif
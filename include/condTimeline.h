@@ -0,0 +1,55 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __CONDTIMELINE_H__
+#define __CONDTIMELINE_H__
+
+typedef struct {
+	double time;
+	int condId;
+	int condValue;
+} condEvent;
+
+bool CondEventLess(const condEvent& a, const condEvent& b);
+
+// A scripted list of SetCondition calls, one "<seconds> <condId> <condValue>"
+// per line, '#' starts a comment. Events are kept sorted by time.
+class CondTimeline {
+private:
+	std::vector<condEvent> events;
+	size_t next;
+
+public:
+	CondTimeline();
+
+	int Parse(const std::string& text, std::string *error = NULL);
+	int Load(const char *filename, std::string *error = NULL);
+	void Add(double time, int condId, int condValue);
+
+	void Rewind() { next = 0; }
+	bool PopDue(double time, condEvent& event);
+
+	const std::vector<condEvent>& GetEvents() const { return events; }
+	double GetLength() const;
+};
+
+#endif
@@ -0,0 +1,83 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __CONDITIONLATENCY_H__
+#define __CONDITIONLATENCY_H__
+
+#include <map>
+
+#define LATENCY_BUCKETS		32
+#define LATENCY_BUCKET_MS	250
+// Conditions that don't switch audio in this long are forgotten
+#define LATENCY_TIMEOUT_MS	30000
+// Percentiles come from the most recent switches only
+#define LATENCY_RECENT		256
+
+// condType of oamlAudioInfo, in the order the control panel lists them
+enum {
+	LATENCY_COND_EQUAL,
+	LATENCY_COND_GREATER,
+	LATENCY_COND_LESS,
+	LATENCY_COND_RANGE
+};
+
+typedef struct {
+	int counts[LATENCY_BUCKETS + 1];
+	int total;
+	double sumMs;
+	double maxMs;
+	double recent[LATENCY_RECENT];
+	int recentCount;
+	int recentNext;
+} latencyHistogram;
+
+// Time from a SetCondition call to oaml starting the audio it selects,
+// kept as a histogram for every track. Other switches don't count.
+class ConditionLatency {
+private:
+	std::map<std::string, latencyHistogram> histograms;
+
+	bool pending;
+	double pendingTime;
+	std::string pendingTrack;
+	std::string pendingAudio;
+	int pendingCondId;
+	int pendingCondValue;
+
+public:
+	ConditionLatency();
+
+	void OnSetCondition(double nowMs, std::string trackName, std::string currentAudio, int condId, int condValue);
+	bool OnAudioPlaying(double nowMs, const oamlTrackInfo& track, std::string audioName);
+	void CancelPending() { pending = false; }
+	bool IsPending() const { return pending; }
+
+	const latencyHistogram* GetHistogram(std::string trackName) const;
+	double GetPercentile(std::string trackName, double p) const;
+	void Clear();
+
+	static double WorstCaseMs(const oamlTrackInfo& track, float projectBpm, int projectBeatsPerBar);
+	static bool AudioMatches(const oamlAudioInfo& audio, int condId, int condValue);
+	static bool IsConditionSwitch(const oamlTrackInfo& track, std::string before, std::string after, int condId, int condValue);
+};
+
+#endif
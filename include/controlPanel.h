@@ -54,10 +54,12 @@ private:
 	std::string trackName;
 	std::string audioName;
 	std::string filename;
+	std::vector<audioSelection> selection;
 
 	bool musicMode;
 
 	void MarkProjectDirty();
+	void ApplyProperty(int prop, float value);
 
 public:
 	ControlPanel(wxFrame* parent, wxWindowID id);
@@ -87,6 +89,7 @@ public:
 	void OnPause(wxCommandEvent& event);
 	void SetTrack(std::string name);
 	void OnSelectAudio(std::string _audioName, std::string _filename);
+	void OnSelectAudios(const std::vector<audioSelection>& list);
 
 	std::string GetTrackName() const { return trackName; }
 	void UpdateTrackName(std::string oldName, std::string newName);
@@ -94,6 +97,7 @@ public:
 	void SetTrackMode(bool mode);
 
 	bool IsMusicMode() const { return musicMode; }
+	bool IsBatchMode() const { return selection.size() > 1; }
 };
 
 #endif
@@ -0,0 +1,74 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __DIAGNOSTICSFRAME_H__
+#define __DIAGNOSTICSFRAME_H__
+
+#include <wx/listctrl.h>
+#include <wx/spinctrl.h>
+
+class DiagnosticsTimer;
+
+#define DIAGNOSTICS_REFRESH_RATE	1000
+
+// Where the memory goes, per subsystem and per track, next to the ui stalls
+// seen by the watchdog. Double click a subsystem to set its budget.
+class DiagnosticsFrame: public wxFrame {
+private:
+	wxStaticText *summaryText;
+	wxListCtrl *memoryList;
+	wxListCtrl *objectList;
+	wxSpinCtrlDouble *trackBudgetCtrl;
+	wxListCtrl *trackList;
+	wxListCtrl *stallList;
+	DiagnosticsTimer *timer;
+
+	wxBoxSizer *mSizer;
+
+	void UpdateMemory();
+	void UpdateTracks();
+	void UpdateStalls();
+
+public:
+	DiagnosticsFrame(wxWindow *parent, wxWindowID id);
+	~DiagnosticsFrame();
+
+	bool Show(bool show = true);
+
+	void OnClose(wxCloseEvent& event);
+	void OnMemoryActivated(wxListEvent& event);
+	void OnTrackBudgetChange(wxCommandEvent& event);
+
+	void Update();
+
+	static void LoadBudgets(wxConfig *config);
+};
+
+class DiagnosticsTimer : public wxTimer {
+	DiagnosticsFrame* pane;
+public:
+	DiagnosticsTimer(DiagnosticsFrame* pane);
+
+	void Notify();
+};
+
+#endif
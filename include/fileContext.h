@@ -0,0 +1,92 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __FILECONTEXT_H__
+#define __FILECONTEXT_H__
+
+#include <atomic>
+#include <memory>
+
+// How many contexts can be alive at once, each one owns a set of callbacks
+#define FILE_CONTEXT_SLOTS	32
+
+typedef struct {
+	uint64_t opens;
+	uint64_t failedOpens;
+	uint64_t reads;
+	uint64_t bytesRead;
+	uint64_t ioNs;
+} fileStats;
+
+// Where and how the readers open their files. Nothing changes after Create,
+// so one context can be shared by any number of threads, only the stats are
+// updated. Every open file keeps its context alive until it is closed.
+class FileContext : public std::enable_shared_from_this<FileContext> {
+private:
+	const std::string root;
+	const size_t readAhead;
+	int slot;
+	oamlFileCallbacks cbs;
+
+	std::atomic<uint64_t> opens;
+	std::atomic<uint64_t> failedOpens;
+	std::atomic<uint64_t> reads;
+	std::atomic<uint64_t> bytesRead;
+	std::atomic<uint64_t> ioNs;
+
+	FileContext(const std::string& _root, size_t _readAhead);
+	FileContext(const FileContext&);
+	FileContext& operator=(const FileContext&);
+
+public:
+	~FileContext();
+
+	// readAhead is the stdio buffer size of each open file, 0 keeps the
+	// default. Returns NULL when every slot is taken.
+	static std::shared_ptr<FileContext> Create(const std::string& root, size_t readAhead = 0);
+
+	const std::string& GetRoot() const { return root; }
+	size_t GetReadAhead() const { return readAhead; }
+
+	// Callbacks bound to this context, for the readers and oaml. They are
+	// only valid while the context is alive.
+	oamlFileCallbacks* GetCallbacks() { return &cbs; }
+
+	void* Open(const char *filename);
+	void GetStats(fileStats& out) const;
+
+	static size_t Read(void *ptr, size_t size, size_t nitems, void *fd);
+	static int Seek(void *fd, long offset, int whence);
+	static long Tell(void *fd);
+	static int Close(void *fd);
+};
+
+// The context of the loaded project. Setting it publishes a new context,
+// files that are already open keep reading through the old one.
+void SetProjectFiles(const std::string& root);
+std::shared_ptr<FileContext> GetProjectFiles();
+
+// A context of its own on the project root, for workers that want their own
+// read-ahead and stats. Falls back to the shared one when none is left.
+std::shared_ptr<FileContext> CreateProjectFiles(size_t readAhead);
+
+#endif /* __FILECONTEXT_H__ */
@@ -0,0 +1,68 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __LEVELMETER_H__
+#define __LEVELMETER_H__
+
+#define METER_CHANNELS	2
+// Blocks the audio callback can queue for the UI before it starts dropping
+#define METER_RING_BLOCKS	256
+
+// Samples are scaled by 32768, positive full scale never reaches 1.0
+#define METER_CLIP_LEVEL	(32767.0f / 32768.0f)
+
+// Statistics of one block of mixed audio, sums are kept so blocks can be merged
+typedef struct {
+	float peak[METER_CHANNELS];
+	float sumSquares[METER_CHANNELS];
+	int frames;
+} meterBlock;
+
+void MeterClear(meterBlock& block);
+void MeterAnalyze(const int16_t *samples, int frames, int channels, meterBlock& block);
+void MeterMerge(meterBlock& into, const meterBlock& block);
+float MeterToDb(float value);
+
+// UI side of a meter, turns the blocks received since the last refresh into
+// what gets drawn: current peak/RMS, a falling peak hold and a clip flag.
+class LevelMeter {
+private:
+	float peak[METER_CHANNELS];
+	float rms[METER_CHANNELS];
+	float hold[METER_CHANNELS];
+	int holdTicks[METER_CHANNELS];
+	bool clipped[METER_CHANNELS];
+
+public:
+	LevelMeter();
+
+	void Reset();
+	void Update(const meterBlock& block);
+
+	float GetPeak(int channel) const { return peak[channel]; }
+	float GetRms(int channel) const { return rms[channel]; }
+	float GetHold(int channel) const { return hold[channel]; }
+	bool IsClipped(int channel) const { return clipped[channel]; }
+	void ResetClip();
+};
+
+#endif
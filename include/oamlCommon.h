@@ -23,59 +23,28 @@
 #ifndef __OAMLCOMMON_H__
 #define __OAMLCOMMON_H__
 
-#include <assert.h>
-
-//
-// Definitions
-//
-
-#ifdef _WIN32
-#define PATH_SEPARATOR "\\"
-#else
-#define PATH_SEPARATOR "/"
-#endif
-
-
-// Visual Studio specific stuff
-#ifdef _MSC_VER
-
-#define snprintf	sprintf_s
-
-#endif
-
-
-#ifdef DEBUG
-
-#ifdef _MSC_VER
-#define ASSERT(e)
-#else
-#define ASSERT(e)  \
-    ((void) ((e) ? ((void)0) : __assert (#e, __FILE__, __LINE__)))
-#endif
-
-#else
-
-#define ASSERT(e)
-
-#endif
-
-#include <oaml.h>
-#include "ByteBuffer.h"
-#include "audioFile.h"
-#include "aif.h"
-#include "ogg.h"
-#include "wav.h"
+#include "oamlCore.h"
+#include "trackIndex.h"
+#include "audioPreview.h"
+#include "studioAudio.h"
 #include "oamlStudio.h"
 #include "waveformDisplay.h"
 #include "layerPanel.h"
 #include "audioFilePanel.h"
 #include "audioPanel.h"
 #include "playbackFrame.h"
+#include "meterFrame.h"
 #include "settingsFrame.h"
 #include "controlPanel.h"
 #include "trackPanel.h"
 #include "trackControl.h"
 #include "startupFrame.h"
+#include "trackListView.h"
+#include "projectLoader.h"
+#include "audioImport.h"
+#include "uiWatchdog.h"
+#include "diagnosticsFrame.h"
 #include "studioFrame.h"
+#include "studioEventBus.h"
 
 #endif /* __OAMLCOMMON_H__ */
@@ -25,60 +25,70 @@
 
 #include <wx/wx.h>
 
-extern void InitCallbacks(std::string prjPath);
-extern oamlFileCallbacks studioCbs;
 extern oamlApi *oaml;
 extern oamlStudioApi *studioApi;
 extern std::string projectPath;
+extern double startupMs;
 
 wxDECLARE_EVENT(EVENT_ADD_AUDIO, wxCommandEvent);
 wxDECLARE_EVENT(EVENT_ADD_LAYER, wxCommandEvent);
+wxDECLARE_EVENT(EVENT_CLOSE_DIAGNOSTICS, wxCommandEvent);
+wxDECLARE_EVENT(EVENT_CLOSE_METERS, wxCommandEvent);
 wxDECLARE_EVENT(EVENT_CLOSE_PLAYBACK, wxCommandEvent);
 wxDECLARE_EVENT(EVENT_CLOSE_SETTINGS, wxCommandEvent);
 wxDECLARE_EVENT(EVENT_LOAD_PROJECT, wxCommandEvent);
+wxDECLARE_EVENT(EVENT_IMPORT_PROGRESS, wxThreadEvent);
 wxDECLARE_EVENT(EVENT_LOAD_OTHER, wxCommandEvent);
+wxDECLARE_EVENT(EVENT_LOAD_PROGRESS, wxThreadEvent);
 wxDECLARE_EVENT(EVENT_NEW_PROJECT, wxCommandEvent);
 wxDECLARE_EVENT(EVENT_PLAY, wxCommandEvent);
 wxDECLARE_EVENT(EVENT_RELOAD_DEFS, wxCommandEvent);
 wxDECLARE_EVENT(EVENT_REMOVE_AUDIO_FILE, wxCommandEvent);
 wxDECLARE_EVENT(EVENT_QUIT, wxCommandEvent);
-wxDECLARE_EVENT(EVENT_SELECT_AUDIO, wxCommandEvent);
-wxDECLARE_EVENT(EVENT_SET_PROJECT_DIRTY, wxCommandEvent);
-wxDECLARE_EVENT(EVENT_SET_STATUS_TEXT, wxCommandEvent);
-wxDECLARE_EVENT(EVENT_UPDATE_AUDIO_NAME, wxCommandEvent);
-wxDECLARE_EVENT(EVENT_UPDATE_LAYOUT, wxCommandEvent);
+wxDECLARE_EVENT(EVENT_UI_HEARTBEAT, wxThreadEvent);
 
 enum {
 	ID_Quit = 1,
 	ID_About,
 	ID_AddAudio,
+	ID_AddAudioDir,
 	ID_AddAudioFile,
 	ID_AddLayer,
 	ID_AddMusicTrack,
 	ID_AddSfxTrack,
+	ID_AuditionAudio,
+	ID_Bounce,
+	ID_CancelLoad,
 	ID_Condition,
 	ID_DeleteLayer,
+	ID_DiagnosticsPanel,
 	ID_EditMusicTrackName,
 	ID_EditSfxTrackName,
 	ID_Export,
 	ID_Load,
+	ID_MetersPanel,
 	ID_New,
 	ID_Pause,
 	ID_Play,
 	ID_PlaybackPanel,
 	ID_Recent,
+	ID_RecordTrace,
 	ID_RemoveAudio,
 	ID_RemoveMusicTrack,
 	ID_RemoveSfxTrack,
 	ID_RemoveTrack,
 	ID_Save,
 	ID_SaveAs,
-	ID_SettingsPanel
+	ID_SettingsPanel,
+	ID_StopAudition
 };
 
 class oamlStudio : public wxApp {
 public:
 	virtual bool OnInit();
+	virtual int OnExit();
+
+	void OnStartupDone();
 };
 
 #endif /* __OAMLSTUDIO_H__ */
@@ -0,0 +1,72 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __OFFLINEBOUNCE_H__
+#define __OFFLINEBOUNCE_H__
+
+#include <atomic>
+
+// Frames mixed per step, conditions are applied on these boundaries
+#define BOUNCE_BLOCK_FRAMES	256
+
+typedef struct {
+	std::string trackName;
+	std::string outFile;
+	double seconds;
+	CondTimeline timeline;
+	int result;
+	std::string error;
+} bounceJob;
+
+// Renders tracks to wav files without an audio device, as fast as oaml can
+// mix. Each job gets its own oamlApi instance so jobs run in parallel.
+class OfflineBounce {
+private:
+	std::string defsFile;
+	std::shared_ptr<FileContext> fileContext;
+	int sampleRate;
+	int channels;
+	int format;
+
+	std::vector<bounceJob> jobs;
+	std::atomic<bool> cancelled;
+	std::atomic<bool> finished;
+	std::atomic<long long> framesDone;
+	long long framesTotal;
+
+	void RenderJob(bounceJob& job);
+	void Worker(std::atomic<int> *index);
+
+public:
+	OfflineBounce(std::string _defsFile, int _sampleRate = 44100, int _channels = 2, int _format = AF_FORMAT_SINT16);
+
+	void AddJob(std::string trackName, std::string outFile, double seconds, const CondTimeline& timeline);
+	int Run(int threads = 0);
+	void Cancel() { cancelled = true; }
+
+	bool IsCancelled() const { return cancelled; }
+	bool IsFinished() const { return finished; }
+	float GetProgress() const;
+	const std::vector<bounceJob>& GetJobs() const { return jobs; }
+};
+
+#endif
@@ -23,6 +23,15 @@
 #ifndef __OGG_H__
 #define __OGG_H__
 
+// A page we've been to, the frame it starts at and its offset in the file
+typedef struct {
+	int64_t frame;
+	int64_t offset;
+} oggSeekPoint;
+
+// Open only probes the headers, the vorbis decoder is set up by the first
+// Read or SeekFrame. Until then GetTotalSamples comes from the granule
+// position of the last page.
 class oggFile : public audioFile {
 private:
 	void *vf;
@@ -33,6 +42,13 @@ private:
 	int totalSamples;
 
 	int currentSection;
+
+	std::vector<oggSeekPoint> seekTable;
+
+	int Probe();
+	int OpenDecoder();
+	void AddSeekPoint(const oggSeekPoint& point);
+	int SkipFrames(int64_t frames);
 public:
 	oggFile(oamlFileCallbacks *cbs);
 	~oggFile();
@@ -48,6 +64,7 @@ public:
 
 	int Open(const char *filename);
 	int Read(char *buffer, int size);
+	int SeekFrame(int64_t frame);
 
 	void Close();
 };
@@ -0,0 +1,63 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __PEAKBUILDER_H__
+#define __PEAKBUILDER_H__
+
+// Reduces the decoded samples of an audio file to the per pixel peaks drawn
+// by WaveformDisplay. Data can be fed in chunks of any size.
+class PeakBuilder {
+private:
+	int format;
+	int bytesPerSample;
+	int samplesPerPixel;
+
+	int peakl;
+	int peakr;
+	int count;
+
+	std::vector<uint8_t> pending;
+	std::vector<int> peaksL;
+	std::vector<int> peaksR;
+	MemAccount mem;
+
+	int Read32(const uint8_t *ptr) const;
+	void AddFrame(const uint8_t *ptr);
+
+public:
+	PeakBuilder();
+
+	void Reset(int _format, int _bytesPerSample, int _samplesPerPixel);
+	void Feed(const uint8_t *data, int size);
+	bool Decode(audioFile *handle, int bytes);
+
+	void SetMemoryFile(std::string file) { mem.SetFile(file); }
+	void UpdateMemory();
+
+	int GetSamplesPerPixel() const { return samplesPerPixel; }
+	std::vector<int>& GetPeaksL() { return peaksL; }
+	std::vector<int>& GetPeaksR() { return peaksR; }
+
+	static int GetSamplesPerPixel(audioFile *handle, bool sfxMode, int *width);
+};
+
+#endif
@@ -0,0 +1,50 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __PEAKCACHE_H__
+#define __PEAKCACHE_H__
+
+#include <map>
+#include <mutex>
+
+typedef struct {
+	std::vector<int> peaksL;
+	std::vector<int> peaksR;
+} peakCacheEntry;
+
+// Waveform peaks already computed for the project files, shared between the
+// waveform displays and the background loader.
+class PeakCache {
+private:
+	std::mutex mutex;
+	std::map<std::pair<std::string, int>, peakCacheEntry> entries;
+
+public:
+	bool Has(std::string filename, int samplesPerPixel);
+	bool Get(std::string filename, int samplesPerPixel, std::vector<int>& peaksL, std::vector<int>& peaksR);
+	void Put(std::string filename, int samplesPerPixel, const std::vector<int>& peaksL, const std::vector<int>& peaksR);
+	void Clear();
+};
+
+extern PeakCache peakCache;
+
+#endif
@@ -25,12 +25,22 @@
 
 class PlaybackTimer;
 
+// Poll fast while the playback state changes, slow down when it doesn't
+#define PLAYBACK_FAST_RATE	33
+#define PLAYBACK_SLOW_RATE	250
+#define PLAYBACK_IDLE_TICKS	30
+
 class PlaybackFrame: public wxFrame {
 private:
 	wxTextCtrl *condIdCtrl;
 	wxTextCtrl *condValueCtrl;
-	wxTextCtrl *infoText;
+	wxStaticText *statusText;
+	wxStaticText *condText;
+	wxStaticText *rowNames[PLAYBACK_STATE_ROWS];
+	wxStaticText *rowDetails[PLAYBACK_STATE_ROWS];
 	PlaybackTimer *timer;
+	wxStaticText *latencyText;
+	wxPanel *latencyPanel;
 	wxBitmapButton *playBtn;
 	wxBitmapButton *pauseBtn;
 	wxButton *condBtn;
@@ -38,6 +48,27 @@ private:
 	wxBoxSizer *mSizer;
 	wxBoxSizer *hSizer;
 
+	playbackState shown;
+	int condSet;
+	int condId;
+	int condValue;
+	int idleTicks;
+	bool updatesEnabled;
+
+	ConditionLatency latency;
+	std::string playingTrack;
+	oamlTrackInfo trackInfo;
+	std::vector<std::string> trackAudios;
+	std::vector<int> audiosPlaying;
+	std::vector<int> audiosFound;
+	std::string playingAudio;
+	double playingAudioStart;
+	double worstCaseMs;
+
+	void SetRate(int interval);
+	void ShowState(const playbackState& state);
+	void ShowLatency();
+
 public:
 	PlaybackFrame(wxWindow *parent, wxWindowID id);
 	~PlaybackFrame();
@@ -46,7 +77,11 @@ public:
 	void OnPlay(wxCommandEvent& WXUNUSED(event));
 	void OnPause(wxCommandEvent& WXUNUSED(event));
 	void OnCondition(wxCommandEvent& WXUNUSED(event));
+	void OnPaintLatency(wxPaintEvent& WXUNUSED(event));
 
+	void EnableUpdates(bool enable);
+	void Wake();
+	void SetPlayingTrack(std::string trackName);
 	void Update();
 };
 
@@ -0,0 +1,61 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __PLAYBACKSTATE_H__
+#define __PLAYBACKSTATE_H__
+
+#define PLAYBACK_STATE_ROWS		8
+#define PLAYBACK_STATE_NAME		64
+#define PLAYBACK_STATE_DETAIL	160
+
+typedef struct {
+	char name[PLAYBACK_STATE_NAME];
+	char detail[PLAYBACK_STATE_DETAIL];
+} playbackRow;
+
+// Plain data only, it's compared and copied with memcmp/memcpy
+typedef struct {
+	int playing;
+	int paused;
+	int condSet;
+	int condId;
+	int condValue;
+	char track[PLAYBACK_STATE_NAME];
+	char audio[PLAYBACK_STATE_NAME];
+	double audioStartMs;
+	int rowCount;
+	playbackRow rows[PLAYBACK_STATE_ROWS];
+} playbackState;
+
+void PlaybackStateClear(playbackState& state);
+void PlaybackStateParse(const std::string& info, playbackState& state);
+void PlaybackStateSetAudio(playbackState& state, const std::string& track, const std::string& audio, double startMs);
+bool PlaybackStateEqual(const playbackState& a, const playbackState& b);
+int PlaybackFindAudio(const std::string& info, const std::vector<std::string>& names);
+void PlaybackFindAudios(const std::string& info, const std::vector<std::string>& names, std::vector<int>& found);
+double PlaybackNowMs();
+
+// Last state the playback panel saw, it and the track panels both
+// live on the UI thread so a plain copy is all they need
+extern playbackState playbackCurrent;
+
+#endif
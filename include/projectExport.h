@@ -0,0 +1,36 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __PROJECTEXPORT_H__
+#define __PROJECTEXPORT_H__
+
+#include "tinyxml2.h"
+
+// Writes the oaml.defs of a project and packs it together with its audio
+// files into a zip. When createPkg is set the filenames in the defs are
+// stripped of their path, as they all end up in the root of the package.
+void ExportCreateDefs(tinyxml2::XMLDocument& xmlDoc, oamlTracksInfo *info, bool createPkg = false);
+int ExportCreateZip(std::string zfile, oamlTracksInfo *info, std::vector<std::string> files, std::string& error);
+
+std::string ExportFileName(std::string path);
+
+#endif /* __PROJECTEXPORT_H__ */
@@ -0,0 +1,95 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __PROJECTLOADER_H__
+#define __PROJECTLOADER_H__
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+enum {
+	LOAD_STAGE_PARSE,
+	LOAD_STAGE_MODEL_READY,
+	LOAD_STAGE_CHECK_FILES,
+	LOAD_STAGE_PROBE,
+	LOAD_STAGE_PEAKS,
+	LOAD_STAGE_DONE,
+	LOAD_STAGE_FAILED,
+	LOAD_STAGE_CANCELLED
+};
+
+typedef struct {
+	int generation;
+	int stage;
+	int done;
+	int total;
+	int missing;
+	int unreadable;
+	bool modelReady;
+} loadProgress;
+
+typedef struct {
+	std::string filename;
+	bool sfx;
+	bool readable;
+} loadFile;
+
+// Loads a project on a worker thread. oaml->Init() runs first, once the
+// model is ready the frame is told so it can show the tracks while the
+// files are checked, probed and their waveform peaks are computed.
+class ProjectLoader {
+private:
+	wxEvtHandler *sink;
+	std::thread thread;
+
+	std::atomic<bool> cancelled;
+	std::atomic<bool> running;
+	std::atomic<bool> parsing;
+
+	int generation;
+	std::string defsFile;
+	std::vector<loadFile> files;
+	std::shared_ptr<FileContext> fileContext;
+	loadProgress progress;
+
+	void Run();
+	void Post(int stage, int done, int total);
+	void GatherFiles();
+	bool CheckFiles();
+	bool ProbeFiles();
+	bool ComputePeaks();
+
+public:
+	ProjectLoader(wxEvtHandler *_sink);
+	~ProjectLoader();
+
+	void Start(std::string _defsFile);
+	void Cancel();
+	void Join();
+
+	int GetGeneration() const { return generation; }
+	bool IsRunning() const { return running; }
+	bool IsParsing() const { return parsing; }
+};
+
+#endif
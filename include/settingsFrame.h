@@ -25,23 +25,58 @@
 
 #include <wx/spinctrl.h>
 
+class SettingsTimer;
+
+#define SETTINGS_REFRESH_RATE	500
+
 class SettingsFrame: public wxFrame {
 private:
 	wxSpinCtrlDouble *bpmCtrl;
 	wxSpinCtrlDouble *bpbCtrl;
 
+	wxChoice *rateChoice;
+	wxChoice *bufferChoice;
+	wxButton *applyBtn;
+	wxButton *safeBtn;
+	wxButton *resetBtn;
+	wxStaticText *deviceText;
+	wxStaticText *statsText;
+	SettingsTimer *timer;
+
 	wxBoxSizer *mSizer;
 	wxGridSizer *sizer;
 
+	uint64_t lastBusyNs;
+	wxLongLong lastTime;
+
+	void SelectDeviceChoices(int rate, int frames);
+	void ApplyDevice(int rate, int frames);
+	void EnableDeviceControls(bool enable);
+
 public:
 	SettingsFrame(wxWindow *parent, wxWindowID id);
 	~SettingsFrame();
 
+	bool Show(bool show = true);
+
 	void OnLoad();
 
 	void OnClose(wxCloseEvent& event);
 	void OnBpmChange(wxCommandEvent& event);
 	void OnBpbChange(wxCommandEvent& event);
+	void OnApplyDevice(wxCommandEvent& event);
+	void OnSafeProfile(wxCommandEvent& event);
+	void OnResetStats(wxCommandEvent& event);
+
+	void Update();
+};
+
+class SettingsTimer : public wxTimer {
+	SettingsFrame* pane;
+public:
+	SettingsTimer(SettingsFrame* pane);
+
+	void Notify();
 };
 
 #endif
@@ -31,11 +31,9 @@ class StartupFrame : public wxFrame {
 private:
 	wxBoxSizer* mainSizer;
 	wxListView* prjList;
-	wxConfig *config;
-	wxFileHistory* fileHistory;
 
 public:
-	StartupFrame(wxWindow *parent);
+	StartupFrame(wxWindow *parent, wxFileHistory *fileHistory);
 
 	void OnPrjListActivated(wxListEvent& event);
 	void OnNewProject(wxCommandEvent& WXUNUSED(event));
@@ -0,0 +1,113 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __STUDIOAUDIO_H__
+#define __STUDIOAUDIO_H__
+
+#include <atomic>
+#include <thread>
+
+// Callback durations from 0 to twice the buffer length
+#define AUDIO_LOAD_BUCKETS	64
+
+// The "safe" profile trades latency for headroom on big projects
+#define AUDIO_SAFE_RATE		44100
+#define AUDIO_SAFE_FRAMES	4096
+
+typedef struct {
+	uint64_t callbacks;
+	uint64_t lastNs;
+	uint64_t maxNs;
+	uint64_t budgetNs;
+	uint64_t busyNs;
+	unsigned int lateCallbacks;
+	unsigned int gaps;
+	unsigned int meterDropped;
+	uint32_t buckets[AUDIO_LOAD_BUCKETS];
+} audioCallbackStats;
+
+// The audio device used by the studio. oaml mixes into our buffer from the
+// device callback, which lets us meter the output and add the preview voice
+// on top. Nothing in Process() locks or allocates.
+class StudioAudio {
+private:
+	oamlApi *api;
+
+	int sampleRate;
+	int channels;
+	int bufferFrames;
+	std::atomic<bool> opened;
+
+	std::thread opener;
+	std::atomic<uint64_t> openNs;
+
+	std::atomic<bool> metering;
+	SpscRing<meterBlock, METER_RING_BLOCKS> meterRing;
+	std::atomic<unsigned int> meterDropped;
+
+	std::atomic<uint64_t> callbacks;
+	std::atomic<uint64_t> lastNs;
+	std::atomic<uint64_t> maxNs;
+	std::atomic<bool> resetMax;
+
+	uint64_t budgetNs;
+	uint64_t lastStartNs;
+	std::atomic<uint64_t> busyNs;
+	std::atomic<unsigned int> lateCallbacks;
+	std::atomic<unsigned int> gaps;
+	std::atomic<uint32_t> loadBuckets[AUDIO_LOAD_BUCKETS];
+
+	AudioPreview preview;
+
+	void OpenWorker(int _sampleRate, int _channels, int _bufferFrames);
+
+public:
+	StudioAudio(oamlApi *_api);
+	~StudioAudio();
+
+	int Open(int _sampleRate = 44100, int _channels = 2, int _bufferFrames = 1024);
+	void OpenAsync(int _sampleRate, int _channels, int _bufferFrames);
+	void WaitOpen();
+	double GetOpenMs() const { return openNs.load() / 1000000.0; }
+	void Close();
+	void Process(int16_t *buffer, int frames);
+
+	bool IsOpen() const { return opened; }
+	int GetSampleRate() const { return sampleRate; }
+	int GetChannels() const { return channels; }
+	int GetBufferFrames() const { return bufferFrames; }
+
+	void SetMetering(bool enable) { metering = enable; }
+	bool IsMetering() const { return metering; }
+	bool PopMeter(meterBlock& block) { return meterRing.Pop(block); }
+
+	AudioPreview* GetPreview() { return &preview; }
+
+	void GetCallbackStats(audioCallbackStats& stats, bool clearMax);
+	void ResetCallbackStats();
+
+	static uint64_t GetPercentileNs(const audioCallbackStats& stats, double p);
+};
+
+extern StudioAudio *studioAudio;
+
+#endif
@@ -0,0 +1,39 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __STUDIOCLI_H__
+#define __STUDIOCLI_H__
+
+// Command line modes that run without opening any window
+bool CliIsCommand(int argc, char **argv);
+int CliMain(int argc, char **argv);
+void CliUsage();
+
+// --trace <file> records from startup until exit in any mode. Takes it out
+// of argv and starts recording, the file is written by CliStopTrace.
+std::string CliStartTrace(int& argc, char **argv);
+void CliStopTrace(const std::string& traceFile);
+
+void CliSplitDefsPath(std::string path, std::string& dir, std::string& file);
+void CliJsonString(FILE *f, const std::string& str);
+
+#endif
@@ -0,0 +1,73 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __STUDIOEVENTBUS_H__
+#define __STUDIOEVENTBUS_H__
+
+class StudioFrame;
+
+typedef struct {
+	std::string trackName;
+	std::string oldName;
+	std::string newName;
+} audioRenameEvent;
+
+typedef struct {
+	std::string audioName;
+	std::string filename;
+	bool extend;
+} audioSelectEvent;
+
+// Collects the notifications posted by the panels during a frame and
+// dispatches them to the StudioFrame at once. Redundant notifications are
+// coalesced: dirty and layout requests are merged, chained renames of an
+// audio collapse into a single one and only the last status text is kept.
+class StudioEventBus : public wxTimer {
+private:
+	StudioFrame *frame;
+
+	bool dirty;
+	bool layout;
+	bool hasStatus;
+	wxString status;
+	std::vector<audioRenameEvent> renames;
+	std::vector<audioSelectEvent> selects;
+
+	void Schedule();
+
+public:
+	StudioEventBus(StudioFrame *_frame);
+	~StudioEventBus();
+
+	void PostDirty();
+	void PostLayout();
+	void PostStatusText(wxString text);
+	void PostAudioRename(std::string trackName, std::string oldName, std::string newName);
+	void PostSelectAudio(std::string audioName, std::string filename, bool extend);
+
+	void Flush();
+	void Notify();
+};
+
+extern StudioEventBus *eventBus;
+
+#endif
@@ -40,29 +40,17 @@
 #include <wx/filehistory.h>
 #include <wx/config.h>
 #include <wx/statline.h>
+#include <wx/srchctrl.h>
 #include <archive.h>
 #include <archive_entry.h>
 
-class StudioFrame;
-
-class StudioTimer : public wxTimer {
-	StudioFrame* pane;
-public:
-	int labelIndex;
-	wxListView* musicList;
-	wxListView* sfxList;
-	std::string trackName;
-
-	StudioTimer(StudioFrame* pane);
-
-	void Notify();
-};
-
 class StudioFrame: public wxFrame {
 private:
 	wxConfig *config;
-	wxListView* musicList;
-	wxListView* sfxList;
+	wxSearchCtrl* searchCtrl;
+	TrackListView* musicList;
+	TrackListView* sfxList;
+	TrackIndex trackIndex;
 	wxBoxSizer* mainSizer;
 	wxBoxSizer* vSizer;
 	wxBoxSizer* hSizer;
@@ -72,55 +60,65 @@ private:
 	ControlPanel* controlPane;
 	TrackPanel* trackPane;
 	TrackControl* trackControl;
-	StudioTimer* timer;
 	StartupFrame* startupFrame;
 	PlaybackFrame* playbackFrame;
+	MeterFrame* meterFrame;
+	DiagnosticsFrame* diagnosticsFrame;
+	ProjectLoader* loader;
+	UiWatchdog* watchdog;
 	SettingsFrame* settingsFrame;
 	LayerPanel* layerPanel;
 
 	wxMenu* viewMenu;
 
 	std::string defsPath;
+	MemAccount projectMem;
 
 	bool dirty;
 
-	void AddSimpleChildToNode(tinyxml2::XMLNode *node, const char *name, const char *value);
-	void AddSimpleChildToNode(tinyxml2::XMLNode *node, const char *name, int value);
-	void AddSimpleChildToNode(tinyxml2::XMLNode *node, const char *name, float value);
+	PlaybackFrame* GetPlaybackFrame();
+	void OpenPlaybackFrame();
+	MeterFrame* GetMeterFrame();
+	SettingsFrame* GetSettingsFrame();
+	DiagnosticsFrame* GetDiagnosticsFrame();
 
 	void SelectTrack(std::string name);
+	void RebuildTrackIndex();
+	void RenameTrack(TrackListView* list, wxListEvent& event);
 
-	void CreateDefs(tinyxml2::XMLDocument& xmlDoc, bool createPkg = false);
 	void Save();
 	bool SaveAs();
 
-	int WriteDefsToZip(struct archive *zip);
-	int WriteFileToZip(struct archive *zip, std::string file);
-	int CreateZip(std::string zfile, std::vector<std::string> files);
-
 	void Load(std::string filename);
-
-	void SetProjectDirty() { dirty = true; }
+	bool IsLoading();
 public:
 	StudioFrame(const wxString& title, const wxPoint& pos, const wxSize& size, long style);
 	~StudioFrame();
 
-	tinyxml2::XMLNode* CreateAudioDefs(tinyxml2::XMLDocument& xmlDoc, oamlAudioInfo *audio, bool createPkg);
-	tinyxml2::XMLNode* CreateTrackDefs(tinyxml2::XMLDocument& xmlDoc, oamlTrackInfo *track, bool createPkg);
+	wxConfig* GetConfig() const { return config; }
+	UiWatchdog* GetWatchdog() const { return watchdog; }
+	bool IsParsing() const { return loader->IsParsing(); }
 
 	void OnAbout(wxCommandEvent& event);
 	void OnAddAudio(wxCommandEvent& event);
 	void OnAddLayer(wxCommandEvent& event);
 	void OnAddMusicTrack(wxCommandEvent& event);
 	void OnAddSfxTrack(wxCommandEvent& event);
+	void OnBounce(wxCommandEvent& event);
+	void OnCancelLoad(wxCommandEvent& event);
+	void OnDiagnosticsPanel(wxCommandEvent& event);
 	void OnClose(wxCloseEvent& event);
+	void OnCloseDiagnostics(wxCommandEvent& event);
+	void OnCloseMeters(wxCommandEvent& event);
 	void OnClosePlayback(wxCommandEvent& event);
 	void OnCloseSettings(wxCommandEvent& event);
 	void OnEditMusicTrackName(wxCommandEvent& event);
 	void OnEditSfxTrackName(wxCommandEvent& event);
 	void OnExport(wxCommandEvent& event);
 	void OnLoad(wxCommandEvent& event);
+	void OnLoadProgress(wxThreadEvent& event);
 	void OnLoadProject(wxCommandEvent& event);
+	void OnMetersPanel(wxCommandEvent& event);
 	void OnMusicListActivated(wxListEvent& event);
 	void OnMusicListMenu(wxMouseEvent& event);
 	void OnMusicEndLabelEdit(wxListEvent& event);
@@ -132,18 +130,20 @@ public:
 	void OnRemoveMusicTrack(wxCommandEvent& event);
 	void OnRemoveSfxTrack(wxCommandEvent& event);
 	void OnQuit(wxCommandEvent& event);
-	void OnSetProjectDirty(wxCommandEvent& event);
+	void OnRecordTrace(wxCommandEvent& event);
 	void OnSettingsPanel(wxCommandEvent& event);
 	void OnSfxListActivated(wxListEvent& event);
 	void OnSfxListMenu(wxMouseEvent& event);
 	void OnSfxEndLabelEdit(wxListEvent& event);
 	void OnSave(wxCommandEvent& event);
+	void OnSearch(wxCommandEvent& event);
 	void OnSaveAs(wxCommandEvent& event);
-	void OnSelectAudio(wxCommandEvent& event);
-	void OnSetStatusText(wxCommandEvent& event);
-	void OnUpdateAudioName(wxCommandEvent& event);
-	void OnUpdateLayout(wxCommandEvent& event);
 
+	void SetProjectDirty() { dirty = true; trackIndex.Invalidate(); }
+	void SelectAudio(std::string audioName, std::string filename, bool extend);
+	void UpdateAudioName(std::string trackName, std::string oldName, std::string newName);
+	void UpdateLayout();
+	void UpdateProjectMemory(oamlTracksInfo *info);
 	void UpdateTrackName(std::string trackName, std::string newName);
 
 	DECLARE_EVENT_TABLE()
@@ -0,0 +1,96 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __STUDIOMEMORY_H__
+#define __STUDIOMEMORY_H__
+
+#include <atomic>
+#include <map>
+
+enum {
+	MEM_PCM,
+	MEM_PEAKS,
+	MEM_PEAK_CACHE,
+	MEM_WIDGETS,
+	MEM_DECODERS,
+	MEM_PROJECT,
+	MEM_EXPORT,
+	MEM_SUBSYSTEMS
+};
+
+typedef struct {
+	int64_t bytes;
+	int64_t peakBytes;
+	int64_t objects;
+	int64_t budget;
+} memCounter;
+
+// What the files of one track cost. decodedBytes is what a fully decoded
+// copy of every file takes, heldBytes what the studio holds for them now.
+typedef struct {
+	std::string name;
+	int files;
+	int64_t decodedBytes;
+	int64_t heldBytes;
+	int64_t modelBytes;
+} memTrackUsage;
+
+// Bytes are charged to a subsystem and optionally to the file they belong
+// to, so the diagnostics can add them up per track. A budget of 0 means
+// none, crossing one is reported once on stderr.
+void MemCharge(int subsystem, const std::string& file, int64_t delta);
+void MemAddObjects(int subsystem, const char *kind, int delta);
+void MemGet(int subsystem, memCounter& out);
+void MemGetObjects(std::map<std::string, int64_t>& out);
+void MemResetPeaks();
+void MemSetBudget(int subsystem, int64_t bytes);
+const char* MemGetName(int subsystem);
+const char* MemGetKey(int subsystem);
+
+void MemSetDecodedSize(const std::string& file, int64_t bytes);
+void MemGetTrackUsage(oamlTracksInfo *info, std::vector<memTrackUsage>& out);
+int64_t MemEstimateProject(oamlTracksInfo *info);
+
+int64_t MemGetProcessBytes();
+void MemTraceCounters();
+
+// Keeps the charge of one owner up to date, whatever is left is released
+// when it goes away
+class MemAccount {
+private:
+	int subsystem;
+	std::string file;
+	int64_t bytes;
+
+	MemAccount(const MemAccount&);
+	MemAccount& operator=(const MemAccount&);
+
+public:
+	MemAccount(int _subsystem) : subsystem(_subsystem), bytes(0) {}
+	~MemAccount() { Set(0); }
+
+	void SetFile(const std::string& _file);
+	void Set(int64_t _bytes);
+	int64_t Get() const { return bytes; }
+};
+
+#endif /* __STUDIOMEMORY_H__ */
@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __STUDIOTRACE_H__
+#define __STUDIOTRACE_H__
+
+#include <atomic>
+
+#define TRACE_BUFFER_EVENTS		32768
+#define TRACE_THREAD_NAME		32
+
+enum {
+	TRACE_SPAN,
+	TRACE_COUNTER
+};
+
+typedef struct {
+	const char *name;
+	int type;
+	uint64_t startNs;
+	uint64_t endNs;
+	int64_t value;
+} traceEvent;
+
+// Per thread ring of spans. Only the owning thread writes, the dump reads
+// whatever was published before head.
+typedef struct {
+	std::atomic<uint64_t> head;
+	std::atomic<uint64_t> start;
+	std::atomic<bool> owned;
+	int tid;
+	char name[TRACE_THREAD_NAME];
+	traceEvent events[TRACE_BUFFER_EVENTS];
+} traceBuffer;
+
+extern std::atomic<bool> traceEnabled;
+
+// Innermost open scope of each thread, kept even when not recording so a
+// watchdog can tell what a stalled thread is busy with
+extern thread_local std::atomic<const char*> traceScopeName;
+
+// Span names must be string literals, only the pointer is stored
+void TraceStart();
+void TraceStop();
+bool TraceIsRecording();
+void TraceSetThreadName(const char *name);
+std::atomic<const char*>* TraceGetScopeName();
+void TraceRecord(const char *name, uint64_t startNs, uint64_t endNs);
+void TraceCounter(const char *name, int64_t value);
+uint64_t TraceNowNs();
+int TraceWriteJson(const char *filename);
+
+class TraceScope {
+private:
+	const char *name;
+	const char *parent;
+	uint64_t startNs;
+public:
+	TraceScope(const char *_name) : name(_name), parent(traceScopeName.load(std::memory_order_relaxed)), startNs(traceEnabled.load(std::memory_order_relaxed) ? TraceNowNs() : 0) {
+		traceScopeName.store(name, std::memory_order_relaxed);
+	}
+	~TraceScope() {
+		traceScopeName.store(parent, std::memory_order_relaxed);
+		if (startNs) TraceRecord(name, startNs, TraceNowNs());
+	}
+};
+
+#define TRACE_CONCAT2(a, b)	a##b
+#define TRACE_CONCAT(a, b)	TRACE_CONCAT2(a, b)
+#define TRACE_SCOPE(name)	TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#endif /* __STUDIOTRACE_H__ */
@@ -0,0 +1,68 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __TRACKINDEX_H__
+#define __TRACKINDEX_H__
+
+typedef struct {
+	std::string name;
+	bool musicTrack;
+	size_t textBegin;
+	size_t textEnd;
+} trackIndexEntry;
+
+// Searchable index of the project tracks. The names of every track, audio
+// and audio file are lowercased and packed together in a single buffer
+// ('\0' separated), so filtering thousands of tracks is a linear scan over
+// contiguous memory.
+class TrackIndex {
+private:
+	std::vector<trackIndexEntry> entries;
+	std::string text;
+
+	int generation;
+	bool stale;
+
+	void AddKey(const std::string& key);
+
+public:
+	TrackIndex();
+
+	void Build(oamlTracksInfo *info);
+	void Clear();
+
+	// The model changed under us, Build must be called before the next search
+	void Invalidate() { stale = true; }
+	bool IsStale() const { return stale; }
+	int GetGeneration() const { return generation; }
+
+	int GetCount() const { return (int)entries.size(); }
+	const std::string& GetName(int index) const { return entries[index].name; }
+	bool IsMusicTrack(int index) const { return entries[index].musicTrack; }
+
+	bool Matches(int index, const std::string& query) const;
+	void Filter(const std::string& query, bool musicTracks, const std::vector<int> *candidates, std::vector<int>& result) const;
+
+	static std::string Normalize(const std::string& str);
+};
+
+#endif
@@ -0,0 +1,52 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __TRACKLISTVIEW_H__
+#define __TRACKLISTVIEW_H__
+
+#include <wx/listctrl.h>
+
+// Virtual list of the music or sfx tracks, items are never inserted in the
+// control, they're served straight from the studio's TrackIndex.
+class TrackListView : public wxListView {
+private:
+	TrackIndex *index;
+	bool musicTracks;
+
+	std::vector<int> items;
+	std::string lastQuery;
+	int lastGeneration;
+
+public:
+	TrackListView(wxWindow *parent, TrackIndex *_index, bool _musicTracks);
+
+	void Filter(std::string query);
+
+	std::string GetTrackName(long item) const;
+	long FindTrack(std::string name) const;
+
+	void OnSize(wxSizeEvent& event);
+
+	virtual wxString OnGetItemText(long item, long column) const;
+};
+
+#endif
@@ -24,18 +24,29 @@
 #ifndef __TRACKPANEL_H__
 #define __TRACKPANEL_H__
 
+class TrackPlayheadTimer;
 
 class TrackPanel : public wxScrolledWindow {
 private:
 	wxBoxSizer* sizer;
 	AudioPanel* audioPanel[4];
 	std::string trackName;
+	std::vector<audioSelection> selection;
 
 	bool musicMode;
 	int panelCount;
 
+	TrackPlayheadTimer *playheadTimer;
+	double audioStartMs;
+	double pausedMs;
+	double pausedSinceMs;
+
+	void UpdateSelection();
+	void ShowPlayTime(std::string audioName, double ms);
+
 public:
 	TrackPanel(wxWindow* parent, wxWindowID id, std::string name);
+	~TrackPanel();
 
 	int GetPanelIndex(std::string audioFile);
 	void AddAudio(std::string audioFile);
@@ -43,8 +54,22 @@ public:
 	void UpdateTrackName(std::string oldName, std::string newName);
 	void UpdateAudioName(std::string oldName, std::string newName);
 
+	void SelectAudio(std::string audioName, std::string filename, bool extend);
+	const std::vector<audioSelection>& GetSelection() const { return selection; }
+
 	void SetTrackMode(bool mode);
-	void UpdateLayout(wxCommandEvent& event);
+	void UpdateLayout();
+
+	void StartPlayhead();
+	void UpdatePlayhead();
+};
+
+class TrackPlayheadTimer : public wxTimer {
+	TrackPanel* pane;
+public:
+	TrackPlayheadTimer(TrackPanel* pane);
+
+	void Notify();
 };
 
 #endif
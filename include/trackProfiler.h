@@ -0,0 +1,89 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __TRACKPROFILER_H__
+#define __TRACKPROFILER_H__
+
+#define PROFILE_BLOCK_FRAMES	1024
+
+typedef struct {
+	std::string audioName;
+	int files;
+	int resampledFiles;
+	long long frames;
+	// oaml only times the whole mix, this is the track's mix time over the
+	// blocks where the audio played, not the audio's own share of it
+	uint64_t trackMixNs;
+	int peakVoices;
+} profileAudioResult;
+
+typedef struct {
+	std::string trackName;
+	long long frames;
+	uint64_t mixNs;
+	uint64_t updateNs;
+	double worstBlockNsPerFrame;
+	int peakVoices;
+	int peakFilesReferenced;
+	uint64_t mixAllocs;
+	uint64_t mixAllocBytes;
+	std::vector<profileAudioResult> audios;
+} profileTrackResult;
+
+// Measures what the game's audio thread pays for each music track: time
+// spent in MixToBuffer per output frame, how many audios oaml plays at
+// once, how many files those reference and how many allocations happen
+// while mixing. Every track
+// runs on its own oaml instance with no audio device.
+class TrackProfiler {
+private:
+	std::string defsFile;
+	std::shared_ptr<FileContext> fileContext;
+	std::vector<std::string> trackNames;
+	CondTimeline timeline;
+	double seconds;
+	unsigned int seed;
+	int sampleRate;
+
+	std::vector<profileTrackResult> results;
+	double elapsedSeconds;
+
+	int ProfileTrack(oamlApi *api, oamlTrackInfo& track, profileTrackResult& result);
+
+public:
+	TrackProfiler(std::string _defsFile);
+
+	void AddTrack(std::string trackName) { trackNames.push_back(trackName); }
+	void SetTimeline(const CondTimeline& _timeline) { timeline = _timeline; }
+	void SetLength(double _seconds) { seconds = _seconds; }
+	void SetSeed(unsigned int _seed) { seed = _seed; }
+	void SetSampleRate(int rate) { sampleRate = rate; }
+
+	int Run(std::string *error);
+
+	const std::vector<profileTrackResult>& GetResults() const { return results; }
+
+	void WriteReport(FILE *f) const;
+	void WriteJson(FILE *f) const;
+};
+
+#endif
@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __UIWATCHDOG_H__
+#define __UIWATCHDOG_H__
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#define UI_HEARTBEAT_MS		100
+#define UI_SAMPLE_MS		10
+#define UI_STALL_MS			250
+#define UI_LATENCY_BUCKETS	14
+#define UI_STALL_HISTORY	32
+
+// Bucket 0 counts latencies under 1 ms, bucket i those under 2^i ms and
+// the last one everything longer
+typedef struct {
+	uint64_t counts[UI_LATENCY_BUCKETS];
+	uint64_t total;
+	double sumMs;
+	double maxMs;
+} uiLatencyHistogram;
+
+typedef struct {
+	double startMs;
+	double durationMs;
+	std::string scope;
+	int samples;
+} uiStall;
+
+// Measures how long the wx event loop takes to handle a heartbeat posted
+// from a watchdog thread. While a heartbeat is overdue the watchdog samples
+// the trace scope the ui thread is in, so every stall is reported with the
+// handler that caused it.
+class UiWatchdog : public wxEvtHandler {
+private:
+	wxFrame *frame;
+	std::atomic<const char*> *uiScope;
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable cond;
+	bool quit;
+
+	double pendingMs;
+	double lastBeatMs;
+	double lastStatusMs;
+	std::map<const char*, int> samples;
+	uiLatencyHistogram histogram;
+	std::vector<uiStall> stalls;
+
+	void Run();
+	void OnHeartbeat(wxThreadEvent& event);
+	void UpdateStatus();
+
+public:
+	UiWatchdog(wxFrame *_frame);
+	~UiWatchdog();
+
+	void GetHistogram(uiLatencyHistogram& out);
+	void GetStalls(std::vector<uiStall>& out);
+	void Reset();
+
+	static double NowMs();
+	static double GetPercentileMs(const uiLatencyHistogram& hist, double p);
+};
+
+#endif /* __UIWATCHDOG_H__ */
@@ -31,9 +31,13 @@ private:
 	int bitsPerSample;
 	int totalSamples;
 
-	int chunkSize;
+	int64_t chunkSize;
 	int status;
 
+	int64_t dataOffset;
+	int64_t dataSize;
+	uint64_t ds64DataSize;
+
 	int ReadChunk();
 public:
 	wavFile(oamlFileCallbacks *cbs);
@@ -48,6 +52,7 @@ public:
 
 	int Open(const char *filename);
 	int Read(char *buffer, int size);
+	int SeekFrame(int64_t frame);
 
 	void WriteToFile(const char *filename, ByteBuffer *buffer, int channels, unsigned int sampleRate, int bytesPerSample);
 
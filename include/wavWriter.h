@@ -0,0 +1,62 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __WAVWRITER_H__
+#define __WAVWRITER_H__
+
+// Writes a wav file as the audio comes in, the header sizes are filled in
+// by Close(). Files whose data grows past 4GB are turned into RF64.
+class wavWriter {
+private:
+	FILE *f;
+	int format;
+	int channels;
+	unsigned int sampleRate;
+	int bytesPerSample;
+
+	long long junkPos;
+	long long dataPos;
+	unsigned long long dataBytes;
+
+	std::vector<uint8_t> scratch;
+
+	int WriteHeader();
+	int FinishHeader();
+
+public:
+	wavWriter();
+	~wavWriter();
+
+	int Open(const char *filename, int _channels, unsigned int _sampleRate, int _format);
+	int Write(const void *data, int bytes);
+	int WriteInt16(const int16_t *samples, int count);
+	int WriteFloat(const float *samples, int count);
+	int Close();
+
+	bool IsOpen() const { return f != NULL; }
+	int GetBytesPerSample() const { return bytesPerSample; }
+	unsigned long long GetDataBytes() const { return dataBytes; }
+
+	static int FormatFromBytesPerSample(int bytes);
+};
+
+#endif
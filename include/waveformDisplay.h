@@ -31,35 +31,65 @@ public:
 	void Notify();
 };
 
+class WaveformDisplay;
+
+class PlayheadTimer : public wxTimer {
+	WaveformDisplay* pane;
+public:
+	PlayheadTimer(WaveformDisplay* pane);
+
+	void Notify();
+};
+
+#define PLAYHEAD_RATE		33
+#define PLAYHEAD_BAR_HEIGHT	4
+
 class WaveformDisplay : public wxPanel {
 private:
 	RenderTimer* timer;
+	PlayheadTimer* playheadTimer;
 
 	std::string path;
 	std::string filename;
 	std::string audioName;
 	audioFile *handle;
-	ByteBuffer buffer;
-
-	int peakl;
-	int peakr;
-	int count;
-
-	std::vector<int> peaksL;
-	std::vector<int> peaksR;
+	PeakBuilder peaks;
 
 	int bytesPerSec;
 	int samplesPerPixel;
+	bool decoded;
+
+	bool selected;
+
+	// Waveform, name and selection border, the playhead is drawn on top
+	wxBitmap cache;
+	bool cacheValid;
+	MemAccount cacheMem;
+
+	unsigned int previewSession;
+	bool skipLeftUp;
+
+	double msPerBar;
+	int playX;
+	int playBar;
+	int barX0;
+	int barX1;
+
+	void Audition(long long frame);
+	void RenderCache(int w, int h);
+	void DrawPlayhead(wxDC& dc, int h);
+	void RefreshPlayhead(bool bar);
+	void SetPlayFrame(long long frame);
 
 public:
 	WaveformDisplay(wxFrame* parent);
 	~WaveformDisplay();
 
-	int read32();
 	void SetSource(std::string _filename, std::string _audioName, bool sfxMode);
 
 	void OnPaint(wxPaintEvent& evt);
 	void OnLeftUp(wxMouseEvent& evt);
+	void OnLeftDClick(wxMouseEvent& evt);
 	void OnRightUp(wxMouseEvent& evt);
 	void OnMenuEvent(wxCommandEvent& evt);
 	void OnEraseBackground(wxEraseEvent& evt);
@@ -68,7 +98,14 @@ public:
 	std::string GetAudioName() { return audioName; }
 	void SetAudioName(std::string name) { audioName = name; }
 
+	bool IsSelected() const { return selected; }
+	void SetSelected(bool value);
+
 	void SetStatusText(wxString status);
+	void UpdatePlayhead();
+
+	bool IsAuditioning() const;
+	void SetPlayTime(double ms, double _msPerBar);
 };
 
 #endif
@@ -0,0 +1,283 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <algorithm>
+
+#include "oamlCore.h"
+
+
+AdaptiveSim::AdaptiveSim(std::string _defsFile, std::string _trackName) {
+	defsFile = _defsFile;
+	fileContext = GetProjectFiles();
+	trackName = _trackName;
+	seconds = 600.0;
+	seed = 1;
+
+	projectBpm = 0;
+	projectBeatsPerBar = 0;
+	worstCaseMs = 0;
+	simulatedSeconds = 0;
+	elapsedSeconds = 0;
+}
+
+int AdaptiveSim::LoadTrackInfo(oamlApi *api, std::string *error) {
+	oamlTracksInfo *info = api->GetTracksInfo();
+	projectBpm = info->bpm;
+	projectBeatsPerBar = info->beatsPerBar;
+
+	for (std::vector<oamlTrackInfo>::iterator track=info->tracks.begin(); track<info->tracks.end(); ++track) {
+		if (track->name != trackName)
+			continue;
+
+		for (std::vector<oamlAudioInfo>::iterator audio=track->audios.begin(); audio<track->audios.end(); ++audio) {
+			simAudioCoverage cov;
+			cov.audioName = audio->name;
+			cov.bpm = audio->bpm;
+			cov.beatsPerBar = audio->beatsPerBar;
+			cov.condId = audio->condId;
+			cov.condType = audio->condType;
+			cov.condValue = audio->condValue;
+			cov.condValue2 = audio->condValue2;
+			cov.plays = 0;
+			cov.seconds = 0;
+			coverage.push_back(cov);
+			audioNames.push_back(cov.audioName);
+		}
+		trackInfo = *track;
+		worstCaseMs = ConditionLatency::WorstCaseMs(*track, projectBpm, projectBeatsPerBar);
+		return 0;
+	}
+
+	if (error) *error = "track not found: " + trackName;
+	return -1;
+}
+
+double AdaptiveSim::BarsFromMs(const std::string& audioName, double ms) {
+	float bpm = projectBpm;
+	int beatsPerBar = projectBeatsPerBar;
+	for (std::vector<simAudioCoverage>::iterator it=coverage.begin(); it<coverage.end(); ++it) {
+		if (it->audioName == audioName) {
+			if (it->bpm > 0) bpm = it->bpm;
+			if (it->beatsPerBar > 0) beatsPerBar = it->beatsPerBar;
+			break;
+		}
+	}
+
+	if (bpm <= 0 || beatsPerBar <= 0)
+		return -1;
+	return ms / (beatsPerBar * 60000.0 / bpm);
+}
+
+int AdaptiveSim::Run(std::string *error) {
+	results.clear();
+	coverage.clear();
+	audioNames.clear();
+	worstCaseMs = 0;
+	simulatedSeconds = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	oamlApi *api = new oamlApi();
+	api->SetFileCallbacks(fileContext->GetCallbacks());
+	if (api->Init(defsFile.c_str()) != OAML_OK) {
+		if (error) *error = "error loading " + defsFile;
+		delete api;
+		return -1;
+	}
+
+	if (LoadTrackInfo(api, error) == -1) {
+		api->Shutdown();
+		delete api;
+		return -1;
+	}
+
+	// oaml picks random audios with rand(), seeding it makes runs repeatable
+	srand(seed);
+
+	api->SetAudioFormat(SIM_SAMPLE_RATE, 2, 2);
+	if (api->PlayTrack(trackName.c_str()) != OAML_OK) {
+		if (error) *error = "error playing track " + trackName;
+		api->Shutdown();
+		delete api;
+		return -1;
+	}
+
+	int16_t block[SIM_BLOCK_FRAMES * 2];
+	long long totalFrames = (long long)(seconds * SIM_SAMPLE_RATE);
+	long long frames = 0;
+	int current = -1;
+	std::vector<int> playing;
+	std::vector<int> wasPlaying;
+	std::vector<size_t> pending;
+
+	timeline.Rewind();
+	while (frames < totalFrames) {
+		double time = (double)frames / SIM_SAMPLE_RATE;
+
+		condEvent ev;
+		while (timeline.PopDue(time, ev)) {
+			api->SetCondition(ev.condId, ev.condValue);
+
+			// A new value for the same condition replaces one that hasn't switched yet
+			for (size_t i=0; i<pending.size(); ) {
+				if (results[pending[i]].event.condId == ev.condId) {
+					pending.erase(pending.begin() + i);
+				} else {
+					i++;
+				}
+			}
+			pending.push_back(results.size());
+
+			simEventResult result;
+			result.event = ev;
+			result.audioBefore = current >= 0 ? coverage[current].audioName : "";
+			result.latencyMs = -1;
+			result.latencyBars = -1;
+			results.push_back(result);
+		}
+
+		memset(block, 0, sizeof(block));
+		api->MixToBuffer(block, SIM_BLOCK_FRAMES * 2);
+		api->Update();
+		frames+= SIM_BLOCK_FRAMES;
+		time = (double)frames / SIM_SAMPLE_RATE;
+
+		// Longest name first, the same one PlaybackFindAudio picks
+		PlaybackFindAudios(api->GetPlayingInfo(), audioNames, playing);
+		int audio = playing.empty() ? -1 : playing[0];
+		if (audio != current) {
+			if (audio >= 0) {
+				coverage[audio].plays++;
+			}
+			current = audio;
+		}
+
+		// An event is settled by the first audio to start that its
+		// condition selects, even while the previous one fades out.
+		// Events nothing answers are reported as no switch.
+		for (std::vector<int>::iterator it=playing.begin(); it<playing.end() && pending.empty() == false; ++it) {
+			if (std::find(wasPlaying.begin(), wasPlaying.end(), *it) != wasPlaying.end())
+				continue;
+
+			const std::string& name = coverage[*it].audioName;
+			for (size_t i=0; i<pending.size(); ) {
+				simEventResult& result = results[pending[i]];
+				if (ConditionLatency::IsConditionSwitch(trackInfo, result.audioBefore, name, result.event.condId, result.event.condValue) == false) {
+					i++;
+					continue;
+				}
+
+				result.audioAfter = name;
+				result.latencyMs = (time - result.event.time) * 1000.0;
+				result.latencyBars = BarsFromMs(result.audioBefore, result.latencyMs);
+				pending.erase(pending.begin() + i);
+			}
+		}
+		wasPlaying.swap(playing);
+
+		if (current >= 0) {
+			coverage[current].seconds+= (double)SIM_BLOCK_FRAMES / SIM_SAMPLE_RATE;
+		}
+
+		if (api->IsPlaying() == false)
+			break;
+	}
+
+	simulatedSeconds = (double)frames / SIM_SAMPLE_RATE;
+
+	api->Shutdown();
+	delete api;
+
+	elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return 0;
+}
+
+int AdaptiveSim::GetUncoveredCount() const {
+	int count = 0;
+	for (std::vector<simAudioCoverage>::const_iterator it=coverage.begin(); it<coverage.end(); ++it) {
+		if (it->condId != 0 && it->plays == 0) count++;
+	}
+	return count;
+}
+
+void AdaptiveSim::WriteReport(FILE *f) const {
+	fprintf(f, "track: %s\n", trackName.c_str());
+	fprintf(f, "seed: %u\n", seed);
+	fprintf(f, "simulated: %.1f s in %.2f s (%.0fx)\n", simulatedSeconds, elapsedSeconds, elapsedSeconds > 0 ? simulatedSeconds / elapsedSeconds : 0.0);
+
+	fprintf(f, "\nevents:\n");
+	for (std::vector<simEventResult>::const_iterator it=results.begin(); it<results.end(); ++it) {
+		fprintf(f, "  %8.3f s  cond %d = %d  %s -> ", it->event.time, it->event.condId, it->event.condValue, it->audioBefore.c_str());
+		if (it->latencyMs < 0) {
+			fprintf(f, "(no switch)\n");
+		} else if (it->latencyBars < 0) {
+			fprintf(f, "%s  %.1f ms\n", it->audioAfter.c_str(), it->latencyMs);
+		} else {
+			fprintf(f, "%s  %.1f ms  %.2f bars\n", it->audioAfter.c_str(), it->latencyMs, it->latencyBars);
+		}
+	}
+
+	fprintf(f, "\nconditional loops:\n");
+	for (std::vector<simAudioCoverage>::const_iterator it=coverage.begin(); it<coverage.end(); ++it) {
+		if (it->condId == 0)
+			continue;
+
+		fprintf(f, "  %-24s cond %d type %d value %d/%d  plays %d  %.1f s%s\n", it->audioName.c_str(), it->condId, it->condType, it->condValue, it->condValue2, it->plays, it->seconds, it->plays == 0 ? "  NOT COVERED" : "");
+	}
+
+	fprintf(f, "\nworst case latency: %.1f ms\n", worstCaseMs);
+	fprintf(f, "uncovered: %d\n", GetUncoveredCount());
+}
+
+void AdaptiveSim::WriteJson(FILE *f) const {
+	fprintf(f, "{\n  \"track\": ");
+	CliJsonString(f, trackName);
+	fprintf(f, ",\n  \"seed\": %u,\n  \"simulatedSeconds\": %.3f,\n  \"elapsedSeconds\": %.3f,\n  \"worstCaseMs\": %.3f,\n", seed, simulatedSeconds, elapsedSeconds, worstCaseMs);
+
+	fprintf(f, "  \"events\": [");
+	for (size_t i=0; i<results.size(); i++) {
+		const simEventResult& r = results[i];
+		fprintf(f, "%s\n    {\"time\": %.3f, \"condId\": %d, \"condValue\": %d, \"before\": ", i ? "," : "", r.event.time, r.event.condId, r.event.condValue);
+		CliJsonString(f, r.audioBefore);
+		fprintf(f, ", \"after\": ");
+		CliJsonString(f, r.audioAfter);
+		fprintf(f, ", \"latencyMs\": %.3f, \"latencyBars\": %.3f}", r.latencyMs, r.latencyBars);
+	}
+	fprintf(f, "\n  ],\n");
+
+	fprintf(f, "  \"coverage\": [");
+	bool first = true;
+	for (std::vector<simAudioCoverage>::const_iterator it=coverage.begin(); it<coverage.end(); ++it) {
+		if (it->condId == 0)
+			continue;
+
+		fprintf(f, "%s\n    {\"audio\": ", first ? "" : ",");
+		CliJsonString(f, it->audioName);
+		fprintf(f, ", \"condId\": %d, \"condType\": %d, \"condValue\": %d, \"condValue2\": %d, \"plays\": %d, \"seconds\": %.3f}", it->condId, it->condType, it->condValue, it->condValue2, it->plays, it->seconds);
+		first = false;
+	}
+	fprintf(f, "\n  ],\n  \"uncovered\": %d\n}\n", GetUncoveredCount());
+}
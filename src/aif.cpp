@@ -23,9 +23,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <math.h>
 
-#include "oamlCommon.h"
+#include "oamlCore.h"
 
 
 #define	SWAP16(x) ((((x) & 0xff) << 8) | (((x) & 0xff00) >> 8))
@@ -83,6 +84,9 @@ aifFile::aifFile(oamlFileCallbacks *cbs) : audioFile(cbs) {
 
 	chunkSize = 0;
 	status = 0;
+
+	dataOffset = 0;
+	dataSize = 0;
 }
 
 aifFile::~aifFile() {
@@ -242,8 +246,14 @@ int aifFile::ReadChunk() {
 				fcbs->seek(fd, SWAP32(ssnd.offset), SEEK_CUR);
 			}
 
-			chunkSize = SWAP32(header.size) - 8;
-			totalSamples = chunkSize / (bitsPerSample/8);
+			dataOffset = fcbs->tell(fd);
+			dataSize = ClampToFile((int64_t)SWAP32(header.size) - 8 - SWAP32(ssnd.offset));
+			chunkSize = dataSize;
+			if (bitsPerSample < 8 || dataSize / (bitsPerSample/8) > INT_MAX) {
+				fprintf(stderr, "aif: Unsupported data size\n");
+				return -1;
+			}
+			totalSamples = (int)(dataSize / (bitsPerSample/8));
 			status = 2;
 			break;
 
@@ -259,12 +269,21 @@ int aifFile::Read(char *buffer, int size) {
 	if (fd == NULL)
 		return -1;
 
+	// Whatever follows the ssnd chunk isn't audio
+	if (status == 3)
+		return 0;
+
 	int bytesRead = 0;
 	while (size > 0) {
 		// Are we inside a ssnd chunk?
 		if (status == 2) {
+			if (chunkSize <= 0) {
+				status = 3;
+				break;
+			}
+
 			// Let's keep reading data!
-			int ret = fcbs->read(buffer, 1, size, fd);
+			int ret = fcbs->read(buffer, 1, size < chunkSize ? size : (int)chunkSize, fd);
 			if (ret == 0) {
 				status = 3;
 				break;
@@ -298,6 +317,7 @@ int aifFile::Read(char *buffer, int size) {
 					}
 				}
 
+				buffer+= ret;
 				bytesRead+= ret;
 				size-= ret;
 			}
@@ -310,6 +330,25 @@ int aifFile::Read(char *buffer, int size) {
 	return bytesRead;
 }
 
+int aifFile::SeekFrame(int64_t frame) {
+	if (fd == NULL || status < 2)
+		return -1;
+
+	int frameBytes = GetFrameBytes();
+	if (frame < 0 || frameBytes <= 0 || frame * frameBytes > dataSize)
+		return -1;
+
+	// Samples are fixed size, the frame is right where the arithmetic says.
+	// The file callbacks take a long, which may not reach that far.
+	int64_t pos = dataOffset + frame * frameBytes;
+	if (pos > LONG_MAX || fcbs->seek(fd, (long)pos, SEEK_SET) != 0)
+		return -1;
+
+	chunkSize = dataSize - frame * frameBytes;
+	status = 2;
+	return 0;
+}
+
 void aifFile::WriteToFile(const char *, ByteBuffer *, int, unsigned int, int) {
 }
 
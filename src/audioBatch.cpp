@@ -0,0 +1,145 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include "oamlCore.h"
+
+
+bool AudioSelectionLess(const audioSelection& a, const audioSelection& b) {
+	if (a.audioName != b.audioName)
+		return a.audioName < b.audioName;
+	return a.filename < b.filename;
+}
+
+static bool SelectionSameAudio(const audioSelection& a, const audioSelection& b) {
+	return a.audioName == b.audioName;
+}
+
+static bool SelectionSameFile(const audioSelection& a, const audioSelection& b) {
+	return a.audioName == b.audioName && a.filename == b.filename;
+}
+
+float AudioGetProperty(oamlStudioApi *api, std::string trackName, const audioSelection& sel, int prop) {
+	const std::string& audioName = sel.audioName;
+
+	switch (prop) {
+		case AUDIO_PROP_VOLUME: return api->AudioGetVolume(trackName, audioName);
+		case AUDIO_PROP_BPM: return api->AudioGetBPM(trackName, audioName);
+		case AUDIO_PROP_BEATS_PER_BAR: return (float)api->AudioGetBeatsPerBar(trackName, audioName);
+		case AUDIO_PROP_BARS: return (float)api->AudioGetBars(trackName, audioName);
+		case AUDIO_PROP_RANDOM_CHANCE: return (float)api->AudioGetRandomChance(trackName, audioName);
+		case AUDIO_PROP_MIN_MOVEMENT_BARS: return (float)api->AudioGetMinMovementBars(trackName, audioName);
+		case AUDIO_PROP_FADE_IN: return (float)api->AudioGetFadeIn(trackName, audioName);
+		case AUDIO_PROP_FADE_OUT: return (float)api->AudioGetFadeOut(trackName, audioName);
+		case AUDIO_PROP_XFADE_IN: return (float)api->AudioGetXFadeIn(trackName, audioName);
+		case AUDIO_PROP_XFADE_OUT: return (float)api->AudioGetXFadeOut(trackName, audioName);
+		case AUDIO_PROP_COND_ID: return (float)api->AudioGetCondId(trackName, audioName);
+		case AUDIO_PROP_COND_TYPE: return (float)api->AudioGetCondType(trackName, audioName);
+		case AUDIO_PROP_COND_VALUE: return (float)api->AudioGetCondValue(trackName, audioName);
+		case AUDIO_PROP_COND_VALUE2: return (float)api->AudioGetCondValue2(trackName, audioName);
+		case AUDIO_PROP_FILE_RANDOM_CHANCE: return (float)api->AudioFileGetRandomChance(trackName, audioName, sel.filename);
+	}
+
+	return 0.f;
+}
+
+bool AudioSetProperty(oamlStudioApi *api, std::string trackName, const audioSelection& sel, int prop, float value) {
+	const std::string& audioName = sel.audioName;
+
+	// Everything but volume and bpm is stored as an integer by oaml
+	if (prop != AUDIO_PROP_VOLUME && prop != AUDIO_PROP_BPM) {
+		value = (float)(int)value;
+	}
+
+	// Don't change the actual value unless it's different
+	if (AudioGetProperty(api, trackName, sel, prop) == value)
+		return false;
+
+	// Send the actual change to oaml through the studioApi
+	switch (prop) {
+		case AUDIO_PROP_VOLUME: api->AudioSetVolume(trackName, audioName, value); break;
+		case AUDIO_PROP_BPM: api->AudioSetBPM(trackName, audioName, value); break;
+		case AUDIO_PROP_BEATS_PER_BAR: api->AudioSetBeatsPerBar(trackName, audioName, (int)value); break;
+		case AUDIO_PROP_BARS: api->AudioSetBars(trackName, audioName, (int)value); break;
+		case AUDIO_PROP_RANDOM_CHANCE: api->AudioSetRandomChance(trackName, audioName, (int)value); break;
+		case AUDIO_PROP_MIN_MOVEMENT_BARS: api->AudioSetMinMovementBars(trackName, audioName, (int)value); break;
+		case AUDIO_PROP_FADE_IN: api->AudioSetFadeIn(trackName, audioName, (int)value); break;
+		case AUDIO_PROP_FADE_OUT: api->AudioSetFadeOut(trackName, audioName, (int)value); break;
+		case AUDIO_PROP_XFADE_IN: api->AudioSetXFadeIn(trackName, audioName, (int)value); break;
+		case AUDIO_PROP_XFADE_OUT: api->AudioSetXFadeOut(trackName, audioName, (int)value); break;
+		case AUDIO_PROP_COND_ID: api->AudioSetCondId(trackName, audioName, (int)value); break;
+		case AUDIO_PROP_COND_TYPE: api->AudioSetCondType(trackName, audioName, (int)value); break;
+		case AUDIO_PROP_COND_VALUE: api->AudioSetCondValue(trackName, audioName, (int)value); break;
+		case AUDIO_PROP_COND_VALUE2: api->AudioSetCondValue2(trackName, audioName, (int)value); break;
+		case AUDIO_PROP_FILE_RANDOM_CHANCE: api->AudioFileSetRandomChance(trackName, audioName, sel.filename, (int)value); break;
+		default: return false;
+	}
+
+	return true;
+}
+
+
+AudioBatchEdit::AudioBatchEdit(oamlStudioApi *_api, std::string _trackName, const std::vector<audioSelection>& selection) {
+	api = _api;
+	trackName = _trackName;
+	changes = 0;
+
+	// Audio properties are applied once per audio and file properties once
+	// per file, no matter how many times they appear in the selection
+	files = selection;
+	std::sort(files.begin(), files.end(), AudioSelectionLess);
+	files.erase(std::unique(files.begin(), files.end(), SelectionSameFile), files.end());
+
+	audios = files;
+	audios.erase(std::unique(audios.begin(), audios.end(), SelectionSameAudio), audios.end());
+}
+
+int AudioBatchEdit::SetProperty(int prop, float value) {
+	std::vector<audioSelection>& list = prop == AUDIO_PROP_FILE_RANDOM_CHANCE ? files : audios;
+
+	int count = 0;
+	for (std::vector<audioSelection>::iterator it=list.begin(); it<list.end(); ++it) {
+		if (AudioSetProperty(api, trackName, *it, prop, value)) {
+			count++;
+		}
+	}
+
+	changes+= count;
+	return count;
+}
+
+int AudioBatchEdit::SetLayer(std::string layer) {
+	int count = 0;
+	for (std::vector<audioSelection>::iterator it=files.begin(); it<files.end(); ++it) {
+		if (api->AudioFileGetLayer(trackName, it->audioName, it->filename) != layer) {
+			api->AudioFileSetLayer(trackName, it->audioName, it->filename, layer);
+			count++;
+		}
+	}
+
+	changes+= count;
+	return count;
+}
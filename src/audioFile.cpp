@@ -27,12 +27,61 @@
 #include "vorbis/codec.h"
 #include "vorbis/vorbisfile.h"
 
-#include "oamlCommon.h"
+#include "oamlCore.h"
 
 
 audioFile::audioFile(oamlFileCallbacks *cbs) {
 	fcbs = cbs;
+	MemAddObjects(MEM_DECODERS, "audioFile", 1);
 }
 
 audioFile::~audioFile() {
+	MemAddObjects(MEM_DECODERS, "audioFile", -1);
+}
+
+// Streamed and truncated files claim more data than there is
+int64_t audioFile::ClampToFile(int64_t size) {
+	long pos = fcbs->tell(fd);
+	fcbs->seek(fd, 0, SEEK_END);
+	long end = fcbs->tell(fd);
+	fcbs->seek(fd, pos, SEEK_SET);
+
+	if ((int64_t)end - pos < size)
+		return (int64_t)end - pos;
+	return size;
+}
+
+int audioFile::ReadFramesAt(int64_t frame, char *buffer, int frames) {
+	int frameBytes = GetFrameBytes();
+	if (frameBytes <= 0 || frames < 0)
+		return -1;
+
+	if (SeekFrame(frame) == -1)
+		return -1;
+
+	// Read returns less than asked for at packet and chunk boundaries
+	int size = frames * frameBytes;
+	int bytesRead = 0;
+	while (bytesRead < size) {
+		int ret = Read(buffer + bytesRead, size - bytesRead);
+		if (ret <= 0)
+			break;
+
+		bytesRead+= ret;
+	}
+
+	return bytesRead / frameBytes;
+}
+
+audioFile* CreateAudioFile(std::string filename, oamlFileCallbacks *cbs) {
+	std::string ext = filename.substr(filename.find_last_of(".") + 1);
+	if (ext == "ogg") {
+		return (audioFile*)new oggFile(cbs);
+	} else if (ext == "aif" || ext == "aiff") {
+		return (audioFile*)new aifFile(cbs);
+	} else if (ext == "wav" || ext == "wave") {
+		return new wavFile(cbs);
+	}
+
+	return NULL;
 }
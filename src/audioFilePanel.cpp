@@ -23,6 +23,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 
 #include "oamlCommon.h"
 
@@ -58,10 +59,7 @@ AudioFilePanel::AudioFilePanel(std::string _trackName, std::string _audioName, b
 }
 
 void AudioFilePanel::UpdateLayout() {
-	Layout();
-
-	wxCommandEvent event(EVENT_UPDATE_LAYOUT);
-	wxPostEvent(GetParent(), event);
+	eventBus->PostLayout();
 }
 
 void AudioFilePanel::AddWaveform(std::string filename) {
@@ -85,8 +83,8 @@ void AudioFilePanel::RemoveWaveform(std::string filename) {
 			studioApi->AudioFileRemove(trackName, audioName, filename);
 
 			// Mark the project dirty
-			wxCommandEvent event(EVENT_SET_PROJECT_DIRTY);
-			wxPostEvent(GetParent(), event);
+			eventBus->PostDirty();
+			break;
 		}
 	}
 
@@ -94,11 +92,10 @@ void AudioFilePanel::RemoveWaveform(std::string filename) {
 		// No waveform left on the panel, remove us
 		studioApi->AudioRemove(trackName, audioName);
 
-		wxCommandEvent event(EVENT_SELECT_AUDIO);
-		event.SetString(wxString(""));
-		wxPostEvent(GetParent(), event);
+		eventBus->PostSelectAudio("", "", false);
 
-		Destroy();
+		// The audio panel keeps track of us, let it destroy us
+		((AudioPanel*)GetParent())->RemoveFilePanel(this);
 		return;
 	}
 
@@ -114,6 +111,32 @@ void AudioFilePanel::UpdateAudioName(std::string oldName, std::string newName) {
 	}
 }
 
+void AudioFilePanel::UpdateSelection(const std::vector<audioSelection>& sorted) {
+	for (std::vector<WaveformDisplay*>::iterator it=waveDisplays.begin(); it<waveDisplays.end(); ++it) {
+		WaveformDisplay *waveDisplay = *it;
+		audioSelection sel = { waveDisplay->GetAudioName(), waveDisplay->GetFilename() };
+		waveDisplay->SetSelected(std::binary_search(sorted.begin(), sorted.end(), sel, AudioSelectionLess));
+	}
+}
+
+void AudioFilePanel::SetPlayTime(std::string playingAudio, double ms) {
+	double msPerBar = 0;
+	if (playingAudio == audioName) {
+		float bpm = studioApi->AudioGetBPM(trackName, audioName);
+		int beatsPerBar = studioApi->AudioGetBeatsPerBar(trackName, audioName);
+		if (bpm > 0 && beatsPerBar > 0) {
+			msPerBar = beatsPerBar * 60000.0 / bpm;
+		}
+	} else {
+		ms = -1;
+	}
+
+	// Every layer of the audio plays at once
+	for (std::vector<WaveformDisplay*>::iterator it=waveDisplays.begin(); it<waveDisplays.end(); ++it) {
+		(*it)->SetPlayTime(ms, msPerBar);
+	}
+}
+
 bool AudioFilePanel::IsEmpty() {
 	return waveDisplays.size() == 0;
 }
@@ -142,8 +165,7 @@ void AudioFilePanel::AddAudioFilePath(wxString path) {
 	AddWaveform(fname);
 
 	// Mark the project dirty
-	wxCommandEvent event2(EVENT_SET_PROJECT_DIRTY);
-	wxPostEvent(GetParent(), event2);
+	eventBus->PostDirty();
 }
 
 void AudioFilePanel::AddAudioFileDialog() {
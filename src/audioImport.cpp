@@ -0,0 +1,202 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+#include "oamlCommon.h"
+
+
+AudioNameAllocator::AudioNameAllocator(const std::vector<std::string>& existing) : taken(existing.begin(), existing.end()) {
+	next = 0;
+}
+
+std::string AudioNameAllocator::Next() {
+	char str[64];
+
+	// next only moves forward, so a whole batch costs one pass over the used names
+	for (;;) {
+		snprintf(str, 64, "audio%d", next++);
+		if (taken.insert(str).second)
+			break;
+	}
+
+	return str;
+}
+
+
+AudioImport::AudioImport(oamlStudioApi *_api, std::string _trackName, bool _sfxMode) : probed(0), cancelled(false) {
+	api = _api;
+	trackName = _trackName;
+	sfxMode = _sfxMode;
+	sink = NULL;
+
+	// Workers share the project context, it stays the same while they run
+	fileContext = GetProjectFiles();
+}
+
+AudioImport::~AudioImport() {
+	Cancel();
+	Join();
+}
+
+void AudioImport::AddFile(std::string filename) {
+	audioImportFile file;
+	file.filename = filename;
+	file.ok = false;
+	files.push_back(file);
+}
+
+void AudioImport::ProbeFile(audioImportFile& file) {
+	TRACE_SCOPE("AudioImport::ProbeFile");
+	audioFile *handle = CreateAudioFile(file.filename, fileContext->GetCallbacks());
+	if (handle == NULL)
+		return;
+
+	if (handle->Open(file.filename.c_str()) == 0 && handle->GetTotalSamples() > 0) {
+		int samplesPerPixel = PeakBuilder::GetSamplesPerPixel(handle, sfxMode, NULL);
+
+		if (peakCache.Has(file.filename, samplesPerPixel) == false) {
+			PeakBuilder peaks;
+			peaks.Reset(handle->GetFormat(), handle->GetBytesPerSample(), samplesPerPixel);
+			while (peaks.Decode(handle, 65536) == false) {
+			}
+
+			peakCache.Put(file.filename, samplesPerPixel, peaks.GetPeaksL(), peaks.GetPeaksR());
+		}
+
+		file.ok = true;
+	}
+
+	delete handle;
+}
+
+void AudioImport::ProbeWorker(std::atomic<int> *index) {
+	TraceSetThreadName("audio import");
+	for (;;) {
+		if (cancelled)
+			break;
+
+		int n = (*index)++;
+		if (n >= (int)files.size())
+			break;
+
+		ProbeFile(files[n]);
+
+		int done = ++probed;
+		if (sink && (done % IMPORT_PROGRESS_STEP) == 0) {
+			Post(done, false);
+		}
+	}
+}
+
+void AudioImport::Probe(int threads) {
+	if (threads <= 0) {
+		threads = (int)std::thread::hardware_concurrency();
+		if (threads <= 0) threads = 1;
+	}
+	if (threads > (int)files.size()) {
+		threads = (int)files.size();
+	}
+
+	// Workers pick the next file until there's none left
+	std::atomic<int> index(0);
+	std::vector<std::thread> workers;
+	for (int i=0; i<threads; i++) {
+		workers.push_back(std::thread(&AudioImport::ProbeWorker, this, &index));
+	}
+
+	for (std::vector<std::thread>::iterator it=workers.begin(); it<workers.end(); ++it) {
+		it->join();
+	}
+}
+
+void AudioImport::Post(int done, bool finished) {
+	importProgress progress;
+	progress.done = done;
+	progress.total = (int)files.size();
+	progress.finished = finished;
+
+	wxThreadEvent event(EVENT_IMPORT_PROGRESS);
+	event.SetPayload(progress);
+	wxQueueEvent(sink, event.Clone());
+}
+
+void AudioImport::Run(int threads) {
+	TraceSetThreadName("audio import");
+	TRACE_SCOPE("AudioImport::Run");
+	Probe(threads);
+
+	if (cancelled == false) {
+		Post(probed, true);
+	}
+}
+
+void AudioImport::Start(wxEvtHandler *_sink, int threads) {
+	Join();
+
+	sink = _sink;
+	probed = 0;
+	cancelled = false;
+	thread = std::thread(&AudioImport::Run, this, threads);
+}
+
+void AudioImport::Cancel() {
+	cancelled = true;
+}
+
+void AudioImport::Join() {
+	if (thread.joinable()) {
+		thread.join();
+	}
+}
+
+int AudioImport::Commit(int type) {
+	std::vector<std::string> list;
+	api->TrackGetAudioList(trackName, list);
+
+	AudioNameAllocator names(list);
+
+	int count = 0;
+	for (std::vector<audioImportFile>::iterator it=files.begin(); it<files.end(); ++it) {
+		if (it->ok == false)
+			continue;
+
+		it->audioName = names.Next();
+
+		api->AudioNew(trackName, it->audioName, type);
+		api->AudioAddAudioFile(trackName, it->audioName, it->filename);
+		count++;
+	}
+
+	return count;
+}
+
+int AudioImport::GetFailedCount() const {
+	int count = 0;
+	for (std::vector<audioImportFile>::const_iterator it=files.begin(); it<files.end(); ++it) {
+		if (it->ok == false) count++;
+	}
+	return count;
+}
@@ -41,12 +41,16 @@
 #include <wx/filename.h>
 #include <wx/filehistory.h>
 #include <wx/config.h>
+#include <wx/dir.h>
+#include <wx/dirdlg.h>
 
 
 AudioPanel::AudioPanel(wxFrame* parent, int index, std::string name, wxString labelStr, bool mode) : wxPanel(parent) {
 	panelIndex = index;
 	trackName = name;
 	sfxMode = mode;
+	import = NULL;
+	importType = 0;
 
 	vSizer = new wxBoxSizer(wxVERTICAL);
 	wxStaticText *staticText = new wxStaticText(this, wxID_ANY, labelStr, wxDefaultPosition, wxDefaultSize, wxALIGN_CENTRE_HORIZONTAL);
@@ -61,10 +65,19 @@ AudioPanel::AudioPanel(wxFrame* parent, int index, std::string name, wxString la
 	Bind(wxEVT_PAINT, &AudioPanel::OnPaint, this);
 	Bind(wxEVT_RIGHT_UP, &AudioPanel::OnRightUp, this);
 	Bind(wxEVT_COMMAND_MENU_SELECTED, &AudioPanel::OnMenuEvent, this);
+	Bind(EVENT_IMPORT_PROGRESS, &AudioPanel::OnImportProgress, this);
 
 //	SetMinSize(wxSize(240, -1));
 }
 
+AudioPanel::~AudioPanel() {
+	// An import still probing is dropped, nothing was added to the track yet
+	if (import) {
+		delete import;
+		import = NULL;
+	}
+}
+
 void AudioPanel::OnPaint(wxPaintEvent& WXUNUSED(evt)) {
 	wxPaintDC dc(this);
 
@@ -90,38 +103,50 @@ void AudioPanel::AddAudio(std::string audioName) {
 	}
 
 	sizer->Add(afp, 0, wxALL, 5);
-	Layout();
-
-	wxCommandEvent event(EVENT_UPDATE_LAYOUT);
-	wxPostEvent(GetParent(), event);
+	eventBus->PostLayout();
 }
 
 void AudioPanel::RemoveAudio(std::string filename) {
-	for (std::vector<AudioFilePanel*>::iterator it=filePanels.begin(); it<filePanels.end(); ++it) {
+	// Panels left empty remove themselves through RemoveFilePanel
+	std::vector<AudioFilePanel*> list = filePanels;
+	for (std::vector<AudioFilePanel*>::iterator it=list.begin(); it<list.end(); ++it) {
 		AudioFilePanel *afp = *it;
 		afp->RemoveWaveform(filename);
-		if (afp->IsEmpty()) {
+	}
+
+	eventBus->PostLayout();
+
+	// Mark the project dirty
+	eventBus->PostDirty();
+}
+
+void AudioPanel::RemoveFilePanel(AudioFilePanel *afp) {
+	for (std::vector<AudioFilePanel*>::iterator it=filePanels.begin(); it<filePanels.end(); ++it) {
+		if (*it == afp) {
 			sizer->Detach((wxWindow*)afp);
 			filePanels.erase(it);
-			delete afp;
-
-			studioApi->AudioRemove(trackName, filename);
 			break;
 		}
 	}
 
-	Layout();
-
-	// Mark the project dirty
-	wxCommandEvent event(EVENT_SET_PROJECT_DIRTY);
-	wxPostEvent(GetParent(), event);
+	afp->Destroy();
+	eventBus->PostLayout();
 }
 
 void AudioPanel::AddAudioPath(wxString path) {
-	wxFileName filename(path);
+	wxArrayString paths;
+	paths.Add(path);
+	AddAudioPaths(paths);
+}
+
+void AudioPanel::AddAudioPaths(const wxArrayString& paths) {
+	if (paths.GetCount() == 0)
+		return;
 
-	filename.MakeRelativeTo(wxString(projectPath));
-	std::string fname = filename.GetFullPath().ToStdString();
+	if (import) {
+		wxMessageBox(_("Please wait until the files being imported are ready"));
+		return;
+	}
 
 	int type = 2;
 	switch (panelIndex) {
@@ -130,24 +155,59 @@ void AudioPanel::AddAudioPath(wxString path) {
 		case 2: type = 4; break;
 	}
 
-	std::string name;
-	for (int i=0; i<1000; i++) {
-		char str[1024];
-		snprintf(str, 1024, "audio%d", i);
-		name = str;
-		if (studioApi->AudioExists(trackName, name) == false) {
-			break;
+	import = new AudioImport(studioApi, trackName, sfxMode);
+	importType = type;
+	for (size_t i=0; i<paths.GetCount(); i++) {
+		wxFileName filename(paths.Item(i));
+
+		filename.MakeRelativeTo(wxString(projectPath));
+		import->AddFile(filename.GetFullPath().ToStdString());
+	}
+
+	// Read the headers and the waveform peaks of every file in parallel, the
+	// waveform displays will find the peaks in the cache
+	eventBus->PostStatusText(wxString::Format(_("Importing audio files 0/%d"), (int)paths.GetCount()));
+	import->Start(this);
+}
+
+void AudioPanel::OnImportProgress(wxThreadEvent& event) {
+	TRACE_SCOPE("AudioPanel::OnImportProgress");
+	importProgress progress = event.GetPayload<importProgress>();
+	if (import == NULL)
+		return;
+
+	if (progress.finished == false) {
+		eventBus->PostStatusText(wxString::Format(_("Importing audio files %d/%d"), progress.done, progress.total));
+		return;
+	}
+
+	// oaml is only touched from here, on the UI thread
+	import->Join();
+	import->Commit(importType);
+
+	Freeze();
+	std::vector<audioImportFile>& files = import->GetFiles();
+	for (std::vector<audioImportFile>::iterator it=files.begin(); it<files.end(); ++it) {
+		if (it->ok) {
+			AddAudio(it->audioName);
 		}
 	}
+	Thaw();
 
-	studioApi->AudioNew(trackName, name, type);
-	studioApi->AudioAddAudioFile(trackName, name, fname);
+	int failed = import->GetFailedCount();
+	int total = (int)files.size();
+	delete import;
+	import = NULL;
 
-	AddAudio(name);
+	eventBus->PostStatusText(_("Ready"));
+	if (failed > 0) {
+		wxMessageBox(wxString::Format(_("%d of %d files couldn't be imported"), failed, total));
+	}
 
-	// Mark the project dirty
-	wxCommandEvent event2(EVENT_SET_PROJECT_DIRTY);
-	wxPostEvent(GetParent(), event2);
+	if (failed < total) {
+		// Mark the project dirty
+		eventBus->PostDirty();
+	}
 }
 
 void AudioPanel::AddAudioDialog() {
@@ -157,9 +217,33 @@ void AudioPanel::AddAudioDialog() {
 
 	wxArrayString paths;
 	openFileDialog.GetPaths(paths);
-	for (size_t i=0; i<paths.GetCount(); i++) {
-		AddAudioPath(paths.Item(i));
+	AddAudioPaths(paths);
+}
+
+void AudioPanel::AddAudioDirDialog() {
+	wxDirDialog openDirDialog(this, _("Open audio directory"), wxString(projectPath), wxDD_DEFAULT_STYLE|wxDD_DIR_MUST_EXIST);
+	if (openDirDialog.ShowModal() == wxID_CANCEL)
+		return;
+
+	wxArrayString files;
+	wxDir::GetAllFiles(openDirDialog.GetPath(), &files, wxEmptyString, wxDIR_FILES|wxDIR_DIRS);
+
+	wxArrayString paths;
+	for (size_t i=0; i<files.GetCount(); i++) {
+		wxString ext = wxFileName(files.Item(i)).GetExt().Lower();
+		if (ext == "wav" || ext == "wave" || ext == "aif" || ext == "aiff" || ext == "ogg") {
+			paths.Add(files.Item(i));
+		}
 	}
+
+	if (paths.GetCount() == 0) {
+		wxMessageBox(_("No audio files found in the directory"));
+		return;
+	}
+
+	// Keep the audio names in the same order as the files
+	paths.Sort();
+	AddAudioPaths(paths);
 }
 
 void AudioPanel::OnMenuEvent(wxCommandEvent& event) {
@@ -167,17 +251,25 @@ void AudioPanel::OnMenuEvent(wxCommandEvent& event) {
 		case ID_AddAudio:
 			AddAudioDialog();
 			break;
+
+		case ID_AddAudioDir:
+			AddAudioDirDialog();
+			break;
 	}
 }
 
 void AudioPanel::OnRightUp(wxMouseEvent& WXUNUSED(event)) {
 	wxMenu menu(wxT(""));
 	menu.Append(ID_AddAudio, wxT("&Add Audio"));
+	menu.Append(ID_AddAudioDir, wxT("Add Audio &Directory"));
 	PopupMenu(&menu);
 }
 
 void AudioPanel::UpdateTrackName(std::string newName) {
 	trackName = newName;
+	if (import) {
+		import->SetTrackName(newName);
+	}
 }
 
 void AudioPanel::UpdateAudioName(std::string oldName, std::string newName) {
@@ -187,3 +279,25 @@ void AudioPanel::UpdateAudioName(std::string oldName, std::string newName) {
 	}
 }
 
+void AudioPanel::UpdateSelection(const std::vector<audioSelection>& sorted) {
+	for (std::vector<AudioFilePanel*>::iterator it=filePanels.begin(); it<filePanels.end(); ++it) {
+		AudioFilePanel *afp = *it;
+		afp->UpdateSelection(sorted);
+	}
+}
+
+void AudioPanel::SetPlayTime(std::string playingAudio, double ms) {
+	for (std::vector<AudioFilePanel*>::iterator it=filePanels.begin(); it<filePanels.end(); ++it) {
+		AudioFilePanel *afp = *it;
+		afp->SetPlayTime(playingAudio, ms);
+	}
+}
+
+void AudioPanel::UpdateLayout() {
+	for (std::vector<AudioFilePanel*>::iterator it=filePanels.begin(); it<filePanels.end(); ++it) {
+		AudioFilePanel *afp = *it;
+		afp->Layout();
+	}
+
+	Layout();
+}
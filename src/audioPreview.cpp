@@ -0,0 +1,402 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "oamlCommon.h"
+
+
+static float ReadSample(int format, const uint8_t *ptr) {
+	switch (format) {
+		case AF_FORMAT_SINT8:
+			// Both readers hand out 8 bit samples unsigned, 0x80 is silence
+			return ((int)ptr[0] - 128) / 128.f;
+
+		case AF_FORMAT_SINT16:
+			{ int16_t value;
+			memcpy(&value, ptr, sizeof(value));
+			return value / 32768.f;
+			}
+
+		case AF_FORMAT_SINT24:
+			{ int32_t value = (int32_t)(((uint32_t)ptr[0]<<8) | ((uint32_t)ptr[1]<<16) | ((uint32_t)ptr[2]<<24));
+			return value / 2147483648.f;
+			}
+
+		case AF_FORMAT_SINT32:
+			{ int32_t value;
+			memcpy(&value, ptr, sizeof(value));
+			return value / 2147483648.f;
+			}
+
+		case AF_FORMAT_FLOAT32:
+			{ float value;
+			memcpy(&value, ptr, sizeof(value));
+			return value;
+			}
+	}
+
+	return 0.f;
+}
+
+static inline int16_t ToInt16(float value) {
+	int sample = (int)(value * 32767.f);
+	if (sample > 32767) return 32767;
+	if (sample < -32768) return -32768;
+	return (int16_t)sample;
+}
+
+static inline int16_t Clip16(int value) {
+	if (value > 32767) return 32767;
+	if (value < -32768) return -32768;
+	return (int16_t)value;
+}
+
+
+AudioPreview::AudioPreview() : generation(0), session(0), endedGeneration(0), playFrame(0), underruns(0), mem(MEM_PCM) {
+	outputRate = 44100;
+
+	memset(&current, 0, sizeof(current));
+	currentOffset = 0;
+	primedGeneration = 0;
+
+	workerStarted = false;
+	quit = false;
+	requestFrame = 0;
+	requestGeneration = 0;
+
+	handle = NULL;
+	decodeGeneration = 0;
+	srcStart = 0;
+	srcFrames = 0;
+	srcEof = false;
+	readPos = 0;
+	step = 1.0;
+
+	UpdateMemory();
+}
+
+AudioPreview::~AudioPreview() {
+	if (workerStarted) {
+		std::unique_lock<std::mutex> lock(mutex);
+		quit = true;
+		lock.unlock();
+
+		cond.notify_one();
+		worker.join();
+	}
+
+	CloseSource();
+}
+
+unsigned int AudioPreview::Play(std::string filename, long long frame) {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if (workerStarted == false) {
+		worker = std::thread(&AudioPreview::Worker, this);
+		workerStarted = true;
+	}
+
+	unsigned int s = session.fetch_add(1) + 1;
+	requestFile = filename;
+	requestFrame = frame;
+	requestGeneration = generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+	playFrame = frame;
+	lock.unlock();
+
+	cond.notify_one();
+	return s;
+}
+
+void AudioPreview::Seek(unsigned int _session, long long frame) {
+	std::unique_lock<std::mutex> lock(mutex);
+	if (_session != session || requestFile == "")
+		return;
+
+	requestFrame = frame;
+	requestGeneration = generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+	playFrame = frame;
+	lock.unlock();
+
+	cond.notify_one();
+}
+
+void AudioPreview::Stop() {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	session++;
+	requestFile = "";
+	requestGeneration = generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+	lock.unlock();
+
+	cond.notify_one();
+}
+
+void AudioPreview::Worker() {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (quit == false) {
+		if (requestGeneration != decodeGeneration) {
+			std::string file = requestFile;
+			long long frame = requestFrame;
+			decodeGeneration = requestGeneration;
+			lock.unlock();
+
+			// A seek in the playing file keeps the reader, and its seek table
+			if (file != "" && file == sourceFile && handle != NULL && SeekSource(frame)) {
+				FillSource(frame);
+			} else {
+				CloseSource();
+				if (file != "" && OpenSource(file, frame) == false) {
+					fprintf(stderr, "oamlStudio: Error opening: '%s'\n", file.c_str());
+
+					previewBlock block;
+					block.generation = decodeGeneration;
+					block.frames = 0;
+					block.eof = true;
+					block.position = (double)frame;
+					block.step = 1.0;
+					while (ring.Push(block) == false && quit == false) {
+						std::this_thread::sleep_for(std::chrono::milliseconds(2));
+					}
+				}
+			}
+
+			lock.lock();
+			continue;
+		}
+
+		if (handle == NULL) {
+			cond.wait(lock);
+			continue;
+		}
+
+		// Leave room for a last block and the end marker
+		if (ring.GetCount() >= PREVIEW_RING_BLOCKS - 1) {
+			cond.wait_for(lock, std::chrono::milliseconds(2));
+			continue;
+		}
+
+		lock.unlock();
+
+		previewBlock block;
+		bool more = DecodeBlock(block);
+		UpdateMemory();
+		if (block.frames > 0) {
+			ring.Push(block);
+		}
+
+		if (more == false) {
+			block.frames = 0;
+			block.eof = true;
+			ring.Push(block);
+			CloseSource();
+		}
+
+		lock.lock();
+	}
+}
+
+bool AudioPreview::OpenSource(std::string filename, long long frame) {
+	handle = CreateAudioFile(filename, &studioCbs);
+	if (handle == NULL)
+		return false;
+
+	if (handle->Open(filename.c_str()) == -1 || handle->GetChannels() <= 0 || handle->GetSamplesPerSec() <= 0) {
+		CloseSource();
+		return false;
+	}
+
+	step = outputRate > 0 ? (double)handle->GetSamplesPerSec() / outputRate : 1.0;
+
+	sourceFile = filename;
+
+	// A reader that can't get there decodes its way up from the start
+	SeekSource(frame);
+	FillSource(frame);
+
+	mem.SetFile(filename);
+	UpdateMemory();
+	return true;
+}
+
+bool AudioPreview::SeekSource(long long frame) {
+	srcBuf.clear();
+	pending.clear();
+	srcStart = 0;
+	srcFrames = 0;
+	srcEof = false;
+	readPos = (double)frame;
+
+	if (handle->SeekFrame(frame) == -1)
+		return false;
+
+	srcStart = frame;
+	return true;
+}
+
+void AudioPreview::CloseSource() {
+	if (handle) {
+		delete handle;
+		handle = NULL;
+	}
+
+	// Nothing to keep around while idle
+	std::vector<float>().swap(srcBuf);
+	std::vector<uint8_t>().swap(pending);
+	UpdateMemory();
+}
+
+// The ring is always there, the source buffers only while a file plays
+void AudioPreview::UpdateMemory() {
+	mem.Set((int64_t)sizeof(ring) + srcBuf.capacity() * sizeof(float) + pending.capacity());
+}
+
+bool AudioPreview::FillSource(long long needFrame) {
+	int channels = handle->GetChannels();
+	int bytesPerSample = handle->GetBytesPerSample();
+	int frameBytes = bytesPerSample * channels;
+	int format = handle->GetFormat();
+
+	for (;;) {
+		// Drop everything behind the read position
+		long long drop = (long long)readPos - srcStart;
+		if (drop > srcFrames) drop = srcFrames;
+		if (drop > 0) {
+			srcBuf.erase(srcBuf.begin(), srcBuf.begin() + drop * 2);
+			srcStart+= drop;
+			srcFrames-= (int)drop;
+		}
+
+		if (srcStart + srcFrames > needFrame)
+			return true;
+		if (srcEof)
+			return false;
+
+		char buf[4096];
+		int bytesRead = handle->Read(buf, sizeof(buf));
+		if (bytesRead <= 0) {
+			srcEof = true;
+			continue;
+		}
+
+		pending.insert(pending.end(), (uint8_t*)buf, (uint8_t*)buf + bytesRead);
+
+		int count = (int)pending.size() / frameBytes;
+		for (int i=0; i<count; i++) {
+			const uint8_t *ptr = &pending[i * frameBytes];
+			float l = ReadSample(format, ptr);
+			float r = channels > 1 ? ReadSample(format, ptr + bytesPerSample) : l;
+
+			srcBuf.push_back(l);
+			srcBuf.push_back(r);
+		}
+		srcFrames+= count;
+
+		pending.erase(pending.begin(), pending.begin() + count * frameBytes);
+	}
+}
+
+bool AudioPreview::DecodeBlock(previewBlock& block) {
+	block.generation = decodeGeneration;
+	block.frames = 0;
+	block.eof = false;
+	block.position = readPos;
+	block.step = step;
+
+	while (block.frames < PREVIEW_BLOCK_FRAMES) {
+		long long i = (long long)readPos;
+		if (FillSource(i + 1) == false && srcStart + srcFrames <= i)
+			return false;
+
+		int index = (int)(i - srcStart);
+		float l = srcBuf[index * 2];
+		float r = srcBuf[index * 2 + 1];
+
+		// Linear interpolation when the file isn't at the device rate
+		double frac = readPos - i;
+		if (frac > 0 && index + 1 < srcFrames) {
+			l+= (float)((srcBuf[index * 2 + 2] - l) * frac);
+			r+= (float)((srcBuf[index * 2 + 3] - r) * frac);
+		}
+
+		block.samples[block.frames * 2] = ToInt16(l);
+		block.samples[block.frames * 2 + 1] = ToInt16(r);
+		block.frames++;
+
+		readPos+= step;
+	}
+
+	return true;
+}
+
+void AudioPreview::Mix(int16_t *buffer, int frames, int channels) {
+	unsigned int gen = generation.load(std::memory_order_acquire);
+	int done = 0;
+
+	while (done < frames) {
+		if (currentOffset >= current.frames || current.generation != gen) {
+			if (ring.Pop(current) == false) {
+				// The worker fell behind in the middle of a file
+				if (primedGeneration == gen && endedGeneration != gen) {
+					underruns++;
+				}
+				break;
+			}
+
+			currentOffset = 0;
+
+			// Left over from before a seek or stop
+			if (current.generation != gen) {
+				current.frames = 0;
+				continue;
+			}
+
+			primedGeneration = gen;
+			if (current.eof) {
+				endedGeneration = gen;
+				continue;
+			}
+		}
+
+		int n = frames - done;
+		if (n > current.frames - currentOffset) n = current.frames - currentOffset;
+
+		int16_t *out = buffer + done * channels;
+		const int16_t *in = current.samples + currentOffset * 2;
+		for (int i=0; i<n; i++) {
+			if (channels == 1) {
+				out[i] = Clip16(out[i] + (in[i * 2] + in[i * 2 + 1]) / 2);
+			} else {
+				out[i * channels] = Clip16(out[i * channels] + in[i * 2]);
+				out[i * channels + 1] = Clip16(out[i * channels + 1] + in[i * 2 + 1]);
+			}
+		}
+
+		currentOffset+= n;
+		done+= n;
+		playFrame.store((long long)(current.position + currentOffset * current.step), std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,113 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include "oamlCore.h"
+
+
+bool CondEventLess(const condEvent& a, const condEvent& b) {
+	return a.time < b.time;
+}
+
+CondTimeline::CondTimeline() {
+	next = 0;
+}
+
+int CondTimeline::Parse(const std::string& text, std::string *error) {
+	events.clear();
+	next = 0;
+
+	int lineNum = 0;
+	size_t start = 0;
+	while (start < text.size()) {
+		size_t end = text.find('\n', start);
+		if (end == std::string::npos) end = text.size();
+
+		std::string line = text.substr(start, end - start);
+		start = end + 1;
+		lineNum++;
+
+		size_t comment = line.find('#');
+		if (comment != std::string::npos) {
+			line = line.substr(0, comment);
+		}
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+			continue;
+
+		condEvent ev;
+		char extra;
+		if (sscanf(line.c_str(), "%lf %d %d %c", &ev.time, &ev.condId, &ev.condValue, &extra) != 3 || ev.time < 0) {
+			if (error) {
+				char str[1024];
+				snprintf(str, 1024, "line %d: expected '<seconds> <condId> <condValue>'", lineNum);
+				*error = str;
+			}
+			events.clear();
+			return -1;
+		}
+
+		events.push_back(ev);
+	}
+
+	// Events at the same time keep their order
+	std::stable_sort(events.begin(), events.end(), CondEventLess);
+	return 0;
+}
+
+int CondTimeline::Load(const char *filename, std::string *error) {
+	FILE *f = fopen(filename, "rb");
+	if (f == NULL) {
+		if (error) *error = std::string("can't open ") + filename;
+		return -1;
+	}
+
+	std::string text;
+	char buf[4096];
+	size_t n;
+	while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+		text.append(buf, n);
+	}
+	fclose(f);
+
+	return Parse(text, error);
+}
+
+void CondTimeline::Add(double time, int condId, int condValue) {
+	condEvent ev = { time, condId, condValue };
+	events.insert(std::upper_bound(events.begin(), events.end(), ev, CondEventLess), ev);
+}
+
+bool CondTimeline::PopDue(double time, condEvent& event) {
+	if (next >= events.size() || events[next].time > time)
+		return false;
+
+	event = events[next++];
+	return true;
+}
+
+double CondTimeline::GetLength() const {
+	return events.size() > 0 ? events.back().time : 0.0;
+}
@@ -0,0 +1,176 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include "oamlCore.h"
+
+
+ConditionLatency::ConditionLatency() {
+	pending = false;
+	pendingTime = 0;
+	pendingCondId = 0;
+	pendingCondValue = 0;
+}
+
+void ConditionLatency::OnSetCondition(double nowMs, std::string trackName, std::string currentAudio, int condId, int condValue) {
+	// A new condition replaces one that hasn't switched yet
+	pending = trackName != "";
+	pendingTime = nowMs;
+	pendingTrack = trackName;
+	pendingAudio = currentAudio;
+	pendingCondId = condId;
+	pendingCondValue = condValue;
+}
+
+bool ConditionLatency::OnAudioPlaying(double nowMs, const oamlTrackInfo& track, std::string audioName) {
+	if (pending == false)
+		return false;
+
+	double ms = nowMs - pendingTime;
+	if (ms > LATENCY_TIMEOUT_MS) {
+		pending = false;
+		return false;
+	}
+
+	if (audioName == "" || audioName == pendingAudio)
+		return false;
+
+	if (IsConditionSwitch(track, pendingAudio, audioName, pendingCondId, pendingCondValue) == false)
+		return false;
+
+	latencyHistogram& hist = histograms[pendingTrack];
+	if (hist.total == 0) {
+		memset(hist.counts, 0, sizeof(hist.counts));
+		hist.sumMs = 0;
+		hist.maxMs = 0;
+		hist.recentCount = 0;
+		hist.recentNext = 0;
+	}
+
+	int bucket = (int)(ms / LATENCY_BUCKET_MS);
+	if (bucket > LATENCY_BUCKETS) bucket = LATENCY_BUCKETS;
+	hist.counts[bucket]++;
+	hist.total++;
+	hist.sumMs+= ms;
+	if (ms > hist.maxMs) hist.maxMs = ms;
+
+	// Oldest switch makes room once the ring is full
+	hist.recent[hist.recentNext] = ms;
+	hist.recentNext = (hist.recentNext + 1) % LATENCY_RECENT;
+	if (hist.recentCount < LATENCY_RECENT) hist.recentCount++;
+
+	pending = false;
+	return true;
+}
+
+const latencyHistogram* ConditionLatency::GetHistogram(std::string trackName) const {
+	std::map<std::string, latencyHistogram>::const_iterator it = histograms.find(trackName);
+	if (it == histograms.end() || it->second.total == 0)
+		return NULL;
+	return &it->second;
+}
+
+double ConditionLatency::GetPercentile(std::string trackName, double p) const {
+	const latencyHistogram *hist = GetHistogram(trackName);
+	if (hist == NULL)
+		return 0;
+
+	double sorted[LATENCY_RECENT];
+	memcpy(sorted, hist->recent, hist->recentCount * sizeof(double));
+	std::sort(sorted, sorted + hist->recentCount);
+
+	int index = (int)(p * (hist->recentCount - 1) + 0.5);
+	return sorted[index];
+}
+
+void ConditionLatency::Clear() {
+	histograms.clear();
+	pending = false;
+}
+
+double ConditionLatency::WorstCaseMs(const oamlTrackInfo& track, float projectBpm, int projectBeatsPerBar) {
+	// oaml waits for the audio playing to reach its next movement point
+	// (minMovementBars), a value of 0 switches right away. The new audio
+	// is fully audible once its fade or crossfade in is done.
+	double wait = 0;
+	double fade = track.fadeIn > track.xfadeIn ? track.fadeIn : track.xfadeIn;
+
+	for (std::vector<oamlAudioInfo>::const_iterator audio=track.audios.begin(); audio<track.audios.end(); ++audio) {
+		float bpm = audio->bpm > 0 ? audio->bpm : projectBpm;
+		int beatsPerBar = audio->beatsPerBar > 0 ? audio->beatsPerBar : projectBeatsPerBar;
+
+		if (audio->minMovementBars > 0 && bpm > 0 && beatsPerBar > 0) {
+			double ms = audio->minMovementBars * beatsPerBar * 60000.0 / bpm;
+			if (ms > wait) wait = ms;
+		}
+
+		if (audio->condId != 0) {
+			double ms = audio->fadeIn > audio->xfadeIn ? audio->fadeIn : audio->xfadeIn;
+			if (ms > fade) fade = ms;
+		}
+	}
+
+	return wait + fade;
+}
+
+bool ConditionLatency::AudioMatches(const oamlAudioInfo& audio, int condId, int condValue) {
+	if (audio.condId != condId)
+		return false;
+
+	switch (audio.condType) {
+		case LATENCY_COND_EQUAL: return condValue == audio.condValue;
+		case LATENCY_COND_GREATER: return condValue > audio.condValue;
+		case LATENCY_COND_LESS: return condValue < audio.condValue;
+		case LATENCY_COND_RANGE: return condValue >= audio.condValue && condValue <= audio.condValue2;
+	}
+	return false;
+}
+
+static const oamlAudioInfo* FindAudioInfo(const oamlTrackInfo& track, const std::string& name) {
+	for (std::vector<oamlAudioInfo>::const_iterator audio=track.audios.begin(); audio<track.audios.end(); ++audio) {
+		if (audio->name == name)
+			return &*audio;
+	}
+	return NULL;
+}
+
+bool ConditionLatency::IsConditionSwitch(const oamlTrackInfo& track, std::string before, std::string after, int condId, int condValue) {
+	// Random picks and the main loop moving on aren't caused by the
+	// condition, only the conditional loop it selects is
+	const oamlAudioInfo *afterInfo = FindAudioInfo(track, after);
+	if (afterInfo == NULL)
+		return false;
+
+	for (std::vector<oamlAudioInfo>::const_iterator audio=track.audios.begin(); audio<track.audios.end(); ++audio) {
+		if (AudioMatches(*audio, condId, condValue))
+			return AudioMatches(*afterInfo, condId, condValue);
+	}
+
+	// Nothing matches the new value, oaml leaves the conditional loop of
+	// this condition for the main loop
+	const oamlAudioInfo *beforeInfo = FindAudioInfo(track, before);
+	return beforeInfo && beforeInfo->condId == condId && afterInfo->condId == 0;
+}
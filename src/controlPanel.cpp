@@ -58,9 +58,12 @@ ControlPanel::ControlPanel(wxFrame* parent, wxWindowID id) : wxPanel(parent, id)
 	SetMinSize(wxSize(-1, 300));
 
 	Layout();
+
+	MemAddObjects(MEM_WIDGETS, "ControlPanel", 1);
 }
 
 ControlPanel::~ControlPanel() {
+	MemAddObjects(MEM_WIDGETS, "ControlPanel", -1);
 }
 
 void ControlPanel::SetTrackMode(bool mode) {
@@ -286,185 +289,99 @@ void ControlPanel::SetTrackMode(bool mode) {
 }
 
 void ControlPanel::OnVolumeChange(wxCommandEvent& WXUNUSED(event)) {
-	float vol = (float)volumeCtrl->GetValue();
-
-	// Don't change the actual volume unless it's different
-	if (studioApi->AudioGetVolume(trackName, audioName) != vol) {
-		// Send the actual change to oaml through the studioApi
-		studioApi->AudioSetVolume(trackName, audioName, vol);
-
-		MarkProjectDirty();
-	}
+	TRACE_SCOPE("ControlPanel::OnVolumeChange");
+	ApplyProperty(AUDIO_PROP_VOLUME, (float)volumeCtrl->GetValue());
 }
 
 void ControlPanel::OnBpmChange(wxCommandEvent& WXUNUSED(event)) {
-	float value = (float)bpmCtrl->GetValue();
-
-	// Don't change the actual value unless it's different
-	if (studioApi->AudioGetBPM(trackName, audioName) != value) {
-		// Send the actual change to oaml through the studioApi
-		studioApi->AudioSetBPM(trackName, audioName, value);
-
-		MarkProjectDirty();
-	}
+	TRACE_SCOPE("ControlPanel::OnBpmChange");
+	ApplyProperty(AUDIO_PROP_BPM, (float)bpmCtrl->GetValue());
 }
 
 void ControlPanel::OnBpbChange(wxCommandEvent& WXUNUSED(event)) {
-	int value = (int)bpbCtrl->GetValue();
-
-	// Don't change the actual value unless it's different
-	if (studioApi->AudioGetBeatsPerBar(trackName, audioName) != value) {
-		// Send the actual change to oaml through the studioApi
-		studioApi->AudioSetBeatsPerBar(trackName, audioName, value);
-
-		MarkProjectDirty();
-	}
+	TRACE_SCOPE("ControlPanel::OnBpbChange");
+	ApplyProperty(AUDIO_PROP_BEATS_PER_BAR, (float)bpbCtrl->GetValue());
 }
 
 void ControlPanel::OnBarsChange(wxCommandEvent& WXUNUSED(event)) {
-	int value = (int)barsCtrl->GetValue();
-
-	// Don't change the actual value unless it's different
-	if (studioApi->AudioGetBars(trackName, audioName) != value) {
-		// Send the actual change to oaml through the studioApi
-		studioApi->AudioSetBars(trackName, audioName, value);
-
-		MarkProjectDirty();
-	}
+	TRACE_SCOPE("ControlPanel::OnBarsChange");
+	ApplyProperty(AUDIO_PROP_BARS, (float)barsCtrl->GetValue());
 }
 
 void ControlPanel::OnRandomChanceChange(wxCommandEvent& WXUNUSED(event)) {
-	int value = (int)randomChanceCtrl->GetValue();
-
-	// Don't change the actual value unless it's different
-	if (studioApi->AudioGetRandomChance(trackName, audioName) != value) {
-		// Send the actual change to oaml through the studioApi
-		studioApi->AudioSetRandomChance(trackName, audioName, value);
-
-		MarkProjectDirty();
-	}
+	TRACE_SCOPE("ControlPanel::OnRandomChanceChange");
+	ApplyProperty(AUDIO_PROP_RANDOM_CHANCE, (float)randomChanceCtrl->GetValue());
 }
 
 void ControlPanel::OnMinMovementBarsChange(wxCommandEvent& WXUNUSED(event)) {
-	int value = (int)minMovementBarsCtrl->GetValue();
-
-	// Don't change the actual value unless it's different
-	if (studioApi->AudioGetMinMovementBars(trackName, audioName) != value) {
-		// Send the actual change to oaml through the studioApi
-		studioApi->AudioSetMinMovementBars(trackName, audioName, value);
-
-		MarkProjectDirty();
-	}
+	TRACE_SCOPE("ControlPanel::OnMinMovementBarsChange");
+	ApplyProperty(AUDIO_PROP_MIN_MOVEMENT_BARS, (float)minMovementBarsCtrl->GetValue());
 }
 
 void ControlPanel::OnFadeInChange(wxCommandEvent& WXUNUSED(event)) {
-	int value = (int)fadeInCtrl->GetValue();
-
-	// Don't change the actual value unless it's different
-	if (studioApi->AudioGetFadeIn(trackName, audioName) != value) {
-		// Send the actual change to oaml through the studioApi
-		studioApi->AudioSetFadeIn(trackName, audioName, value);
-
-		MarkProjectDirty();
-	}
+	TRACE_SCOPE("ControlPanel::OnFadeInChange");
+	ApplyProperty(AUDIO_PROP_FADE_IN, (float)fadeInCtrl->GetValue());
 }
 
 void ControlPanel::OnFadeOutChange(wxCommandEvent& WXUNUSED(event)) {
-	int value = (int)fadeOutCtrl->GetValue();
-
-	// Don't change the actual value unless it's different
-	if (studioApi->AudioGetFadeOut(trackName, audioName) != value) {
-		// Send the actual change to oaml through the studioApi
-		studioApi->AudioSetFadeOut(trackName, audioName, value);
-
-		MarkProjectDirty();
-	}
+	TRACE_SCOPE("ControlPanel::OnFadeOutChange");
+	ApplyProperty(AUDIO_PROP_FADE_OUT, (float)fadeOutCtrl->GetValue());
 }
 
 void ControlPanel::OnXFadeInChange(wxCommandEvent& WXUNUSED(event)) {
-	int value = (int)xfadeInCtrl->GetValue();
-
-	// Don't change the actual value unless it's different
-	if (studioApi->AudioGetXFadeIn(trackName, audioName) != value) {
-		// Send the actual change to oaml through the studioApi
-		studioApi->AudioSetXFadeIn(trackName, audioName, value);
-
-		MarkProjectDirty();
-	}
+	TRACE_SCOPE("ControlPanel::OnXFadeInChange");
+	ApplyProperty(AUDIO_PROP_XFADE_IN, (float)xfadeInCtrl->GetValue());
 }
 
 void ControlPanel::OnXFadeOutChange(wxCommandEvent& WXUNUSED(event)) {
-	int value = (int)xfadeOutCtrl->GetValue();
-
-	// Don't change the actual value unless it's different
-	if (studioApi->AudioGetXFadeOut(trackName, audioName) != value) {
-		// Send the actual change to oaml through the studioApi
-		studioApi->AudioSetXFadeOut(trackName, audioName, value);
-
-		MarkProjectDirty();
-	}
+	TRACE_SCOPE("ControlPanel::OnXFadeOutChange");
+	ApplyProperty(AUDIO_PROP_XFADE_OUT, (float)xfadeOutCtrl->GetValue());
 }
 
 void ControlPanel::OnCondIdChange(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("ControlPanel::OnCondIdChange");
 	wxString str = condIdCtrl->GetLineText(0);
 	if (str.IsEmpty())
 		return;
 
 	long l = 0;
 	str.ToLong(&l);
-	// Don't change the actual value unless it's different
-	if (studioApi->AudioGetCondId(trackName, audioName) != (int)l) {
-		// Send the actual change to oaml through the studioApi
-		studioApi->AudioSetCondId(trackName, audioName, (int)l);
-
-		MarkProjectDirty();
-	}
+	ApplyProperty(AUDIO_PROP_COND_ID, (float)l);
 }
 
 void ControlPanel::OnCondTypeChange(wxCommandEvent& WXUNUSED(event)) {
-	int condType = condTypeCtrl->GetCurrentSelection();
-	// Don't change the actual value unless it's different
-	if (studioApi->AudioGetCondType(trackName, audioName) != condType) {
-		// Send the actual change to oaml through the studioApi
-		studioApi->AudioSetCondType(trackName, audioName, condType);
-
-		MarkProjectDirty();
-	}
+	TRACE_SCOPE("ControlPanel::OnCondTypeChange");
+	ApplyProperty(AUDIO_PROP_COND_TYPE, (float)condTypeCtrl->GetCurrentSelection());
 }
 
 void ControlPanel::OnCondValueChange(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("ControlPanel::OnCondValueChange");
 	wxString str = condValueCtrl->GetLineText(0);
 	if (str.IsEmpty())
 		return;
 
 	long l = 0;
 	str.ToLong(&l);
-	// Don't change the actual value unless it's different
-	if (studioApi->AudioGetCondValue(trackName, audioName) != (int)l) {
-		// Send the actual change to oaml through the studioApi
-		studioApi->AudioSetCondValue(trackName, audioName, (int)l);
-
-		MarkProjectDirty();
-	}
+	ApplyProperty(AUDIO_PROP_COND_VALUE, (float)l);
 }
 
 void ControlPanel::OnCondValue2Change(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("ControlPanel::OnCondValue2Change");
 	wxString str = condValue2Ctrl->GetLineText(0);
 	if (str.IsEmpty())
 		return;
 
 	long l = 0;
 	str.ToLong(&l);
-	// Don't change the actual value unless it's different
-	if (studioApi->AudioGetCondValue2(trackName, audioName) != (int)l) {
-		// Send the actual change to oaml through the studioApi
-		studioApi->AudioSetCondValue2(trackName, audioName, (int)l);
-
-		MarkProjectDirty();
-	}
+	ApplyProperty(AUDIO_PROP_COND_VALUE2, (float)l);
 }
 
 void ControlPanel::OnNameChange(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("ControlPanel::OnNameChange");
+	// Renaming doesn't make sense for several audios at once
+	if (IsBatchMode())
+		return;
+
 	wxString str = nameCtrl->GetLineText(0);
 	if (str.IsEmpty())
 		return;
@@ -477,20 +394,26 @@ void ControlPanel::OnNameChange(wxCommandEvent& WXUNUSED(event)) {
 
 		// Audio has a new name now
 		audioName = str.ToStdString();
-		wxCommandEvent event(EVENT_UPDATE_AUDIO_NAME);
-		event.SetString(oldName+audioName);
-		event.SetInt(oldName.length());
-		wxPostEvent(GetParent(), event);
+		eventBus->PostAudioRename(trackName, oldName, audioName);
 
 		MarkProjectDirty();
 	}
 }
 
 void ControlPanel::OnAFLayerChange(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("ControlPanel::OnAFLayerChange");
 	wxString str = afLayerCtrl->GetLineText(0);
 	if (str.IsEmpty())
 		return;
 
+	if (IsBatchMode()) {
+		AudioBatchEdit batch(studioApi, trackName, selection);
+		if (batch.SetLayer(str.ToStdString()) > 0) {
+			MarkProjectDirty();
+		}
+		return;
+	}
+
 	// Don't change the actual value unless it's different
 	if (studioApi->AudioFileGetLayer(trackName, audioName, filename) != str.ToStdString()) {
 		// Send the actual change to oaml through the studioApi
@@ -502,21 +425,29 @@ void ControlPanel::OnAFLayerChange(wxCommandEvent& WXUNUSED(event)) {
 
 
 void ControlPanel::OnAFRandomChanceChange(wxCommandEvent& WXUNUSED(event)) {
-	int value = (int)afRandomChanceCtrl->GetValue();
-
-	// Don't change the actual value unless it's different
-	if (studioApi->AudioFileGetRandomChance(trackName, audioName, filename) != value) {
-		// Send the actual change to oaml through the studioApi
-		studioApi->AudioFileSetRandomChance(trackName, audioName, filename, value);
-
-		MarkProjectDirty();
-	}
+	TRACE_SCOPE("ControlPanel::OnAFRandomChanceChange");
+	ApplyProperty(AUDIO_PROP_FILE_RANDOM_CHANCE, (float)afRandomChanceCtrl->GetValue());
 }
 
 
 void ControlPanel::MarkProjectDirty() {
-	wxCommandEvent event(EVENT_SET_PROJECT_DIRTY);
-	wxPostEvent(GetParent(), event);
+	eventBus->PostDirty();
+}
+
+void ControlPanel::ApplyProperty(int prop, float value) {
+	if (IsBatchMode()) {
+		// Apply the change to every selected audio as a single transaction,
+		// the project is marked dirty once no matter how many audios changed
+		AudioBatchEdit batch(studioApi, trackName, selection);
+		if (batch.SetProperty(prop, value) > 0) {
+			MarkProjectDirty();
+		}
+	} else {
+		audioSelection sel = { audioName, filename };
+		if (AudioSetProperty(studioApi, trackName, sel, prop, value)) {
+			MarkProjectDirty();
+		}
+	}
 }
 
 void ControlPanel::SetTrack(std::string name) {
@@ -524,10 +455,12 @@ void ControlPanel::SetTrack(std::string name) {
 }
 
 void ControlPanel::OnSelectAudio(std::string _audioName, std::string _filename) {
+	TRACE_SCOPE("ControlPanel::OnSelectAudio");
 	bool enable;
 
 	audioName = _audioName;
 	filename = _filename;
+	selection.clear();
 
 	nameCtrl->Clear();
 	fileCtrl->Clear();
@@ -567,6 +500,7 @@ void ControlPanel::OnSelectAudio(std::string _audioName, std::string _filename)
 		enable = false;
 	}
 
+	nameCtrl->Enable(enable);
 	volumeCtrl->Enable(enable);
 
 	if (musicMode) {
@@ -588,6 +522,27 @@ void ControlPanel::OnSelectAudio(std::string _audioName, std::string _filename)
 	}
 }
 
+void ControlPanel::OnSelectAudios(const std::vector<audioSelection>& list) {
+	TRACE_SCOPE("ControlPanel::OnSelectAudios");
+	if (list.size() <= 1) {
+		if (list.empty()) {
+			OnSelectAudio("", "");
+		} else {
+			OnSelectAudio(list[0].audioName, list[0].filename);
+		}
+		return;
+	}
+
+	// Controls show the values of the last audio selected, any change
+	// done from now on is applied to the whole selection
+	OnSelectAudio(list.back().audioName, list.back().filename);
+	selection = list;
+
+	nameCtrl->Enable(false);
+	fileCtrl->Clear();
+	*fileCtrl << wxString::Format("%d audio files selected", (int)list.size());
+}
+
 void ControlPanel::UpdateTrackName(std::string oldName, std::string newName) {
 	if (trackName.compare(oldName) != 0)
 		return;
@@ -0,0 +1,277 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include "oamlCommon.h"
+
+#include <wx/textdlg.h>
+
+
+static wxString FormatBytes(int64_t bytes) {
+	if (bytes >= 1073741824LL)
+		return wxString::Format("%.2f GB", bytes / 1073741824.0);
+	if (bytes >= 1048576LL)
+		return wxString::Format("%.1f MB", bytes / 1048576.0);
+	return wxString::Format("%.1f KB", bytes / 1024.0);
+}
+
+static bool CompareTrackUsage(const memTrackUsage& a, const memTrackUsage& b) {
+	return a.decodedBytes + a.heldBytes > b.decodedBytes + b.heldBytes;
+}
+
+DiagnosticsFrame::DiagnosticsFrame(wxWindow *parent, wxWindowID id) : wxFrame(parent, id, _("Diagnostics"), wxPoint(50, 50), wxSize(560, 640), wxFRAME_TOOL_WINDOW | wxFRAME_FLOAT_ON_PARENT | wxCAPTION | wxRESIZE_BORDER | wxCLOSE_BOX)) {
+	mSizer = new wxBoxSizer(wxVERTICAL);
+
+	summaryText = new wxStaticText(this, wxID_ANY, wxEmptyString);
+	mSizer->Add(summaryText, 0, wxEXPAND | wxALL, 5);
+
+	wxBoxSizer *hSizer = new wxBoxSizer(wxHORIZONTAL);
+
+	memoryList = new wxListCtrl(this, wxID_ANY, wxDefaultPosition, wxSize(-1, 160), wxLC_REPORT | wxLC_SINGLE_SEL);
+	memoryList->InsertColumn(0, _("Subsystem"), wxLIST_FORMAT_LEFT, 110);
+	memoryList->InsertColumn(1, _("Current"), wxLIST_FORMAT_RIGHT, 80);
+	memoryList->InsertColumn(2, _("Peak"), wxLIST_FORMAT_RIGHT, 80);
+	memoryList->InsertColumn(3, _("Objects"), wxLIST_FORMAT_RIGHT, 60);
+	memoryList->InsertColumn(4, _("Budget"), wxLIST_FORMAT_RIGHT, 80);
+	for (int i=0; i<MEM_SUBSYSTEMS; i++) {
+		memoryList->InsertItem(i, MemGetName(i));
+	}
+	memoryList->Bind(wxEVT_LIST_ITEM_ACTIVATED, &DiagnosticsFrame::OnMemoryActivated, this);
+	hSizer->Add(memoryList, 1, wxEXPAND | wxRIGHT, 5);
+
+	objectList = new wxListCtrl(this, wxID_ANY, wxDefaultPosition, wxSize(150, 160), wxLC_REPORT | wxLC_SINGLE_SEL);
+	objectList->InsertColumn(0, _("Object"), wxLIST_FORMAT_LEFT, 100);
+	objectList->InsertColumn(1, _("Live"), wxLIST_FORMAT_RIGHT, 45);
+	hSizer->Add(objectList, 0, wxEXPAND, 0);
+
+	mSizer->Add(hSizer, 0, wxEXPAND | wxALL, 5);
+
+	wxBoxSizer *budgetSizer = new wxBoxSizer(wxHORIZONTAL);
+	wxStaticText *staticText = new wxStaticText(this, wxID_ANY, _("Track budget (MB, 0 for none)"));
+	budgetSizer->Add(staticText, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 5);
+
+	trackBudgetCtrl = new wxSpinCtrlDouble(this, wxID_ANY);
+	trackBudgetCtrl->SetRange(0, 1048576);
+	trackBudgetCtrl->SetIncrement(64);
+	trackBudgetCtrl->SetDigits(0);
+	trackBudgetCtrl->Bind(wxEVT_SPINCTRLDOUBLE, &DiagnosticsFrame::OnTrackBudgetChange, this);
+	budgetSizer->Add(trackBudgetCtrl, 0, 0, 0);
+	mSizer->Add(budgetSizer, 0, wxLEFT | wxRIGHT, 5);
+
+	trackList = new wxListCtrl(this, wxID_ANY, wxDefaultPosition, wxSize(-1, 220), wxLC_REPORT | wxLC_SINGLE_SEL);
+	trackList->InsertColumn(0, _("Track"), wxLIST_FORMAT_LEFT, 160);
+	trackList->InsertColumn(1, _("Files"), wxLIST_FORMAT_RIGHT, 50);
+	trackList->InsertColumn(2, _("Decoded"), wxLIST_FORMAT_RIGHT, 90);
+	trackList->InsertColumn(3, _("Held"), wxLIST_FORMAT_RIGHT, 90);
+	trackList->InsertColumn(4, _("Model"), wxLIST_FORMAT_RIGHT, 80);
+	mSizer->Add(trackList, 1, wxEXPAND | wxALL, 5);
+
+	stallList = new wxListCtrl(this, wxID_ANY, wxDefaultPosition, wxSize(-1, 120), wxLC_REPORT | wxLC_SINGLE_SEL);
+	stallList->InsertColumn(0, _("Stalled"), wxLIST_FORMAT_LEFT, 80);
+	stallList->InsertColumn(1, _("Duration"), wxLIST_FORMAT_RIGHT, 80);
+	stallList->InsertColumn(2, _("Handler"), wxLIST_FORMAT_LEFT, 330);
+	mSizer->Add(stallList, 0, wxEXPAND | wxALL, 5);
+
+	Bind(wxEVT_CLOSE_WINDOW, &DiagnosticsFrame::OnClose, this);
+
+	SetSizerAndFit(mSizer);
+	Layout();
+
+	long mb;
+	((StudioFrame*)GetParent())->GetConfig()->Read("MemoryBudgetTrack", &mb, 0);
+	trackBudgetCtrl->SetValue(mb);
+
+	timer = new DiagnosticsTimer(this);
+}
+
+DiagnosticsFrame::~DiagnosticsFrame() {
+	delete timer;
+}
+
+// Budgets are kept in MB, applied as soon as the studio starts
+void DiagnosticsFrame::LoadBudgets(wxConfig *config) {
+	long mb;
+	for (int i=0; i<MEM_SUBSYSTEMS; i++) {
+		config->Read(wxString("MemoryBudget") + MemGetKey(i), &mb, 0);
+		MemSetBudget(i, (int64_t)mb * 1048576);
+	}
+}
+
+bool DiagnosticsFrame::Show(bool show) {
+	if (show) {
+		Update();
+		timer->Start(DIAGNOSTICS_REFRESH_RATE);
+	} else {
+		timer->Stop();
+	}
+
+	return wxFrame::Show(show);
+}
+
+void DiagnosticsFrame::OnClose(wxCloseEvent& event) {
+	wxCommandEvent event2(EVENT_CLOSE_DIAGNOSTICS);
+	wxPostEvent(GetParent(), event2);
+
+	event.Veto();
+}
+
+void DiagnosticsFrame::OnMemoryActivated(wxListEvent& event) {
+	TRACE_SCOPE("DiagnosticsFrame::OnMemoryActivated");
+	int subsystem = (int)event.GetIndex();
+	if (subsystem < 0 || subsystem >= MEM_SUBSYSTEMS)
+		return;
+
+	memCounter counter;
+	MemGet(subsystem, counter);
+
+	wxString value = wxGetTextFromUser(_("Budget in MB, 0 for none"), MemGetName(subsystem), wxString::Format("%lld", (long long)(counter.budget / 1048576)), this);
+	long mb;
+	if (value.IsEmpty() || value.ToLong(&mb) == false || mb < 0)
+		return;
+
+	MemSetBudget(subsystem, (int64_t)mb * 1048576);
+
+	wxConfig *config = ((StudioFrame*)GetParent())->GetConfig();
+	config->Write(wxString("MemoryBudget") + MemGetKey(subsystem), mb);
+
+	UpdateMemory();
+}
+
+void DiagnosticsFrame::OnTrackBudgetChange(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("DiagnosticsFrame::OnTrackBudgetChange");
+	wxConfig *config = ((StudioFrame*)GetParent())->GetConfig();
+	config->Write("MemoryBudgetTrack", (long)trackBudgetCtrl->GetValue());
+
+	UpdateTracks();
+}
+
+void DiagnosticsFrame::UpdateMemory() {
+	int64_t total = 0;
+	for (int i=0; i<MEM_SUBSYSTEMS; i++) {
+		memCounter counter;
+		MemGet(i, counter);
+		total+= counter.bytes;
+
+		memoryList->SetItem(i, 1, FormatBytes(counter.bytes));
+		memoryList->SetItem(i, 2, FormatBytes(counter.peakBytes));
+		memoryList->SetItem(i, 3, wxString::Format("%lld", (long long)counter.objects));
+		memoryList->SetItem(i, 4, counter.budget > 0 ? FormatBytes(counter.budget) : wxString("-"));
+		memoryList->SetItemTextColour(i, counter.budget > 0 && counter.bytes > counter.budget ? *wxRED : memoryList->GetTextColour());
+	}
+
+	wxString summary = wxString::Format(_("Process %s resident, %s accounted for"), FormatBytes(MemGetProcessBytes()), FormatBytes(total));
+	summary+= wxString::Format(_("\nStartup window ready in %.0f ms, audio device opened in %.0f ms"), startupMs, studioAudio ? studioAudio->GetOpenMs() : 0.0);
+
+	// Whatever goes through the project context: oaml, previews and waveforms
+	std::shared_ptr<FileContext> project = GetProjectFiles();
+	if (project) {
+		fileStats stats;
+		project->GetStats(stats);
+		summary+= wxString::Format(_("\nProject files: %llu opened, %s read in %llu reads, %.0f ms in I/O"), (unsigned long long)stats.opens, FormatBytes((int64_t)stats.bytesRead), (unsigned long long)stats.reads, stats.ioNs / 1000000.0);
+	}
+	summaryText->SetLabel(summary);
+
+	std::map<std::string, int64_t> objects;
+	MemGetObjects(objects);
+
+	objectList->Freeze();
+	objectList->DeleteAllItems();
+	int row = 0;
+	for (std::map<std::string, int64_t>::iterator it=objects.begin(); it!=objects.end(); ++it) {
+		objectList->InsertItem(row, it->first);
+		objectList->SetItem(row, 1, wxString::Format("%lld", (long long)it->second));
+		row++;
+	}
+	objectList->Thaw();
+}
+
+// Heaviest tracks first, the ones over budget in red
+void DiagnosticsFrame::UpdateTracks() {
+	if (((StudioFrame*)GetParent())->IsParsing())
+		return;
+
+	oamlTracksInfo *info = oaml->GetTracksInfo();
+	((StudioFrame*)GetParent())->UpdateProjectMemory(info);
+
+	std::vector<memTrackUsage> usage;
+	MemGetTrackUsage(info, usage);
+	std::sort(usage.begin(), usage.end(), CompareTrackUsage);
+
+	int64_t budget = (int64_t)trackBudgetCtrl->GetValue() * 1048576;
+
+	trackList->Freeze();
+	trackList->DeleteAllItems();
+	for (size_t i=0; i<usage.size(); i++) {
+		const memTrackUsage& track = usage[i];
+		long row = trackList->InsertItem((long)i, track.name);
+		trackList->SetItem(row, 1, wxString::Format("%d", track.files));
+		trackList->SetItem(row, 2, FormatBytes(track.decodedBytes));
+		trackList->SetItem(row, 3, FormatBytes(track.heldBytes));
+		trackList->SetItem(row, 4, FormatBytes(track.modelBytes));
+
+		if (budget > 0 && track.decodedBytes + track.heldBytes > budget) {
+			trackList->SetItemTextColour(row, *wxRED);
+		}
+	}
+	trackList->Thaw();
+}
+
+void DiagnosticsFrame::UpdateStalls() {
+	UiWatchdog *watchdog = ((StudioFrame*)GetParent())->GetWatchdog();
+	if (watchdog == NULL)
+		return;
+
+	std::vector<uiStall> stalls;
+	watchdog->GetStalls(stalls);
+
+	double now = UiWatchdog::NowMs();
+
+	stallList->Freeze();
+	stallList->DeleteAllItems();
+	for (size_t i=0; i<stalls.size(); i++) {
+		// Newest first
+		const uiStall& stall = stalls[stalls.size() - 1 - i];
+		long row = stallList->InsertItem((long)i, wxString::Format(_("%.0f s ago"), (now - stall.startMs) / 1000.0));
+		stallList->SetItem(row, 1, wxString::Format("%.0f ms", stall.durationMs));
+		stallList->SetItem(row, 2, stall.scope);
+	}
+	stallList->Thaw();
+}
+
+void DiagnosticsFrame::Update() {
+	TRACE_SCOPE("DiagnosticsFrame::Update");
+	UpdateTracks();
+	UpdateMemory();
+	UpdateStalls();
+}
+
+DiagnosticsTimer::DiagnosticsTimer(DiagnosticsFrame* pane) : wxTimer() {
+	DiagnosticsTimer::pane = pane;
+}
+
+void DiagnosticsTimer::Notify() {
+	pane->Update();
+}
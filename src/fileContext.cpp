@@ -0,0 +1,156 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+
+#include "oamlCore.h"
+
+
+typedef struct {
+	FILE *file;
+	std::shared_ptr<FileContext> context;
+} fileHandle;
+
+// oaml's callbacks carry no user pointer, so each context gets an open
+// callback of its own that finds it through its slot
+static std::mutex slotMutex;
+static std::atomic<FileContext*> slots[FILE_CONTEXT_SLOTS];
+
+template <int N> static void* SlotOpen(const char *filename) {
+	FileContext *context = slots[N].load(std::memory_order_acquire);
+	if (context == NULL)
+		return NULL;
+
+	return context->Open(filename);
+}
+
+#define SLOT_OPEN4(n) &SlotOpen<n>, &SlotOpen<n+1>, &SlotOpen<n+2>, &SlotOpen<n+3>
+
+static void* (*const slotOpen[FILE_CONTEXT_SLOTS])(const char *filename) = {
+	SLOT_OPEN4(0), SLOT_OPEN4(4), SLOT_OPEN4(8), SLOT_OPEN4(12),
+	SLOT_OPEN4(16), SLOT_OPEN4(20), SLOT_OPEN4(24), SLOT_OPEN4(28)
+};
+
+FileContext::FileContext(const std::string& _root, size_t _readAhead) : root(_root), readAhead(_readAhead), slot(-1), opens(0), failedOpens(0), reads(0), bytesRead(0), ioNs(0) {
+	cbs.open = NULL;
+	cbs.read = &FileContext::Read;
+	cbs.seek = &FileContext::Seek;
+	cbs.tell = &FileContext::Tell;
+	cbs.close = &FileContext::Close;
+}
+
+FileContext::~FileContext() {
+	if (slot >= 0) {
+		std::lock_guard<std::mutex> lock(slotMutex);
+		slots[slot].store(NULL, std::memory_order_release);
+	}
+}
+
+std::shared_ptr<FileContext> FileContext::Create(const std::string& root, size_t readAhead) {
+	std::lock_guard<std::mutex> lock(slotMutex);
+
+	for (int i=0; i<FILE_CONTEXT_SLOTS; i++) {
+		if (slots[i].load(std::memory_order_relaxed) != NULL)
+			continue;
+
+		std::shared_ptr<FileContext> context(new FileContext(root, readAhead));
+		context->slot = i;
+		context->cbs.open = slotOpen[i];
+		slots[i].store(context.get(), std::memory_order_release);
+		return context;
+	}
+
+	fprintf(stderr, "oamlStudio: no free file context for '%s'\n", root.c_str());
+	return std::shared_ptr<FileContext>();
+}
+
+void* FileContext::Open(const char *filename) {
+	uint64_t start = TraceNowNs();
+	std::string fullpath(root + filename);
+	FILE *file = fopen(fullpath.c_str(), "rb");
+	if (file == NULL) {
+		failedOpens.fetch_add(1, std::memory_order_relaxed);
+		ioNs.fetch_add(TraceNowNs() - start, std::memory_order_relaxed);
+		return NULL;
+	}
+
+	if (readAhead > 0) {
+		setvbuf(file, NULL, _IOFBF, readAhead);
+	}
+
+	fileHandle *handle = new fileHandle;
+	handle->file = file;
+	handle->context = shared_from_this();
+
+	opens.fetch_add(1, std::memory_order_relaxed);
+	ioNs.fetch_add(TraceNowNs() - start, std::memory_order_relaxed);
+	return handle;
+}
+
+void FileContext::GetStats(fileStats& out) const {
+	out.opens = opens.load(std::memory_order_relaxed);
+	out.failedOpens = failedOpens.load(std::memory_order_relaxed);
+	out.reads = reads.load(std::memory_order_relaxed);
+	out.bytesRead = bytesRead.load(std::memory_order_relaxed);
+	out.ioNs = ioNs.load(std::memory_order_relaxed);
+}
+
+size_t FileContext::Read(void *ptr, size_t size, size_t nitems, void *fd) {
+	fileHandle *handle = (fileHandle*)fd;
+	FileContext *context = handle->context.get();
+
+	uint64_t start = TraceNowNs();
+	size_t ret = fread(ptr, size, nitems, handle->file);
+	context->ioNs.fetch_add(TraceNowNs() - start, std::memory_order_relaxed);
+	context->reads.fetch_add(1, std::memory_order_relaxed);
+	context->bytesRead.fetch_add(ret * size, std::memory_order_relaxed);
+	return ret;
+}
+
+int FileContext::Seek(void *fd, long offset, int whence) {
+	fileHandle *handle = (fileHandle*)fd;
+
+	uint64_t start = TraceNowNs();
+	int ret = fseek(handle->file, offset, whence);
+	handle->context->ioNs.fetch_add(TraceNowNs() - start, std::memory_order_relaxed);
+	return ret;
+}
+
+long FileContext::Tell(void *fd) {
+	return ftell(((fileHandle*)fd)->file);
+}
+
+int FileContext::Close(void *fd) {
+	fileHandle *handle = (fileHandle*)fd;
+	FileContext *context = handle->context.get();
+
+	uint64_t start = TraceNowNs();
+	int ret = fclose(handle->file);
+	context->ioNs.fetch_add(TraceNowNs() - start, std::memory_order_relaxed);
+
+	// May drop the last reference to the context
+	delete handle;
+	return ret;
+}
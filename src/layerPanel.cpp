@@ -115,8 +115,7 @@ void LayerPanel::OnLayerNameChange(wxCommandEvent& event) {
 	studioApi->LayerRename(data->name, str.ToStdString());
 
 	// Mark the project dirty
-	wxCommandEvent event2(EVENT_SET_PROJECT_DIRTY);
-	wxPostEvent(GetParent(), event2);
+	eventBus->PostDirty();
 }
 
 void LayerPanel::AddNewLayer() {
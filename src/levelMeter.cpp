@@ -0,0 +1,121 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "oamlCore.h"
+
+
+// Refreshes the peak hold stays up before it starts falling
+#define METER_HOLD_TICKS	30
+#define METER_FALL_RATE		0.9f
+
+void MeterClear(meterBlock& block) {
+	for (int c=0; c<METER_CHANNELS; c++) {
+		block.peak[c] = 0.0f;
+		block.sumSquares[c] = 0.0f;
+	}
+	block.frames = 0;
+}
+
+void MeterAnalyze(const int16_t *samples, int frames, int channels, meterBlock& block) {
+	MeterClear(block);
+	if (channels <= 0)
+		return;
+
+	for (int i=0; i<frames; i++) {
+		for (int c=0; c<METER_CHANNELS; c++) {
+			// Mono goes to both meters
+			float s = samples[i * channels + (c < channels ? c : 0)] / 32768.0f;
+			float a = s < 0 ? -s : s;
+
+			if (a > block.peak[c]) block.peak[c] = a;
+			block.sumSquares[c]+= s * s;
+		}
+	}
+
+	block.frames = frames;
+}
+
+void MeterMerge(meterBlock& into, const meterBlock& block) {
+	for (int c=0; c<METER_CHANNELS; c++) {
+		if (block.peak[c] > into.peak[c]) into.peak[c] = block.peak[c];
+		into.sumSquares[c]+= block.sumSquares[c];
+	}
+	into.frames+= block.frames;
+}
+
+float MeterToDb(float value) {
+	if (value <= 0.000001f)
+		return -120.0f;
+	return 20.0f * log10f(value);
+}
+
+
+LevelMeter::LevelMeter() {
+	Reset();
+}
+
+void LevelMeter::Reset() {
+	for (int c=0; c<METER_CHANNELS; c++) {
+		peak[c] = 0.0f;
+		rms[c] = 0.0f;
+		hold[c] = 0.0f;
+		holdTicks[c] = 0;
+		clipped[c] = false;
+	}
+}
+
+void LevelMeter::Update(const meterBlock& block) {
+	for (int c=0; c<METER_CHANNELS; c++) {
+		if (block.frames > 0) {
+			peak[c] = block.peak[c];
+			rms[c] = sqrtf(block.sumSquares[c] / block.frames);
+		} else {
+			// Nothing came from the audio thread, let the meter fall
+			peak[c]*= METER_FALL_RATE;
+			rms[c]*= METER_FALL_RATE;
+		}
+
+		if (peak[c] >= hold[c]) {
+			hold[c] = peak[c];
+			holdTicks[c] = METER_HOLD_TICKS;
+		} else if (holdTicks[c] > 0) {
+			holdTicks[c]--;
+		} else {
+			hold[c]*= METER_FALL_RATE;
+		}
+
+		if (block.peak[c] >= METER_CLIP_LEVEL) {
+			clipped[c] = true;
+		}
+	}
+}
+
+void LevelMeter::ResetClip() {
+	for (int c=0; c<METER_CHANNELS; c++) {
+		clipped[c] = false;
+	}
+}
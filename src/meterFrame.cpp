@@ -0,0 +1,182 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "oamlCommon.h"
+
+#include <wx/dcbuffer.h>
+
+
+MeterFrame::MeterFrame(wxWindow *parent, wxWindowID id) : wxFrame(parent, id, _("Meters"), wxPoint(50, 50), wxSize(200, 260), wxFRAME_TOOL_WINDOW | wxFRAME_FLOAT_ON_PARENT | wxCAPTION | wxRESIZE_BORDER | wxCLOSE_BOX) {
+	mSizer = new wxBoxSizer(wxVERTICAL);
+
+	meterPanel = new wxPanel(this, wxID_ANY, wxDefaultPosition, wxSize(180, 200));
+	meterPanel->SetBackgroundStyle(wxBG_STYLE_PAINT);
+	meterPanel->Bind(wxEVT_PAINT, &MeterFrame::OnPaintMeters, this);
+	meterPanel->Bind(wxEVT_LEFT_UP, &MeterFrame::OnClickMeters, this);
+	mSizer->Add(meterPanel, 1, wxEXPAND | wxALL, 5);
+
+	statsText = new wxStaticText(this, wxID_ANY, wxEmptyString);
+	mSizer->Add(statsText, 0, wxEXPAND | wxALL, 5);
+
+	Bind(wxEVT_CLOSE_WINDOW, &MeterFrame::OnClose, this);
+
+	SetSizerAndFit(mSizer);
+	Layout();
+
+	timer = new MeterTimer(this);
+}
+
+MeterFrame::~MeterFrame() {
+	if (studioAudio) {
+		studioAudio->SetMetering(false);
+	}
+
+	delete timer;
+}
+
+bool MeterFrame::Show(bool show) {
+	// The audio thread only analyzes blocks while someone's looking
+	if (studioAudio) {
+		studioAudio->WaitOpen();
+	}
+	if (studioAudio && studioAudio->IsOpen()) {
+		studioAudio->SetMetering(show);
+	}
+
+	if (show) {
+		master.Reset();
+		timer->Start(METER_REFRESH_RATE);
+	} else {
+		timer->Stop();
+	}
+
+	return wxFrame::Show(show);
+}
+
+void MeterFrame::OnClose(wxCloseEvent& event) {
+	wxCommandEvent event2(EVENT_CLOSE_METERS);
+	wxPostEvent(GetParent(), event2);
+
+	event.Veto();
+}
+
+void MeterFrame::OnClickMeters(wxMouseEvent& WXUNUSED(event)) {
+	master.ResetClip();
+	meterPanel->Refresh();
+}
+
+void MeterFrame::Update() {
+	if (studioAudio == NULL || studioAudio->IsOpen() == false) {
+		statsText->SetLabel(_("No audio device"));
+		timer->Stop();
+		return;
+	}
+
+	// Everything the audio thread published since the last refresh makes one reading
+	meterBlock total;
+	meterBlock block;
+	MeterClear(total);
+	while (studioAudio->PopMeter(block)) {
+		MeterMerge(total, block);
+	}
+	master.Update(total);
+
+	audioCallbackStats stats;
+	studioAudio->GetCallbackStats(stats, false);
+	statsText->SetLabel(wxString::Format(_("Callback %.2f ms, max %.2f of %.2f ms"), stats.lastNs / 1000000.0, stats.maxNs / 1000000.0, stats.budgetNs / 1000000.0));
+
+	meterPanel->Refresh(false);
+}
+
+void MeterFrame::DrawMeter(wxDC& dc, int x, int y, int w, int h, int channel) {
+	float range = -METER_MIN_DB;
+	float rmsDb = MeterToDb(master.GetRms(channel));
+	float peakDb = MeterToDb(master.GetPeak(channel));
+	float holdDb = MeterToDb(master.GetHold(channel));
+
+	int rmsH = rmsDb > METER_MIN_DB ? (int)(h * (rmsDb - METER_MIN_DB) / range) : 0;
+	int peakH = peakDb > METER_MIN_DB ? (int)(h * (peakDb - METER_MIN_DB) / range) : 0;
+	int holdY = holdDb > METER_MIN_DB ? y + h - (int)(h * (holdDb - METER_MIN_DB) / range) : -1;
+
+	dc.SetPen(*wxTRANSPARENT_PEN);
+	dc.SetBrush(wxBrush(wxColour(20, 20, 20)));
+	dc.DrawRectangle(x, y, w, h);
+
+	dc.SetBrush(wxBrush(wxColour(60, 140, 30)));
+	dc.DrawRectangle(x, y + h - peakH, w, peakH);
+
+	dc.SetBrush(wxBrush(wxColour(107, 216, 37)));
+	dc.DrawRectangle(x, y + h - rmsH, w, rmsH);
+
+	if (holdY >= y) {
+		dc.SetPen(wxPen(wxColour(228, 228, 228), 1));
+		dc.DrawLine(x, holdY, x + w, holdY);
+	}
+
+	// Clip indicator, stays lit until clicked
+	dc.SetPen(*wxTRANSPARENT_PEN);
+	dc.SetBrush(master.IsClipped(channel) ? *wxRED_BRUSH : wxBrush(wxColour(60, 0, 0)));
+	dc.DrawRectangle(x, y - 10, w, 6);
+}
+
+void MeterFrame::OnPaintMeters(wxPaintEvent& WXUNUSED(event)) {
+	wxAutoBufferedPaintDC dc(meterPanel);
+
+	wxSize size = meterPanel->GetClientSize();
+	int w = size.GetWidth();
+	int h = size.GetHeight();
+
+	dc.SetBrush(wxBrush(wxColour(0x40, 0x40, 0x40)));
+	dc.SetPen(*wxTRANSPARENT_PEN);
+	dc.DrawRectangle(0, 0, w, h);
+
+	int top = 14;
+	int bottom = 18;
+	int meterH = h - top - bottom;
+	if (meterH <= 0)
+		return;
+
+	DrawMeter(dc, 40, top, 30, meterH, 0);
+	DrawMeter(dc, 80, top, 30, meterH, 1);
+
+	// dB scale
+	dc.SetTextForeground(wxColour(228, 228, 228));
+	for (int db=0; db>=METER_MIN_DB; db-=12) {
+		int ty = top + (int)(meterH * (-db) / -METER_MIN_DB);
+		dc.DrawText(wxString::Format("%d", db), 5, ty - 6);
+	}
+
+	dc.DrawText(_("L"), 50, h - bottom + 2);
+	dc.DrawText(_("R"), 90, h - bottom + 2);
+}
+
+MeterTimer::MeterTimer(MeterFrame* pane) : wxTimer() {
+	MeterTimer::pane = pane;
+}
+
+void MeterTimer::Notify() {
+	pane->Update();
+}
@@ -24,41 +24,51 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "oamlCommon.h"
+#include "oamlCore.h"
 
 
-static std::string absPath = "";
+// Swapped as a whole when a project is loaded, never changed in place
+static std::shared_ptr<FileContext> projectFiles;
 
 static void* oamlOpen(const char *filename) {
-	std::string fullpath(absPath + filename);
-	return fopen(fullpath.c_str(), "rb");
-}
+	std::shared_ptr<FileContext> context = GetProjectFiles();
+	if (!context)
+		return NULL;
 
-static size_t oamlRead(void *ptr, size_t size, size_t nitems, void *fd) {
-	return fread(ptr, size, nitems, (FILE*)fd);
+	return context->Open(filename);
 }
 
-static int oamlSeek(void *fd, long offset, int whence) {
-	return fseek((FILE*)fd, offset, whence);
-}
 
-static long oamlTell(void *fd) {
-	return ftell((FILE*)fd);
-}
+oamlFileCallbacks studioCbs = {
+	&oamlOpen,
+	&FileContext::Read,
+	&FileContext::Seek,
+	&FileContext::Tell,
+	&FileContext::Close
+};
 
-static int oamlClose(void *fd) {
-	return fclose((FILE*)fd);
+void SetProjectFiles(const std::string& root) {
+	std::atomic_store(&projectFiles, FileContext::Create(root));
 }
 
+std::shared_ptr<FileContext> GetProjectFiles() {
+	std::shared_ptr<FileContext> context = std::atomic_load(&projectFiles);
+	if (!context) {
+		// Nothing loaded yet, paths are relative to the working directory
+		std::shared_ptr<FileContext> empty;
+		context = FileContext::Create("");
+		if (!std::atomic_compare_exchange_strong(&projectFiles, &empty, context)) {
+			context = empty;
+		}
+	}
+	return context;
+}
 
-oamlFileCallbacks studioCbs = {
-	&oamlOpen,
-	&oamlRead,
-	&oamlSeek,
-	&oamlTell,
-	&oamlClose
-};
+std::shared_ptr<FileContext> CreateProjectFiles(size_t readAhead) {
+	std::shared_ptr<FileContext> project = GetProjectFiles();
+	std::shared_ptr<FileContext> context = FileContext::Create(project ? project->GetRoot() : "", readAhead);
+	if (!context)
+		return project;
 
-void InitCallbacks(std::string prjPath) {
-	absPath = prjPath;
+	return context;
 }
@@ -52,23 +52,75 @@ oamlApi *oaml;
 oamlStudioApi *studioApi;
 std::string projectPath = "";
 
+static uint64_t startNs;
+double startupMs = 0;
+
 bool oamlStudio::OnInit() {
+	TRACE_SCOPE("oamlStudio::OnInit");
 	oaml = new oamlApi();
 	studioApi = oaml->GetStudioApi();
 	printf("Initializing OAML v%s\n", oaml->GetVersion());
-	oaml->InitAudioDevice();
 	oaml->SetFileCallbacks(&studioCbs);
 
+	studioAudio = new StudioAudio(oaml);
+
 	StudioFrame *frame = new StudioFrame(_("oamlStudio"), wxPoint(0, 0), wxSize(1024, 768), wxDEFAULT_FRAME_STYLE | wxMAXIMIZE);
 	frame->Show(true);
 	SetTopWindow(frame);
+
+	// Device settings picked in the settings panel, opened while the
+	// startup window is up
+	long sampleRate = 44100;
+	long bufferFrames = 1024;
+	frame->GetConfig()->Read("AudioSampleRate", &sampleRate, 44100);
+	frame->GetConfig()->Read("AudioBufferFrames", &bufferFrames, 1024);
+	studioAudio->OpenAsync(sampleRate, 2, bufferFrames);
+
+	CallAfter(&oamlStudio::OnStartupDone);
 	return true;
 }
 
+// Runs once the events queued while the windows were created are handled,
+// that's when the startup window can be used
+void oamlStudio::OnStartupDone() {
+	uint64_t now = TraceNowNs();
+	startupMs = (now - startNs) / 1000000.0;
+	printf("Startup window ready in %.0f ms\n", startupMs);
+
+	if (TraceIsRecording()) {
+		TraceRecord("startup", startNs, now);
+	}
+}
+
+int oamlStudio::OnExit() {
+	if (studioAudio) {
+		delete studioAudio;
+		studioAudio = NULL;
+	}
+
+	return wxApp::OnExit();
+}
+
 int main(int argc, char** argv) {
-	oamlStudio* app = new oamlStudio();
-	wxApp::SetInstance(app);
-	return wxEntry(argc, argv);
+	startNs = TraceNowNs();
+	TraceSetThreadName("main");
+
+	std::string traceFile = CliStartTrace(argc, argv);
+
+	int ret;
+
+	// Headless modes never touch wx. The GUI has no console on Windows,
+	// use oamlStudio-cli there.
+	if (CliIsCommand(argc, argv)) {
+		ret = CliMain(argc, argv);
+	} else {
+		oamlStudio* app = new oamlStudio();
+		wxApp::SetInstance(app);
+		ret = wxEntry(argc, argv);
+	}
+
+	CliStopTrace(traceFile);
+	return ret;
 }
 
 #ifdef _MSC_VER
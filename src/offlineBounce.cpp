@@ -0,0 +1,173 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+#include "oamlCore.h"
+
+
+OfflineBounce::OfflineBounce(std::string _defsFile, int _sampleRate, int _channels, int _format) : cancelled(false), finished(false), framesDone(0) {
+	defsFile = _defsFile;
+	fileContext = GetProjectFiles();
+	sampleRate = _sampleRate;
+	channels = _channels;
+	format = _format;
+	framesTotal = 0;
+}
+
+void OfflineBounce::AddJob(std::string trackName, std::string outFile, double seconds, const CondTimeline& timeline) {
+	bounceJob job;
+	job.trackName = trackName;
+	job.outFile = outFile;
+	job.seconds = seconds;
+	job.timeline = timeline;
+	job.result = -1;
+	jobs.push_back(job);
+
+	framesTotal+= (long long)(seconds * sampleRate);
+}
+
+void OfflineBounce::RenderJob(bounceJob& job) {
+	long long totalFrames = (long long)(job.seconds * sampleRate);
+
+	oamlApi *api = new oamlApi();
+	api->SetFileCallbacks(fileContext->GetCallbacks());
+	if (api->Init(defsFile.c_str()) != OAML_OK) {
+		job.error = "error loading " + defsFile;
+		framesDone+= totalFrames;
+		delete api;
+		return;
+	}
+
+	api->SetAudioFormat(sampleRate, channels, 2);
+	if (api->PlayTrack(job.trackName.c_str()) != OAML_OK) {
+		job.error = "error playing track " + job.trackName;
+		framesDone+= totalFrames;
+		api->Shutdown();
+		delete api;
+		return;
+	}
+
+	// Written as it's mixed, a long bounce never sits in memory
+	wavWriter output;
+	if (output.Open(job.outFile.c_str(), channels, sampleRate, format) == -1) {
+		job.error = "error creating " + job.outFile;
+		framesDone+= totalFrames;
+		api->Shutdown();
+		delete api;
+		return;
+	}
+
+	int16_t block[BOUNCE_BLOCK_FRAMES * 8];
+	long long frames = 0;
+
+	job.timeline.Rewind();
+	while (frames < totalFrames && cancelled == false) {
+		condEvent ev;
+		double time = (double)frames / sampleRate;
+		while (job.timeline.PopDue(time, ev)) {
+			api->SetCondition(ev.condId, ev.condValue);
+		}
+
+		int count = BOUNCE_BLOCK_FRAMES;
+		if (totalFrames - frames < count) {
+			count = (int)(totalFrames - frames);
+		}
+
+		memset(block, 0, sizeof(block));
+		api->MixToBuffer(block, count * channels);
+		api->Update();
+
+		if (output.WriteInt16(block, count * channels) == -1) {
+			job.error = "error writing " + job.outFile;
+			break;
+		}
+		frames+= count;
+		framesDone+= count;
+	}
+
+	api->Shutdown();
+	delete api;
+
+	if (output.Close() == -1 && job.error == "") {
+		job.error = "error writing " + job.outFile;
+	}
+
+	if (cancelled) {
+		job.error = "cancelled";
+		remove(job.outFile.c_str());
+		return;
+	}
+
+	if (job.error == "") {
+		job.result = 0;
+	}
+}
+
+void OfflineBounce::Worker(std::atomic<int> *index) {
+	for (;;) {
+		int n = (*index)++;
+		if (n >= (int)jobs.size())
+			break;
+
+		RenderJob(jobs[n]);
+	}
+}
+
+int OfflineBounce::Run(int threads) {
+	finished = false;
+
+	if (threads <= 0) {
+		threads = (int)std::thread::hardware_concurrency();
+		if (threads <= 0) threads = 1;
+	}
+	if (threads > (int)jobs.size()) {
+		threads = (int)jobs.size();
+	}
+
+	std::atomic<int> index(0);
+	std::vector<std::thread> workers;
+	for (int i=0; i<threads; i++) {
+		workers.push_back(std::thread(&OfflineBounce::Worker, this, &index));
+	}
+
+	for (std::vector<std::thread>::iterator it=workers.begin(); it<workers.end(); ++it) {
+		it->join();
+	}
+
+	int failed = 0;
+	for (std::vector<bounceJob>::iterator it=jobs.begin(); it<jobs.end(); ++it) {
+		if (it->result != 0) failed++;
+	}
+
+	finished = true;
+	return failed;
+}
+
+float OfflineBounce::GetProgress() const {
+	if (framesTotal <= 0)
+		return 1.0f;
+	return (float)framesDone / framesTotal;
+}
@@ -23,11 +23,24 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 
 #include "vorbis/codec.h"
 #include "vorbis/vorbisfile.h"
 
-#include "oamlCommon.h"
+#include "oamlCore.h"
+
+// How far a seek decodes its way forward instead of jumping
+#define OGG_SEEK_SPAN_MS	250
+// Jumps tried before leaving it to vorbisfile's own bisection
+#define OGG_SEEK_PROBES		8
+#define OGG_SEEK_TABLE_MAX	4096
+
+// The first page is the identification header alone, the last page is
+// rarely bigger than the tail read first, never bigger than the max
+#define OGG_PROBE_HEAD		512
+#define OGG_PROBE_TAIL		8192
+#define OGG_PROBE_TAIL_MAX	(27 + 255 + 255*255)
 
 
 static size_t oggFile_read(void *ptr, size_t size, size_t nmemb, void *datasource) {
@@ -82,6 +95,126 @@ int oggFile::Open(const char *filename) {
 		return -1;
 	}
 
+	// Anything the probe doesn't understand gets the full open right away
+	if (Probe() == -1) {
+		fcbs->seek(fd, 0, SEEK_SET);
+		if (OpenDecoder() == -1) {
+			printf("Error opening '%s'\n", filename);
+			Close();
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static uint32_t ReadLE32(const uint8_t *ptr) {
+	return ptr[0] | (ptr[1] << 8) | (ptr[2] << 16) | ((uint32_t)ptr[3] << 24);
+}
+
+static int64_t ReadLE64(const uint8_t *ptr) {
+	return (int64_t)(ReadLE32(ptr) | ((uint64_t)ReadLE32(ptr + 4) << 32));
+}
+
+// Size of the page at pos when a whole one starts there, 0 otherwise
+static int PageSize(const uint8_t *buf, int len, int pos) {
+	if (pos + 27 > len || memcmp(buf + pos, "OggS", 4) != 0 || buf[pos+4] != 0)
+		return 0;
+
+	int segments = buf[pos+26];
+	if (pos + 27 + segments > len)
+		return 0;
+
+	int size = 27 + segments;
+	for (int i=0; i<segments; i++) {
+		size+= buf[pos+27+i];
+	}
+	return pos + size <= len ? size : 0;
+}
+
+// Walks back from the end of the file to the last page that ends a packet,
+// its granule position is the frame count. Returns -1 when the tail isn't
+// whole pages of the stream or has none that ends a packet.
+static int64_t LastGranule(const uint8_t *buf, int len, uint32_t serial) {
+	int end = len;
+	for (int pos=len-27; pos>=0; pos--) {
+		int size = PageSize(buf, len, pos);
+		if (size == 0 || pos + size != end)
+			continue;
+
+		// Another logical stream, chained or multiplexed
+		if (ReadLE32(buf + pos + 14) != serial)
+			return -1;
+
+		int64_t granule = ReadLE64(buf + pos + 6);
+		if (granule != -1)
+			return granule;
+
+		end = pos;
+	}
+
+	return -1;
+}
+
+// Channels, rate and length from the identification header on the first
+// page and the granule position of the last one, two small reads instead
+// of vorbisfile's scan of the whole stream.
+int oggFile::Probe() {
+	uint8_t head[OGG_PROBE_HEAD];
+	int len = (int)fcbs->read(head, 1, sizeof(head), fd);
+
+	// The first page holds the identification header and nothing else
+	int size = PageSize(head, len, 0);
+	if (size == 0 || (head[5] & 0x02) == 0)
+		return -1;
+
+	int p = 27 + head[26];
+	if (p + 16 > size || head[p] != 1 || memcmp(head + p + 1, "vorbis", 6) != 0 || ReadLE32(head + p + 7) != 0)
+		return -1;
+
+	uint32_t serial = ReadLE32(head + 14);
+	int probeChannels = head[p+11];
+	int probeRate = (int)ReadLE32(head + p + 12);
+	if (probeChannels == 0 || probeRate <= 0)
+		return -1;
+
+	if (fcbs->seek(fd, 0, SEEK_END) != 0)
+		return -1;
+
+	long fileSize = fcbs->tell(fd);
+
+	// Most last pages are small, only look further when this one isn't
+	int64_t granule = -1;
+	long want = OGG_PROBE_TAIL;
+	std::vector<uint8_t> tail;
+	for (;;) {
+		if (want > fileSize) want = fileSize;
+
+		tail.resize(want);
+		if (fcbs->seek(fd, fileSize - want, SEEK_SET) != 0 || fcbs->read(&tail[0], 1, want, fd) != (size_t)want)
+			return -1;
+
+		granule = LastGranule(&tail[0], (int)want, serial);
+		if (granule != -1 || want == fileSize || want == OGG_PROBE_TAIL_MAX)
+			break;
+
+		want = OGG_PROBE_TAIL_MAX;
+	}
+
+	if (granule < 0)
+		return -1;
+
+	channels = probeChannels;
+	samplesPerSec = probeRate;
+	bitsPerSample = 16;
+	totalSamples = (int)granule * channels;
+	return 0;
+}
+
+int oggFile::OpenDecoder() {
+	if (fd == NULL)
+		return -1;
+
 	OggVorbis_File *ovf = new OggVorbis_File;
 
 	ov_callbacks ogg_callbacks = {
@@ -91,17 +224,22 @@ int oggFile::Open(const char *filename) {
 		oggFile_tell
 	};
 
+	fcbs->seek(fd, 0, SEEK_SET);
 	if (ov_open_callbacks((void*)this, ovf, NULL, 0, ogg_callbacks) < 0) {
-		printf("Error opening '%s'\n", filename);
+		delete ovf;
 		return -1;
 	}
 
 	vorbis_info *vi = ov_info(ovf, -1);
 	if (vi == NULL) {
-		printf("Error reading info '%s'\n", filename);
+		printf("Error reading vorbis info\n");
+		ov_clear(ovf);
+		delete ovf;
+		fd = NULL;
 		return -1;
 	}
 
+	// Exact now, the probe only knew the last granule position
 	channels = vi->channels;
 	samplesPerSec = vi->rate;
 	bitsPerSample = 16;
@@ -113,7 +251,7 @@ int oggFile::Open(const char *filename) {
 }
 
 int oggFile::Read(char *buffer, int size) {
-	if (vf == NULL)
+	if (vf == NULL && OpenDecoder() == -1)
 		return -1;
 
 	OggVorbis_File *ovf = (OggVorbis_File *)vf;
@@ -121,14 +259,118 @@ int oggFile::Read(char *buffer, int size) {
 	return ov_read(ovf, buffer, size, 0, 2, 1, &currentSection);
 }
 
+static bool SeekPointBefore(int64_t frame, const oggSeekPoint& point) {
+	return frame < point.frame;
+}
+
+void oggFile::AddSeekPoint(const oggSeekPoint& point) {
+	std::vector<oggSeekPoint>::iterator it = std::upper_bound(seekTable.begin(), seekTable.end(), point.frame, SeekPointBefore);
+	if (it != seekTable.begin() && (it-1)->frame == point.frame)
+		return;
+
+	if (seekTable.size() < OGG_SEEK_TABLE_MAX) {
+		seekTable.insert(it, point);
+	}
+}
+
+int oggFile::SkipFrames(int64_t frames) {
+	OggVorbis_File *ovf = (OggVorbis_File *)vf;
+	int frameBytes = GetFrameBytes();
+
+	char buf[4096];
+	while (frames > 0) {
+		int size = frames * frameBytes < (int64_t)sizeof(buf) ? (int)(frames * frameBytes) : (int)sizeof(buf);
+		long ret = ov_read(ovf, buf, size, 0, 2, 1, &currentSection);
+		if (ret <= 0)
+			return -1;
+
+		frames-= ret / frameBytes;
+	}
+
+	return 0;
+}
+
+int oggFile::SeekFrame(int64_t frame) {
+	if (vf == NULL && OpenDecoder() == -1)
+		return -1;
+
+	OggVorbis_File *ovf = (OggVorbis_File *)vf;
+	int64_t total = ov_pcm_total(ovf, -1);
+	if (frame < 0 || frame > total)
+		return -1;
+
+	// Close enough ahead to decode the rest of the way
+	int64_t span = (int64_t)samplesPerSec * OGG_SEEK_SPAN_MS / 1000;
+	int64_t now = ov_pcm_tell(ovf);
+	if (frame >= now && frame - now <= span)
+		return SkipFrames(frame - now);
+
+	// Bracket the frame between the pages we know of and interpolate the
+	// offset, every page landed on is kept so the next seek nearby is a
+	// single jump
+	oggSeekPoint low = { 0, 0 };
+	oggSeekPoint high = { total, ov_raw_total(ovf, -1) };
+
+	std::vector<oggSeekPoint>::iterator it = std::upper_bound(seekTable.begin(), seekTable.end(), frame, SeekPointBefore);
+	if (it != seekTable.end()) high = *it;
+	if (it != seekTable.begin()) low = *(it-1);
+
+	for (int probe=0; probe<OGG_SEEK_PROBES; probe++) {
+		if (frame - low.frame <= span) {
+			// The start of the file is no page, vorbisfile is quick there anyway
+			if (low.offset == 0 || ov_raw_seek(ovf, low.offset) != 0)
+				break;
+
+			int64_t at = ov_pcm_tell(ovf);
+			if (at > frame)
+				break;
+
+			return SkipFrames(frame - at);
+		}
+
+		int64_t offset = low.offset + (int64_t)((double)(frame - low.frame) / (high.frame - low.frame) * (high.offset - low.offset));
+		if (offset <= low.offset || offset >= high.offset)
+			break;
+
+		if (ov_raw_seek(ovf, offset) != 0)
+			break;
+
+		oggSeekPoint point = { ov_pcm_tell(ovf), offset };
+		AddSeekPoint(point);
+
+		if (point.frame > frame) {
+			high = point;
+		} else if (frame - point.frame <= span) {
+			return SkipFrames(frame - point.frame);
+		} else if (point.frame == low.frame) {
+			break;
+		} else {
+			low = point;
+		}
+	}
+
+	// The table couldn't narrow it down, let vorbisfile bisect
+	if (ov_pcm_seek(ovf, frame) != 0)
+		return -1;
+
+	return 0;
+}
+
 void oggFile::WriteToFile(const char *, ByteBuffer *, int, unsigned int, int) {
 }
 
 void oggFile::Close() {
 	if (vf != NULL) {
+		// Closes fd through oggFile_close
 		OggVorbis_File *ovf = (OggVorbis_File *)vf;
 		ov_clear(ovf);
 		delete ovf;
 		vf = NULL;
+
+		seekTable.clear();
+	} else if (fd != NULL) {
+		fcbs->close(fd);
 	}
+
+	fd = NULL;
 }
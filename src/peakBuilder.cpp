@@ -0,0 +1,186 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "oamlCore.h"
+
+
+PeakBuilder::PeakBuilder() : mem(MEM_PEAKS) {
+	Reset(AF_FORMAT_SINT16, 2, 1);
+}
+
+void PeakBuilder::Reset(int _format, int _bytesPerSample, int _samplesPerPixel) {
+	format = _format;
+	bytesPerSample = _bytesPerSample;
+	samplesPerPixel = _samplesPerPixel;
+
+	peakl = 0;
+	peakr = 0;
+	count = 0;
+
+	pending.clear();
+	peaksL.clear();
+	peaksR.clear();
+	UpdateMemory();
+}
+
+// Capacity is what's held, clear() keeps it
+void PeakBuilder::UpdateMemory() {
+	mem.Set((int64_t)(peaksL.capacity() + peaksR.capacity()) * sizeof(int) + pending.capacity());
+}
+
+int PeakBuilder::Read32(const uint8_t *ptr) const {
+	int ret = 0;
+
+	switch (format) {
+		case AF_FORMAT_SINT8:
+			ret|= ((unsigned int)ptr[0])<<23;
+			break;
+
+		case AF_FORMAT_SINT16:
+			{ uint16_t value;
+			memcpy(&value, ptr, sizeof(value));
+			ret|= ((unsigned int)value)<<16;
+			} break;
+
+		case AF_FORMAT_SINT24:
+			ret|= ((unsigned int)ptr[0])<<8;
+			ret|= ((unsigned int)ptr[1])<<16;
+			ret|= ((unsigned int)ptr[2])<<24;
+			break;
+
+		case AF_FORMAT_SINT32:
+			{ uint32_t value;
+			memcpy(&value, ptr, sizeof(value));
+			ret|= value;
+			} break;
+
+		case AF_FORMAT_FLOAT32:
+			{ float value;
+			memcpy(&value, ptr, sizeof(value));
+			ret|= ((int)(value * 8388608) & 0x00ffffff);
+			} break;
+	}
+
+	return ret;
+}
+
+void PeakBuilder::AddFrame(const uint8_t *ptr) {
+	int sl = abs(Read32(ptr) >> 16);
+	int sr = abs(Read32(ptr + bytesPerSample) >> 16);
+
+	if (sl > peakl) peakl = sl;
+	if (sr > peakr) peakr = sr;
+	count++;
+
+	if (count > samplesPerPixel) {
+		peaksL.push_back(peakl);
+		peaksR.push_back(peakr);
+
+		peakl = 0;
+		peakr = 0;
+		count = 0;
+	}
+}
+
+void PeakBuilder::Feed(const uint8_t *data, int size) {
+	int frameBytes = bytesPerSample * 2;
+	if (frameBytes <= 0)
+		return;
+
+	// Complete the frame left over by the previous chunk
+	if (pending.size() > 0) {
+		int need = frameBytes - (int)pending.size();
+		int n = size < need ? size : need;
+		pending.insert(pending.end(), data, data + n);
+		data+= n;
+		size-= n;
+
+		if ((int)pending.size() < frameBytes)
+			return;
+
+		AddFrame(&pending[0]);
+		pending.clear();
+	}
+
+	while (size >= frameBytes) {
+		AddFrame(data);
+		data+= frameBytes;
+		size-= frameBytes;
+	}
+
+	if (size > 0) {
+		pending.assign(data, data + size);
+	}
+}
+
+bool PeakBuilder::Decode(audioFile *handle, int bytes) {
+	TRACE_SCOPE("PeakBuilder::Decode");
+	char buf[4096];
+
+	while (bytes > 0) {
+		int toRead = bytes > (int)sizeof(buf) ? (int)sizeof(buf) : bytes;
+		int bytesRead = handle->Read(buf, toRead);
+		if (bytesRead <= 0) {
+			UpdateMemory();
+			return true;
+		}
+
+		Feed((uint8_t*)buf, bytesRead);
+		bytes-= bytesRead;
+	}
+
+	UpdateMemory();
+	return false;
+}
+
+int PeakBuilder::GetSamplesPerPixel(audioFile *handle, bool sfxMode, int *width) {
+	int channels = handle->GetChannels() > 0 ? handle->GetChannels() : 1;
+	int frames = handle->GetTotalSamples() / channels;
+	int samplesDiv;
+
+	if (sfxMode) {
+		samplesDiv = 1000;
+	} else {
+		unsigned int totalSecs = handle->GetSamplesPerSec() > 0 ? frames / handle->GetSamplesPerSec() : 0;
+		if (totalSecs < 10) {
+			samplesDiv = 20;
+		} else {
+			samplesDiv = 10;
+		}
+	}
+
+	int framesPerPixel = handle->GetSamplesPerSec() / samplesDiv;
+	if (framesPerPixel < 1) framesPerPixel = 1;
+
+	int w = frames / framesPerPixel;
+	if (w < 1) w = 1;
+
+	if (width) {
+		*width = w;
+	}
+
+	return frames / w;
+}
@@ -0,0 +1,77 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "oamlCore.h"
+
+
+PeakCache peakCache;
+
+bool PeakCache::Has(std::string filename, int samplesPerPixel) {
+	std::lock_guard<std::mutex> lock(mutex);
+	return entries.find(std::make_pair(filename, samplesPerPixel)) != entries.end();
+}
+
+bool PeakCache::Get(std::string filename, int samplesPerPixel, std::vector<int>& peaksL, std::vector<int>& peaksR) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	std::map<std::pair<std::string, int>, peakCacheEntry>::iterator it = entries.find(std::make_pair(filename, samplesPerPixel));
+	if (it == entries.end())
+		return false;
+
+	peaksL = it->second.peaksL;
+	peaksR = it->second.peaksR;
+	return true;
+}
+
+static int64_t PeakCacheEntryBytes(const peakCacheEntry& entry) {
+	return (int64_t)(entry.peaksL.capacity() + entry.peaksR.capacity()) * sizeof(int);
+}
+
+void PeakCache::Put(std::string filename, int samplesPerPixel, const std::vector<int>& peaksL, const std::vector<int>& peaksR) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	std::pair<std::string, int> key = std::make_pair(filename, samplesPerPixel);
+	if (entries.find(key) == entries.end()) {
+		MemAddObjects(MEM_PEAK_CACHE, "peakCacheEntry", 1);
+	}
+
+	peakCacheEntry& entry = entries[key];
+	int64_t before = PeakCacheEntryBytes(entry);
+	entry.peaksL = peaksL;
+	entry.peaksR = peaksR;
+	MemCharge(MEM_PEAK_CACHE, filename, PeakCacheEntryBytes(entry) - before);
+}
+
+void PeakCache::Clear() {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	std::map<std::pair<std::string, int>, peakCacheEntry>::iterator it;
+	for (it=entries.begin(); it!=entries.end(); ++it) {
+		MemCharge(MEM_PEAK_CACHE, it->first.first, -PeakCacheEntryBytes(it->second));
+	}
+	MemAddObjects(MEM_PEAK_CACHE, "peakCacheEntry", -(int)entries.size());
+	entries.clear();
+}
@@ -24,7 +24,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 #include <wx/mstream.h>
+#include <wx/dcbuffer.h>
 
 #include "oamlCommon.h"
 #include "resources.h"
@@ -73,11 +75,35 @@ PlaybackFrame::PlaybackFrame(wxWindow *parent, wxWindowID id) : wxFrame(parent,
 
 	hSizer = new wxBoxSizer(wxHORIZONTAL);
 
-	infoText = new wxTextCtrl(this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize(-1, -1), wxTE_READONLY | wxTE_MULTILINE);
-	infoText->SetMinSize(wxSize(320, 80));
-	hSizer->Add(infoText, 1, wxEXPAND | wxGROW | wxALL, 5);
+	statusText = new wxStaticText(this, wxID_ANY, _("Stopped"));
+	hSizer->Add(statusText, 0, wxALL, 5);
 
-	mSizer->Add(hSizer, 1, wxEXPAND | wxGROW | wxALL);
+	condText = new wxStaticText(this, wxID_ANY, wxEmptyString);
+	hSizer->Add(condText, 0, wxALL, 5);
+
+	mSizer->Add(hSizer, 0, wxALL);
+
+	// A fixed set of labels, only the ones whose text changes get touched
+	wxFlexGridSizer *rowSizer = new wxFlexGridSizer(2, 2, 10);
+	rowSizer->AddGrowableCol(1);
+	for (int i=0; i<PLAYBACK_STATE_ROWS; i++) {
+		rowNames[i] = new wxStaticText(this, wxID_ANY, wxEmptyString);
+		rowSizer->Add(rowNames[i], 0, wxALL, 0);
+
+		rowDetails[i] = new wxStaticText(this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, wxST_NO_AUTORESIZE | wxST_ELLIPSIZE_END);
+		rowDetails[i]->SetMinSize(wxSize(240, -1));
+		rowSizer->Add(rowDetails[i], 1, wxEXPAND | wxALL, 0);
+	}
+
+	mSizer->Add(rowSizer, 1, wxEXPAND | wxGROW | wxALL, 5);
+
+	latencyText = new wxStaticText(this, wxID_ANY, wxEmptyString);
+	mSizer->Add(latencyText, 0, wxEXPAND | wxALL, 5);
+
+	latencyPanel = new wxPanel(this, wxID_ANY, wxDefaultPosition, wxSize(320, 60));
+	latencyPanel->SetBackgroundStyle(wxBG_STYLE_PAINT);
+	latencyPanel->Bind(wxEVT_PAINT, &PlaybackFrame::OnPaintLatency, this);
+	mSizer->Add(latencyPanel, 0, wxEXPAND | wxALL, 5);
 
 	Bind(wxEVT_CLOSE_WINDOW, &PlaybackFrame::OnClose, this);
 
@@ -90,8 +116,17 @@ PlaybackFrame::PlaybackFrame(wxWindow *parent, wxWindowID id) : wxFrame(parent,
 	int posY = (rect.GetY() + rect.GetHeight()) - size.GetHeight() - 20;
 	SetPosition(wxPoint(posX, posY));
 
+	PlaybackStateClear(shown);
+	condSet = 0;
+	condId = 0;
+	condValue = 0;
+	idleTicks = 0;
+	updatesEnabled = true;
+	worstCaseMs = 0;
+	playingAudioStart = 0;
+
+	// Nothing to show until something plays, Wake() starts the timer
 	timer = new PlaybackTimer(this);
-	timer->Start(10);
 }
 
 PlaybackFrame::~PlaybackFrame() {
@@ -106,8 +141,12 @@ void PlaybackFrame::OnClose(wxCloseEvent& event) {
 }
 
 void PlaybackFrame::OnPlay(wxCommandEvent& WXUNUSED(event)) {
+	if (updatesEnabled == false)
+		return;
+
 	if (oaml->IsPaused()) {
 		oaml->Resume();
+		Wake();
 	} else {
 		wxCommandEvent event(EVENT_PLAY);
 		wxPostEvent(GetParent(), event);
@@ -115,10 +154,17 @@ void PlaybackFrame::OnPlay(wxCommandEvent& WXUNUSED(event)) {
 }
 
 void PlaybackFrame::OnPause(wxCommandEvent& WXUNUSED(event)) {
+	if (updatesEnabled == false)
+		return;
+
 	oaml->PauseToggle();
+	Wake();
 }
 
 void PlaybackFrame::OnCondition(wxCommandEvent& WXUNUSED(event)) {
+	if (updatesEnabled == false)
+		return;
+
 	wxString condIdStr = condIdCtrl->GetLineText(0);
 	wxString condValueStr = condValueCtrl->GetLineText(0);
 	long condId = 0;
@@ -128,11 +174,215 @@ void PlaybackFrame::OnCondition(wxCommandEvent& WXUNUSED(event)) {
 	condValueStr.ToLong(&condValue);
 
 	oaml->SetCondition(condId, condValue);
+	latency.OnSetCondition(PlaybackNowMs(), playingTrack, playingAudio, condId, condValue);
+
+	PlaybackFrame::condSet = 1;
+	PlaybackFrame::condId = condId;
+	PlaybackFrame::condValue = condValue;
+	Wake();
+}
+
+void PlaybackFrame::EnableUpdates(bool enable) {
+	// oaml can't be queried while a project is being loaded on another thread
+	updatesEnabled = enable;
+	playBtn->Enable(enable);
+	pauseBtn->Enable(enable);
+	condIdCtrl->Enable(enable);
+	condValueCtrl->Enable(enable);
+	condBtn->Enable(enable);
+	if (enable) {
+		Wake();
+	} else {
+		timer->Stop();
+	}
+}
+
+void PlaybackFrame::Wake() {
+	if (updatesEnabled == false)
+		return;
+
+	idleTicks = 0;
+	SetRate(PLAYBACK_FAST_RATE);
+}
+
+void PlaybackFrame::SetPlayingTrack(std::string trackName) {
+	playingTrack = trackName;
+	playingAudio = "";
+	playingAudioStart = 0;
+	trackInfo = oamlTrackInfo();
+	trackAudios.clear();
+	audiosPlaying.clear();
+	worstCaseMs = 0;
+	latency.CancelPending();
+
+	// Only done when playback starts, GetTracksInfo() walks the whole project
+	oamlTracksInfo *info = oaml->GetTracksInfo();
+	for (std::vector<oamlTrackInfo>::iterator track=info->tracks.begin(); track<info->tracks.end(); ++track) {
+		if (track->name != trackName)
+			continue;
+
+		// Kept to tell which audios a condition selects
+		trackInfo = *track;
+		for (std::vector<oamlAudioInfo>::iterator audio=track->audios.begin(); audio<track->audios.end(); ++audio) {
+			trackAudios.push_back(audio->name);
+		}
+		worstCaseMs = ConditionLatency::WorstCaseMs(*track, info->bpm, info->beatsPerBar);
+		break;
+	}
+
+	ShowLatency();
+}
+
+void PlaybackFrame::ShowLatency() {
+	wxString str;
+	const latencyHistogram *hist = latency.GetHistogram(playingTrack);
+	if (hist) {
+		str = wxString::Format(_("Switch latency: %d samples, avg %.0f ms, p95 %.0f ms, max %.0f ms (bound %.0f ms)"), hist->total, hist->sumMs / hist->total, latency.GetPercentile(playingTrack, 0.95), hist->maxMs, worstCaseMs);
+	} else if (playingTrack != "") {
+		str = wxString::Format(_("Switch latency: no samples (bound %.0f ms)"), worstCaseMs);
+	}
+
+	if (latencyText->GetLabel() != str) {
+		latencyText->SetLabel(str);
+	}
+	latencyPanel->Refresh();
+}
+
+void PlaybackFrame::OnPaintLatency(wxPaintEvent& WXUNUSED(event)) {
+	wxAutoBufferedPaintDC dc(latencyPanel);
+
+	wxSize size = latencyPanel->GetClientSize();
+	int w = size.GetWidth();
+	int h = size.GetHeight();
+
+	dc.SetBrush(wxBrush(wxColour(0x40, 0x40, 0x40)));
+	dc.SetPen(*wxTRANSPARENT_PEN);
+	dc.DrawRectangle(0, 0, w, h);
+
+	const latencyHistogram *hist = latency.GetHistogram(playingTrack);
+	if (hist == NULL)
+		return;
+
+	int maxCount = 1;
+	for (int i=0; i<=LATENCY_BUCKETS; i++) {
+		if (hist->counts[i] > maxCount) maxCount = hist->counts[i];
+	}
+
+	// Last bucket holds everything past the range
+	int barW = w / (LATENCY_BUCKETS + 1);
+	if (barW < 1) barW = 1;
+	for (int i=0; i<=LATENCY_BUCKETS; i++) {
+		if (hist->counts[i] == 0)
+			continue;
+
+		int barH = (h - 4) * hist->counts[i] / maxCount;
+		if (i == LATENCY_BUCKETS) {
+			dc.SetBrush(wxBrush(wxColour(0xE0, 0x40, 0x40)));
+		} else {
+			dc.SetBrush(wxBrush(wxColour(0x40, 0xC0, 0x40)));
+		}
+		dc.DrawRectangle(i * barW, h - barH, barW - 1, barH);
+	}
+
+	// Statically computed worst case
+	if (worstCaseMs > 0) {
+		int x = (int)(worstCaseMs / LATENCY_BUCKET_MS * barW);
+		if (x > w - 1) x = w - 1;
+		dc.SetPen(wxPen(wxColour(0xE0, 0xE0, 0x40)));
+		dc.DrawLine(x, 0, x, h);
+	}
+}
+
+void PlaybackFrame::SetRate(int interval) {
+	if (timer->IsRunning() && timer->GetInterval() == interval)
+		return;
+
+	timer->Start(interval);
+}
+
+void PlaybackFrame::ShowState(const playbackState& state) {
+	if (state.playing != shown.playing || state.paused != shown.paused) {
+		if (state.paused) {
+			statusText->SetLabel(_("Paused"));
+		} else if (state.playing) {
+			statusText->SetLabel(_("Playing"));
+		} else {
+			statusText->SetLabel(_("Stopped"));
+		}
+	}
+
+	if (state.condSet != shown.condSet || state.condId != shown.condId || state.condValue != shown.condValue) {
+		condText->SetLabel(wxString::Format(_("Condition %d = %d"), state.condId, state.condValue));
+	}
+
+	for (int i=0; i<PLAYBACK_STATE_ROWS; i++) {
+		if (strcmp(state.rows[i].name, shown.rows[i].name) != 0) {
+			rowNames[i]->SetLabel(wxString(state.rows[i].name));
+		}
+		if (strcmp(state.rows[i].detail, shown.rows[i].detail) != 0) {
+			rowDetails[i]->SetLabel(wxString(state.rows[i].detail));
+		}
+	}
+
+	shown = state;
 }
 
 void PlaybackFrame::Update() {
-	infoText->Clear();
-	*infoText << oaml->GetPlayingInfo();
+	playbackState state;
+
+	PlaybackStateClear(state);
+	state.playing = oaml->IsPlaying();
+	state.paused = oaml->IsPaused();
+	state.condSet = condSet;
+	state.condId = condId;
+	state.condValue = condValue;
+	if (state.playing) {
+		std::string info = oaml->GetPlayingInfo();
+		PlaybackStateParse(info, state);
+
+		// Longest name first, the same one PlaybackFindAudio picks
+		PlaybackFindAudios(info, trackAudios, audiosFound);
+		double now = PlaybackNowMs();
+		if (audiosFound.empty() == false && trackAudios[audiosFound[0]] != playingAudio) {
+			playingAudio = trackAudios[audiosFound[0]];
+			playingAudioStart = now;
+		}
+
+		// Only an audio that just started can be the one a condition
+		// selected, it may be fading in under the previous one
+		for (std::vector<int>::iterator it=audiosFound.begin(); it<audiosFound.end(); ++it) {
+			if (std::find(audiosPlaying.begin(), audiosPlaying.end(), *it) != audiosPlaying.end())
+				continue;
+
+			if (latency.OnAudioPlaying(now, trackInfo, trackAudios[*it])) {
+				ShowLatency();
+			}
+		}
+		audiosPlaying.swap(audiosFound);
+
+		// Lets the track panel place its playhead
+		PlaybackStateSetAudio(state, playingTrack, playingAudio, playingAudioStart);
+	} else {
+		audiosPlaying.clear();
+	}
+
+	if (PlaybackStateEqual(state, shown) == false) {
+		playbackCurrent = state;
+		ShowState(state);
+		idleTicks = 0;
+	} else {
+		idleTicks++;
+	}
+
+	// Nothing will change by itself while stopped or paused, go idle until woken up
+	if (state.playing == 0 || state.paused) {
+		latency.CancelPending();
+		timer->Stop();
+		return;
+	}
+
+	// A pending condition is timed at the fast rate until the switch happens
+	SetRate(idleTicks < PLAYBACK_IDLE_TICKS || latency.IsPending() ? PLAYBACK_FAST_RATE : PLAYBACK_SLOW_RATE);
 }
 
 PlaybackTimer::PlaybackTimer(PlaybackFrame* pane) : wxTimer() {
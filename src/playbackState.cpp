@@ -0,0 +1,156 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <chrono>
+
+#include "oamlCore.h"
+
+
+playbackState playbackCurrent;
+
+void PlaybackStateClear(playbackState& state) {
+	memset(&state, 0, sizeof(state));
+}
+
+static void CopyField(char *dst, int size, const std::string& src) {
+	int len = (int)src.size() < size - 1 ? (int)src.size() : size - 1;
+	memcpy(dst, src.c_str(), len);
+	dst[len] = 0;
+}
+
+void PlaybackStateParse(const std::string& info, playbackState& state) {
+	state.rowCount = 0;
+	memset(state.rows, 0, sizeof(state.rows));
+
+	// oaml reports one line per playing track, "name: details"
+	size_t start = 0;
+	while (start < info.size() && state.rowCount < PLAYBACK_STATE_ROWS) {
+		size_t end = info.find('\n', start);
+		if (end == std::string::npos) end = info.size();
+
+		std::string line = info.substr(start, end - start);
+		start = end + 1;
+
+		size_t first = line.find_first_not_of(" \t\r");
+		if (first == std::string::npos)
+			continue;
+		line = line.substr(first);
+
+		playbackRow& row = state.rows[state.rowCount++];
+		size_t colon = line.find(':');
+		if (colon != std::string::npos && colon < PLAYBACK_STATE_NAME) {
+			size_t detail = line.find_first_not_of(" \t", colon + 1);
+			CopyField(row.name, PLAYBACK_STATE_NAME, line.substr(0, colon));
+			CopyField(row.detail, PLAYBACK_STATE_DETAIL, detail == std::string::npos ? "" : line.substr(detail));
+		} else {
+			CopyField(row.detail, PLAYBACK_STATE_DETAIL, line);
+		}
+	}
+}
+
+void PlaybackStateSetAudio(playbackState& state, const std::string& track, const std::string& audio, double startMs) {
+	CopyField(state.track, PLAYBACK_STATE_NAME, track);
+	CopyField(state.audio, PLAYBACK_STATE_NAME, audio);
+	state.audioStartMs = startMs;
+}
+
+bool PlaybackStateEqual(const playbackState& a, const playbackState& b) {
+	return memcmp(&a, &b, sizeof(playbackState)) == 0;
+}
+
+int PlaybackFindAudio(const std::string& info, const std::vector<std::string>& names) {
+	// oaml only tells us what's playing as text, the longest name found in it wins
+	std::vector<int> found;
+	PlaybackFindAudios(info, names, found);
+	return found.empty() ? -1 : found[0];
+}
+
+static bool IsNameChar(char c) {
+	return isalnum((unsigned char)c) || c == '_' || c == '-' || c == '.';
+}
+
+void PlaybackFindAudios(const std::string& info, const std::vector<std::string>& names, std::vector<int>& found) {
+	// Every name mentioned, "intro" inside "intro2" doesn't count on its own
+	std::vector<bool> covered(info.size(), false);
+
+	// Lines start with the track name, "name: details", that's no audio
+	for (size_t start = 0; start < info.size(); ) {
+		size_t end = info.find('\n', start);
+		if (end == std::string::npos) end = info.size();
+
+		size_t colon = info.find(':', start);
+		if (colon < end && colon - start < PLAYBACK_STATE_NAME) {
+			for (size_t k=start; k<=colon; k++) {
+				covered[k] = true;
+			}
+		}
+		start = end + 1;
+	}
+	std::vector<size_t> order;
+	for (size_t i=0; i<names.size(); i++) {
+		order.push_back(i);
+	}
+
+	// Longest names claim their part of the text first
+	for (size_t i=1; i<order.size(); i++) {
+		for (size_t j=i; j>0 && names[order[j]].size() > names[order[j - 1]].size(); j--) {
+			std::swap(order[j], order[j - 1]);
+		}
+	}
+
+	// Longest first in found too
+	found.clear();
+	for (size_t i=0; i<order.size(); i++) {
+		const std::string& name = names[order[i]];
+		if (name.empty())
+			continue;
+
+		bool seen = false;
+		for (size_t pos = info.find(name); pos != std::string::npos; pos = info.find(name, pos + 1)) {
+			size_t end = pos + name.size();
+			if (covered[pos] || covered[end - 1])
+				continue;
+
+			// Whole names only
+			if ((pos > 0 && IsNameChar(info[pos - 1]) && IsNameChar(name[0])) || (end < info.size() && IsNameChar(info[end]) && IsNameChar(name[name.size() - 1])))
+				continue;
+
+			for (size_t k=pos; k<end; k++) {
+				covered[k] = true;
+			}
+			seen = true;
+		}
+
+		if (seen) {
+			found.push_back((int)order[i]);
+		}
+	}
+}
+
+double PlaybackNowMs() {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
@@ -0,0 +1,273 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "oamlCore.h"
+
+#include <archive.h>
+#include <archive_entry.h>
+
+#define EXPORT_READ_AHEAD (64*1024)
+
+
+static void AddSimpleChildToNode(tinyxml2::XMLNode *node, const char *name, const char *value) {
+	tinyxml2::XMLElement *el = node->GetDocument()->NewElement(name);
+	el->SetText(value);
+	node->InsertEndChild(el);
+}
+
+static void AddSimpleChildToNode(tinyxml2::XMLNode *node, const char *name, int value) {
+	tinyxml2::XMLElement *el = node->GetDocument()->NewElement(name);
+	el->SetText(value);
+	node->InsertEndChild(el);
+}
+
+static void AddSimpleChildToNode(tinyxml2::XMLNode *node, const char *name, float value) {
+	tinyxml2::XMLElement *el = node->GetDocument()->NewElement(name);
+	el->SetText(value);
+	node->InsertEndChild(el);
+}
+
+std::string ExportFileName(std::string path) {
+	size_t pos = path.find_last_of("/\\");
+	if (pos == std::string::npos)
+		return path;
+
+	return path.substr(pos + 1);
+}
+
+static tinyxml2::XMLNode* CreateAudioDefs(tinyxml2::XMLDocument& xmlDoc, oamlAudioInfo *audio, bool createPkg) {
+	tinyxml2::XMLNode *audioEl = xmlDoc.NewElement("audio");
+	if (audioEl == NULL)
+		return NULL;
+
+	AddSimpleChildToNode(audioEl, "name", audio->name.c_str());
+
+	for (std::vector<oamlAudioFileInfo>::iterator file=audio->files.begin(); file<audio->files.end(); ++file) {
+		tinyxml2::XMLElement *el = audioEl->GetDocument()->NewElement("filename");
+
+		if (createPkg) {
+			el->SetText(ExportFileName(file->filename).c_str());
+		} else {
+			el->SetText(file->filename.c_str());
+		}
+
+		if (file->layer != "") {
+			el->SetAttribute("layer", file->layer.c_str());
+		}
+		if (file->randomChance != -1) {
+			el->SetAttribute("randomChance", file->randomChance);
+		}
+
+		audioEl->InsertEndChild(el);
+	}
+
+	if (audio->type) AddSimpleChildToNode(audioEl, "type", audio->type);
+	if (audio->volume) AddSimpleChildToNode(audioEl, "volume", audio->volume);
+	if (audio->bpm) AddSimpleChildToNode(audioEl, "bpm", audio->bpm);
+	if (audio->beatsPerBar) AddSimpleChildToNode(audioEl, "beatsPerBar", audio->beatsPerBar);
+	if (audio->bars) AddSimpleChildToNode(audioEl, "bars", audio->bars);
+	if (audio->minMovementBars) AddSimpleChildToNode(audioEl, "minMovementBars", audio->minMovementBars);
+	if (audio->randomChance) AddSimpleChildToNode(audioEl, "randomChance", audio->randomChance);
+	if (audio->playOrder) AddSimpleChildToNode(audioEl, "playOrder", audio->playOrder);
+	if (audio->fadeIn) AddSimpleChildToNode(audioEl, "fadeIn", audio->fadeIn);
+	if (audio->fadeOut) AddSimpleChildToNode(audioEl, "fadeOut", audio->fadeOut);
+	if (audio->xfadeIn) AddSimpleChildToNode(audioEl, "xfadeIn", audio->xfadeIn);
+	if (audio->xfadeOut) AddSimpleChildToNode(audioEl, "xfadeOut", audio->xfadeOut);
+	if (audio->condId) AddSimpleChildToNode(audioEl, "condId", audio->condId);
+	if (audio->condType) AddSimpleChildToNode(audioEl, "condType", audio->condType);
+	if (audio->condValue) AddSimpleChildToNode(audioEl, "condValue", audio->condValue);
+	if (audio->condValue2) AddSimpleChildToNode(audioEl, "condValue2", audio->condValue2);
+
+	return audioEl;
+}
+
+static tinyxml2::XMLNode* CreateTrackDefs(tinyxml2::XMLDocument& xmlDoc, oamlTrackInfo *track, bool createPkg) {
+	tinyxml2::XMLNode *trackEl = xmlDoc.NewElement("track");
+	if (track->sfxTrack) {
+		trackEl->ToElement()->SetAttribute("type", "sfx");
+	} else {
+		trackEl->ToElement()->SetAttribute("type", "music");
+	}
+
+	AddSimpleChildToNode(trackEl, "name", track->name.c_str());
+
+	if (track->groups.size() > 0) {
+		for (std::vector<std::string>::iterator it=track->groups.begin(); it<track->groups.end(); ++it) {
+			AddSimpleChildToNode(trackEl, "group", it->c_str());
+		}
+	}
+	if (track->subgroups.size() > 0) {
+		for (std::vector<std::string>::iterator it=track->subgroups.begin(); it<track->subgroups.end(); ++it) {
+			AddSimpleChildToNode(trackEl, "subgroup", it->c_str());
+		}
+	}
+	if (track->volume) AddSimpleChildToNode(trackEl, "volume", track->volume);
+	if (track->fadeIn) AddSimpleChildToNode(trackEl, "fadeIn", track->fadeIn);
+	if (track->fadeOut) AddSimpleChildToNode(trackEl, "fadeOut", track->fadeOut);
+	if (track->xfadeIn) AddSimpleChildToNode(trackEl, "xfadeIn", track->xfadeIn);
+	if (track->xfadeOut) AddSimpleChildToNode(trackEl, "xfadeOut", track->xfadeOut);
+
+	for (std::vector<oamlAudioInfo>::iterator audio=track->audios.begin(); audio<track->audios.end(); ++audio) {
+		tinyxml2::XMLNode *el = CreateAudioDefs(xmlDoc, &(*audio), createPkg);
+		if (el != NULL) {
+			trackEl->InsertEndChild(el);
+		}
+	}
+
+	return trackEl;
+}
+
+void ExportCreateDefs(tinyxml2::XMLDocument& xmlDoc, oamlTracksInfo *info, bool createPkg) {
+	TRACE_SCOPE("ExportCreateDefs");
+	xmlDoc.InsertFirstChild(xmlDoc.NewDeclaration());
+
+	tinyxml2::XMLNode *prjEl = xmlDoc.NewElement("project");
+
+	if (info->bpm) AddSimpleChildToNode(prjEl, "bpm", info->bpm);
+	if (info->beatsPerBar) AddSimpleChildToNode(prjEl, "beatsPerBar", info->beatsPerBar);
+
+	for (std::vector<oamlTrackInfo>::iterator track=info->tracks.begin(); track<info->tracks.end(); ++track) {
+		tinyxml2::XMLNode *el = CreateTrackDefs(xmlDoc, &(*track), createPkg);
+		if (el != NULL) {
+			prjEl->InsertEndChild(el);
+		}
+	}
+
+	xmlDoc.InsertEndChild(prjEl);
+}
+
+static int WriteDefsToZip(struct archive *zip, oamlTracksInfo *info, std::string& error) {
+	tinyxml2::XMLDocument xmlDoc;
+	tinyxml2::XMLPrinter printer;
+
+	ExportCreateDefs(xmlDoc, info, true);
+	xmlDoc.Accept(&printer);
+	const char *buffer = printer.CStr();
+
+	MemAccount mem(MEM_EXPORT);
+	mem.Set(printer.CStrSize());
+
+	struct archive_entry *entry = archive_entry_new();
+	if (entry == NULL) {
+		error = "archive_entry_new error";
+		return -1;
+	}
+
+	archive_entry_set_pathname(entry, "oaml.defs");
+	archive_entry_set_size(entry, strlen(buffer));
+	archive_entry_set_filetype(entry, AE_IFREG);
+	archive_entry_set_perm(entry, 0644);
+	archive_write_header(zip, entry);
+	if ((size_t)archive_write_data(zip, buffer, strlen(buffer)) != strlen(buffer)) {
+		archive_entry_free(entry);
+		error = "archive_write_data error";
+		return -1;
+	}
+	archive_entry_free(entry);
+
+	return 0;
+}
+
+static int WriteFileToZip(struct archive *zip, FileContext *fileContext, std::string file, std::string& error) {
+	TRACE_SCOPE("WriteFileToZip");
+	const char *filename = file.c_str();
+	void *fd = fileContext->Open(filename);
+	if (fd == NULL) {
+		error = "Error creating file " + file;
+		return -1;
+	}
+
+	FileContext::Seek(fd, 0, SEEK_END);
+	size_t size = FileContext::Tell(fd);
+	FileContext::Seek(fd, 0, SEEK_SET);
+
+	struct archive_entry *entry = archive_entry_new();
+	if (entry == NULL) {
+		FileContext::Close(fd);
+		error = "archive_entry_new error";
+		return -1;
+	}
+
+	archive_entry_set_pathname(entry, ExportFileName(file).c_str());
+	archive_entry_set_size(entry, size);
+	archive_entry_set_filetype(entry, AE_IFREG);
+	archive_entry_set_perm(entry, 0644);
+	archive_write_header(zip, entry);
+
+	char buffer[4096];
+	while (size > 0) {
+		int bytes = FileContext::Read(buffer, 1, 4096, fd);
+		if (bytes == 0) break;
+
+		if (archive_write_data(zip, buffer, bytes) != bytes) {
+			FileContext::Close(fd);
+			archive_entry_free(entry);
+			error = "archive_write_data error";
+			return -1;
+		}
+	}
+
+	FileContext::Close(fd);
+	archive_entry_free(entry);
+
+	return 0;
+}
+
+int ExportCreateZip(std::string zfile, oamlTracksInfo *info, std::vector<std::string> files, std::string& error) {
+	TRACE_SCOPE("ExportCreateZip");
+	struct archive *zip;
+
+	zip = archive_write_new();
+	if (zip == NULL) {
+		error = "archive_write_new error";
+		return -1;
+	}
+	archive_write_set_format_zip(zip);
+//	archive_write_zip_set_compression_store(zip);
+	archive_write_open_filename(zip, zfile.c_str());
+
+	if (WriteDefsToZip(zip, info, error)) {
+		archive_write_close(zip);
+		archive_write_finish(zip);
+		return -1;
+	}
+
+	// Every file is copied whole, read them in bigger chunks than the zip writes
+	std::shared_ptr<FileContext> fileContext = CreateProjectFiles(EXPORT_READ_AHEAD);
+
+	for (size_t i=0; i<files.size(); i++) {
+		if (WriteFileToZip(zip, fileContext.get(), files[i], error)) {
+			archive_write_close(zip);
+			archive_write_finish(zip);
+			return -1;
+		}
+	}
+
+	archive_write_close(zip);
+	archive_write_finish(zip);
+
+	return 0;
+}
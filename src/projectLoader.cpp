@@ -0,0 +1,250 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <set>
+
+#include "oamlCommon.h"
+
+
+// Don't flood the frame with progress events on big projects
+#define LOAD_PROGRESS_STEP 16
+
+// Peaks read every file from start to end, so fewer larger reads pay off
+#define LOAD_READ_AHEAD (64*1024)
+
+ProjectLoader::ProjectLoader(wxEvtHandler *_sink) : cancelled(false), running(false), parsing(false) {
+	sink = _sink;
+	generation = 0;
+	memset(&progress, 0, sizeof(progress));
+}
+
+ProjectLoader::~ProjectLoader() {
+	Cancel();
+	Join();
+}
+
+void ProjectLoader::Start(std::string _defsFile) {
+	Cancel();
+	Join();
+
+	defsFile = _defsFile;
+	files.clear();
+
+	// A context of our own so a project switched meanwhile can't move the
+	// files from under us, and its stats are the loader's alone
+	fileContext = CreateProjectFiles(LOAD_READ_AHEAD);
+
+	memset(&progress, 0, sizeof(progress));
+
+	// Lets the frame drop events still queued from an earlier load
+	generation++;
+	progress.generation = generation;
+
+	cancelled = false;
+	running = true;
+	parsing = true;
+	thread = std::thread(&ProjectLoader::Run, this);
+}
+
+void ProjectLoader::Cancel() {
+	cancelled = true;
+}
+
+void ProjectLoader::Join() {
+	if (thread.joinable()) {
+		thread.join();
+	}
+}
+
+void ProjectLoader::Post(int stage, int done, int total) {
+	progress.stage = stage;
+	progress.done = done;
+	progress.total = total;
+
+	wxThreadEvent event(EVENT_LOAD_PROGRESS);
+	event.SetPayload(progress);
+	wxQueueEvent(sink, event.Clone());
+}
+
+void ProjectLoader::GatherFiles() {
+	oamlTracksInfo *info = oaml->GetTracksInfo();
+
+	std::set<std::pair<std::string, bool> > seen;
+	for (std::vector<oamlTrackInfo>::iterator track=info->tracks.begin(); track<info->tracks.end(); ++track) {
+		for (std::vector<oamlAudioInfo>::iterator audio=track->audios.begin(); audio<track->audios.end(); ++audio) {
+			for (std::vector<oamlAudioFileInfo>::iterator file=audio->files.begin(); file<audio->files.end(); ++file) {
+				if (seen.insert(std::make_pair(file->filename, track->sfxTrack)).second == false)
+					continue;
+
+				loadFile lf;
+				lf.filename = file->filename;
+				lf.sfx = track->sfxTrack;
+				lf.readable = false;
+				files.push_back(lf);
+			}
+		}
+	}
+}
+
+bool ProjectLoader::CheckFiles() {
+	TRACE_SCOPE("ProjectLoader::CheckFiles");
+	int total = (int)files.size();
+	for (int i=0; i<total; i++) {
+		if (cancelled)
+			return false;
+
+		void *fd = fileContext->Open(files[i].filename.c_str());
+		if (fd == NULL) {
+			progress.missing++;
+		} else {
+			FileContext::Close(fd);
+			files[i].readable = true;
+		}
+
+		if ((i % LOAD_PROGRESS_STEP) == 0) {
+			Post(LOAD_STAGE_CHECK_FILES, i, total);
+		}
+	}
+
+	Post(LOAD_STAGE_CHECK_FILES, total, total);
+	return true;
+}
+
+bool ProjectLoader::ProbeFiles() {
+	TRACE_SCOPE("ProjectLoader::ProbeFiles");
+	int total = (int)files.size();
+	for (int i=0; i<total; i++) {
+		if (cancelled)
+			return false;
+
+		if (files[i].readable == false)
+			continue;
+
+		audioFile *handle = CreateAudioFile(files[i].filename, fileContext->GetCallbacks());
+		if (handle == NULL || handle->Open(files[i].filename.c_str()) == -1 || handle->GetTotalSamples() == 0) {
+			files[i].readable = false;
+			progress.unreadable++;
+		} else {
+			MemSetDecodedSize(files[i].filename, (int64_t)handle->GetTotalSamples() * handle->GetBytesPerSample());
+		}
+
+		if (handle) {
+			delete handle;
+		}
+
+		if ((i % LOAD_PROGRESS_STEP) == 0) {
+			Post(LOAD_STAGE_PROBE, i, total);
+		}
+	}
+
+	Post(LOAD_STAGE_PROBE, total, total);
+	return true;
+}
+
+bool ProjectLoader::ComputePeaks() {
+	TRACE_SCOPE("ProjectLoader::ComputePeaks");
+	PeakBuilder peaks;
+
+	int total = (int)files.size();
+	for (int i=0; i<total; i++) {
+		if (cancelled)
+			return false;
+
+		if (files[i].readable == false)
+			continue;
+
+		audioFile *handle = CreateAudioFile(files[i].filename, fileContext->GetCallbacks());
+		if (handle == NULL)
+			continue;
+
+		if (handle->Open(files[i].filename.c_str()) == 0) {
+			int samplesPerPixel = PeakBuilder::GetSamplesPerPixel(handle, files[i].sfx, NULL);
+
+			// A waveform display may have beaten us to it
+			if (peakCache.Has(files[i].filename, samplesPerPixel) == false) {
+				peaks.Reset(handle->GetFormat(), handle->GetBytesPerSample(), samplesPerPixel);
+
+				bool done = false;
+				while (done == false && cancelled == false) {
+					done = peaks.Decode(handle, 65536);
+				}
+
+				if (done) {
+					peakCache.Put(files[i].filename, samplesPerPixel, peaks.GetPeaksL(), peaks.GetPeaksR());
+				}
+			}
+		}
+
+		delete handle;
+
+		Post(LOAD_STAGE_PEAKS, i + 1, total);
+	}
+
+	return cancelled == false;
+}
+
+void ProjectLoader::Run() {
+	TraceSetThreadName("project loader");
+	Post(LOAD_STAGE_PARSE, 0, 1);
+
+	oamlRC rc;
+	{
+		TRACE_SCOPE("oaml->Init");
+		rc = oaml->Init(defsFile.c_str());
+	}
+
+	if (rc != OAML_OK) {
+		parsing = false;
+		running = false;
+		Post(LOAD_STAGE_FAILED, 0, 0);
+		return;
+	}
+
+	// The frame owns the model once it's told it's ready, grab everything we need before that
+	GatherFiles();
+	parsing = false;
+
+	if (cancelled) {
+		running = false;
+		Post(LOAD_STAGE_CANCELLED, 0, 0);
+		return;
+	}
+
+	progress.modelReady = true;
+	Post(LOAD_STAGE_MODEL_READY, 1, 1);
+
+	if (CheckFiles() && ProbeFiles() && ComputePeaks()) {
+		fileStats stats;
+		fileContext->GetStats(stats);
+		TraceCounter("loader bytes read", (int64_t)stats.bytesRead);
+		TraceCounter("loader io ms", (int64_t)(stats.ioNs / 1000000));
+
+		running = false;
+		Post(LOAD_STAGE_DONE, (int)files.size(), (int)files.size());
+	} else {
+		running = false;
+		Post(LOAD_STAGE_CANCELLED, 0, 0);
+	}
+}
@@ -28,6 +28,12 @@
 #include "oamlCommon.h"
 
 
+static const int deviceRates[] = { 22050, 32000, 44100, 48000 };
+static const int deviceBuffers[] = { 256, 512, 1024, 2048, 4096 };
+
+#define DEVICE_RATES	(int)(sizeof(deviceRates) / sizeof(deviceRates[0]))
+#define DEVICE_BUFFERS	(int)(sizeof(deviceBuffers) / sizeof(deviceBuffers[0]))
+
 SettingsFrame::SettingsFrame(wxWindow *parent, wxWindowID id) : wxFrame(parent, id, _("Settings"), wxPoint(50, 50), wxSize(360, 180), wxFRAME_TOOL_WINDOW | wxFRAME_FLOAT_ON_PARENT | wxCAPTION | wxRESIZE_BORDER | wxCLOSE_BOX) {
 	mSizer = new wxBoxSizer(wxVERTICAL);
 
@@ -49,13 +55,93 @@ SettingsFrame::SettingsFrame(wxWindow *parent, wxWindowID id) : wxFrame(parent,
 
 	mSizer->Add(sizer, 1, wxEXPAND | wxALL, 0);
 
+	wxStaticBoxSizer *deviceSizer = new wxStaticBoxSizer(wxVERTICAL, this, _("Audio device"));
+	wxGridSizer *grid = new wxGridSizer(2, 0, 0);
+
+	staticText = new wxStaticText(this, wxID_ANY, wxString("Sample rate"));
+	grid->Add(staticText, 0, wxALL, 5);
+
+	rateChoice = new wxChoice(this, wxID_ANY);
+	for (int i=0; i<DEVICE_RATES; i++) {
+		rateChoice->Append(wxString::Format("%d Hz", deviceRates[i]));
+	}
+	grid->Add(rateChoice, 0, wxALL, 5);
+
+	staticText = new wxStaticText(this, wxID_ANY, wxString("Buffer size"));
+	grid->Add(staticText, 0, wxALL, 5);
+
+	bufferChoice = new wxChoice(this, wxID_ANY);
+	for (int i=0; i<DEVICE_BUFFERS; i++) {
+		bufferChoice->Append(wxString::Format("%d frames", deviceBuffers[i]));
+	}
+	grid->Add(bufferChoice, 0, wxALL, 5);
+
+	deviceSizer->Add(grid, 0, wxEXPAND | wxALL, 0);
+
+	wxBoxSizer *hSizer = new wxBoxSizer(wxHORIZONTAL);
+
+	applyBtn = new wxButton(this, wxID_ANY, _("Apply"));
+	applyBtn->Bind(wxEVT_BUTTON, &SettingsFrame::OnApplyDevice, this);
+	hSizer->Add(applyBtn, 0, wxALL, 5);
+
+	safeBtn = new wxButton(this, wxID_ANY, _("Safe profile"));
+	safeBtn->SetToolTip(_("Large buffer for big projects, more latency but fewer dropouts"));
+	safeBtn->Bind(wxEVT_BUTTON, &SettingsFrame::OnSafeProfile, this);
+	hSizer->Add(safeBtn, 0, wxALL, 5);
+
+	resetBtn = new wxButton(this, wxID_ANY, _("Reset counters"));
+	resetBtn->Bind(wxEVT_BUTTON, &SettingsFrame::OnResetStats, this);
+	hSizer->Add(resetBtn, 0, wxALL, 5);
+
+	deviceSizer->Add(hSizer, 0, wxALL, 0);
+
+	deviceText = new wxStaticText(this, wxID_ANY, wxEmptyString);
+	deviceSizer->Add(deviceText, 0, wxEXPAND | wxALL, 5);
+
+	statsText = new wxStaticText(this, wxID_ANY, wxEmptyString);
+	deviceSizer->Add(statsText, 0, wxEXPAND | wxALL, 5);
+
+	mSizer->Add(deviceSizer, 0, wxEXPAND | wxALL, 5);
+
 	Bind(wxEVT_CLOSE_WINDOW, &SettingsFrame::OnClose, this);
 
-	SetSizer(mSizer);
+	SetSizerAndFit(mSizer);
 	Layout();
+
+	lastBusyNs = 0;
+	lastTime = 0;
+
+	if (studioAudio) {
+		studioAudio->WaitOpen();
+	}
+
+	if (studioAudio && studioAudio->IsOpen()) {
+		SelectDeviceChoices(studioAudio->GetSampleRate(), studioAudio->GetBufferFrames());
+	} else {
+		// oaml opened its own device at startup, opening ours on top of it
+		// would play everything twice
+		SelectDeviceChoices(44100, 1024);
+		EnableDeviceControls(false);
+	}
+
+	timer = new SettingsTimer(this);
 }
 
 SettingsFrame::~SettingsFrame() {
+	delete timer;
+}
+
+bool SettingsFrame::Show(bool show) {
+	// The counters only tick while they can be seen
+	if (show) {
+		lastTime = 0;
+		Update();
+		timer->Start(SETTINGS_REFRESH_RATE);
+	} else {
+		timer->Stop();
+	}
+
+	return wxFrame::Show(show);
 }
 
 void SettingsFrame::OnLoad() {
@@ -79,8 +165,7 @@ void SettingsFrame::OnBpmChange(wxCommandEvent& WXUNUSED(event)) {
 		studioApi->ProjectSetBPM(value);
 
 		// Mark the project dirty
-		wxCommandEvent event(EVENT_SET_PROJECT_DIRTY);
-		wxPostEvent(GetParent(), event);
+		eventBus->PostDirty();
 	}
 }
 
@@ -93,7 +178,121 @@ void SettingsFrame::OnBpbChange(wxCommandEvent& WXUNUSED(event)) {
 		studioApi->ProjectSetBeatsPerBar(value);
 
 		// Mark the project dirty
-		wxCommandEvent event(EVENT_SET_PROJECT_DIRTY);
-		wxPostEvent(GetParent(), event);
+		eventBus->PostDirty();
+	}
+}
+
+void SettingsFrame::SelectDeviceChoices(int rate, int frames) {
+	for (int i=0; i<DEVICE_RATES; i++) {
+		if (deviceRates[i] == rate) {
+			rateChoice->SetSelection(i);
+		}
+	}
+
+	for (int i=0; i<DEVICE_BUFFERS; i++) {
+		if (deviceBuffers[i] == frames) {
+			bufferChoice->SetSelection(i);
+		}
 	}
 }
+
+void SettingsFrame::ApplyDevice(int rate, int frames) {
+	if (studioAudio == NULL)
+		return;
+
+	studioAudio->WaitOpen();
+	if (studioAudio->IsOpen() == false)
+		return;
+
+	// Remembered for the next start, even when the device refuses it now
+	wxConfig *config = ((StudioFrame*)GetParent())->GetConfig();
+	if (config) {
+		config->Write("AudioSampleRate", rate);
+		config->Write("AudioBufferFrames", frames);
+	}
+
+	int oldRate = studioAudio->GetSampleRate();
+	int oldFrames = studioAudio->GetBufferFrames();
+	if (studioAudio->Open(rate, 2, frames) != 0) {
+		if (studioAudio->Open(oldRate, 2, oldFrames) == 0) {
+			wxMessageBox(_("Error opening the audio device with these settings"), _("Audio device"), wxOK | wxICON_ERROR, this);
+			SelectDeviceChoices(oldRate, oldFrames);
+		} else {
+			// Same as a failed open at startup, oaml plays on its own device
+			oaml->InitAudioDevice();
+			EnableDeviceControls(false);
+			wxMessageBox(_("Error opening the audio device, using oaml's device until the studio is restarted"), _("Audio device"), wxOK | wxICON_ERROR, this);
+		}
+	}
+
+	lastTime = 0;
+	Update();
+}
+
+void SettingsFrame::EnableDeviceControls(bool enable) {
+	rateChoice->Enable(enable);
+	bufferChoice->Enable(enable);
+	applyBtn->Enable(enable);
+	safeBtn->Enable(enable);
+	resetBtn->Enable(enable);
+}
+
+void SettingsFrame::OnApplyDevice(wxCommandEvent& WXUNUSED(event)) {
+	int rate = rateChoice->GetSelection();
+	int frames = bufferChoice->GetSelection();
+	if (rate == wxNOT_FOUND || frames == wxNOT_FOUND)
+		return;
+
+	ApplyDevice(deviceRates[rate], deviceBuffers[frames]);
+}
+
+void SettingsFrame::OnSafeProfile(wxCommandEvent& WXUNUSED(event)) {
+	SelectDeviceChoices(AUDIO_SAFE_RATE, AUDIO_SAFE_FRAMES);
+	ApplyDevice(AUDIO_SAFE_RATE, AUDIO_SAFE_FRAMES);
+}
+
+void SettingsFrame::OnResetStats(wxCommandEvent& WXUNUSED(event)) {
+	if (studioAudio) {
+		studioAudio->ResetCallbackStats();
+	}
+	Update();
+}
+
+void SettingsFrame::Update() {
+	if (studioAudio == NULL || studioAudio->IsOpen() == false) {
+		deviceText->SetLabel(_("Using oaml's audio device, no statistics available"));
+		statsText->SetLabel(wxEmptyString);
+		return;
+	}
+
+	audioCallbackStats stats;
+	studioAudio->GetCallbackStats(stats, false);
+
+	deviceText->SetLabel(wxString::Format(_("%d Hz, %d frames (%.1f ms)"), studioAudio->GetSampleRate(), studioAudio->GetBufferFrames(), stats.budgetNs / 1000000.0));
+
+	// Share of wall time spent inside the callback since the last refresh
+	wxLongLong now = wxGetLocalTimeMillis();
+	double load = 0;
+	if (lastTime > 0 && now > lastTime) {
+		load = (stats.busyNs - lastBusyNs) / 1000000.0 / (now - lastTime).ToDouble() * 100.0;
+	}
+	lastBusyNs = stats.busyNs;
+	lastTime = now;
+
+	statsText->SetLabel(wxString::Format(_("Callback p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms\nMixer load %.1f%%\nLate callbacks %u, device gaps %u"),
+		StudioAudio::GetPercentileNs(stats, 0.50) / 1000000.0,
+		StudioAudio::GetPercentileNs(stats, 0.95) / 1000000.0,
+		StudioAudio::GetPercentileNs(stats, 0.99) / 1000000.0,
+		stats.maxNs / 1000000.0,
+		load, stats.lateCallbacks, stats.gaps));
+
+	Layout();
+}
+
+SettingsTimer::SettingsTimer(SettingsFrame* pane) : wxTimer() {
+	SettingsTimer::pane = pane;
+}
+
+void SettingsTimer::Notify() {
+	pane->Update();
+}
@@ -34,12 +34,9 @@
 #include "oamlCommon.h"
 
 
-StartupFrame::StartupFrame(wxWindow *parent) : wxFrame(parent, wxID_ANY, wxT("Startup"), wxDefaultPosition, wxSize(640, 480), wxFRAME_TOOL_WINDOW | wxFRAME_FLOAT_ON_PARENT | wxCAPTION | wxRESIZE_BORDER | wxSTAY_ON_TOP) {
-	config = new wxConfig("oamlStudio");
-
-	fileHistory = new wxFileHistory();
-	fileHistory->Load(*config);
-
+// The history comes from the studio frame, it's only read here
+StartupFrame::StartupFrame(wxWindow *parent, wxFileHistory *fileHistory) : wxFrame(parent, wxID_ANY, wxT("Startup"), wxDefaultPosition, wxSize(640, 480), wxFRAME_TOOL_WINDOW | wxFRAME_FLOAT_ON_PARENT | wxCAPTION | wxRESIZE_BORDER | wxSTAY_ON_TOP) {
+	TRACE_SCOPE("StartupFrame::StartupFrame");
 	mainSizer = new wxBoxSizer(wxVERTICAL);
 
 	wxStaticText *text = new wxStaticText(this, wxID_ANY, wxString("Welcome to oamlStudio!\n\nHere you can load one of the latest projects used or start a new project from scratch."), wxDefaultPosition, wxSize(-1, -1), wxALIGN_CENTRE_HORIZONTAL);
@@ -0,0 +1,239 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include <SDL.h>
+
+#include "oamlCommon.h"
+
+
+StudioAudio *studioAudio = NULL;
+
+static void StudioAudioCallback(void *userdata, Uint8 *stream, int len) {
+	StudioAudio *audio = (StudioAudio*)userdata;
+	audio->Process((int16_t*)stream, len / (2 * audio->GetChannels()));
+}
+
+StudioAudio::StudioAudio(oamlApi *_api) : openNs(0), metering(false), meterDropped(0), callbacks(0), lastNs(0), maxNs(0), resetMax(false), busyNs(0), lateCallbacks(0), gaps(0) {
+	api = _api;
+	sampleRate = 44100;
+	channels = 2;
+	bufferFrames = 1024;
+	opened = false;
+	budgetNs = 0;
+	lastStartNs = 0;
+
+	ResetCallbackStats();
+}
+
+StudioAudio::~StudioAudio() {
+	WaitOpen();
+	Close();
+}
+
+// Opening the device can take hundreds of ms, nobody needs to wait for it
+// until a project is touched. Our own device lets us meter what oaml mixes,
+// oaml's device is the fallback.
+void StudioAudio::OpenAsync(int _sampleRate, int _channels, int _bufferFrames) {
+	WaitOpen();
+	opener = std::thread(&StudioAudio::OpenWorker, this, _sampleRate, _channels, _bufferFrames);
+}
+
+void StudioAudio::OpenWorker(int _sampleRate, int _channels, int _bufferFrames) {
+	TraceSetThreadName("audio open");
+	TRACE_SCOPE("StudioAudio::OpenWorker");
+	uint64_t start = TraceNowNs();
+
+	// Settings the device refuses would otherwise stick until edited by hand
+	if (Open(_sampleRate, _channels, _bufferFrames) != 0 && Open() != 0) {
+		api->InitAudioDevice();
+	}
+
+	openNs = TraceNowNs() - start;
+}
+
+// Must be called before oaml is used or the device is reopened
+void StudioAudio::WaitOpen() {
+	if (opener.joinable()) {
+		opener.join();
+	}
+}
+
+int StudioAudio::Open(int _sampleRate, int _channels, int _bufferFrames) {
+	if (opened)
+		Close();
+
+	if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
+		fprintf(stderr, "oamlStudio: Error initializing audio: %s\n", SDL_GetError());
+		return -1;
+	}
+
+	SDL_AudioSpec desired;
+	SDL_AudioSpec obtained;
+
+	memset(&desired, 0, sizeof(desired));
+	desired.freq = _sampleRate;
+	desired.format = AUDIO_S16SYS;
+	desired.channels = _channels;
+	desired.samples = _bufferFrames;
+	desired.callback = StudioAudioCallback;
+	desired.userdata = this;
+
+	if (SDL_OpenAudio(&desired, &obtained) != 0) {
+		fprintf(stderr, "oamlStudio: Error opening audio device: %s\n", SDL_GetError());
+		SDL_QuitSubSystem(SDL_INIT_AUDIO);
+		return -1;
+	}
+
+	// The meters and oaml are fed 16 bit samples, anything else is no use to us
+	if (obtained.format != AUDIO_S16SYS) {
+		fprintf(stderr, "oamlStudio: Unsupported audio device format\n");
+		SDL_CloseAudio();
+		SDL_QuitSubSystem(SDL_INIT_AUDIO);
+		return -1;
+	}
+
+	sampleRate = obtained.freq;
+	channels = obtained.channels;
+	bufferFrames = obtained.samples;
+	budgetNs = sampleRate > 0 ? (uint64_t)bufferFrames * 1000000000ULL / sampleRate : 0;
+
+	ResetCallbackStats();
+	lastStartNs = 0;
+
+	api->SetAudioFormat(sampleRate, channels, 2);
+	preview.SetOutputRate(sampleRate);
+
+	opened = true;
+	SDL_PauseAudio(0);
+
+	return 0;
+}
+
+void StudioAudio::Close() {
+	if (opened == false)
+		return;
+
+	SDL_CloseAudio();
+	SDL_QuitSubSystem(SDL_INIT_AUDIO);
+	opened = false;
+}
+
+void StudioAudio::Process(int16_t *buffer, int frames) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	uint64_t startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count();
+
+	// SDL doesn't report underruns. A callback coming much later than the
+	// buffer length means the device ran dry waiting for us.
+	if (lastStartNs > 0 && budgetNs > 0 && startNs - lastStartNs > budgetNs + budgetNs / 2) {
+		gaps.fetch_add(1, std::memory_order_relaxed);
+	}
+	lastStartNs = startNs;
+
+	memset(buffer, 0, frames * channels * sizeof(int16_t));
+	api->MixToBuffer(buffer, frames * channels);
+	preview.Mix(buffer, frames, channels);
+
+	if (metering) {
+		meterBlock block;
+		MeterAnalyze(buffer, frames, channels, block);
+
+		// The UI is behind, drop the block rather than wait
+		if (meterRing.Push(block) == false) {
+			meterDropped++;
+		}
+	}
+
+	uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	lastNs.store(ns, std::memory_order_relaxed);
+
+	// We're the only writer, the UI just asks for the max to be cleared
+	if (resetMax.exchange(false) || ns > maxNs.load(std::memory_order_relaxed)) {
+		maxNs.store(ns, std::memory_order_relaxed);
+	}
+
+	busyNs.fetch_add(ns, std::memory_order_relaxed);
+	if (budgetNs > 0) {
+		if (ns > budgetNs) {
+			lateCallbacks.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		uint64_t bucket = ns * AUDIO_LOAD_BUCKETS / (2 * budgetNs);
+		if (bucket >= AUDIO_LOAD_BUCKETS) bucket = AUDIO_LOAD_BUCKETS - 1;
+		loadBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	callbacks.fetch_add(1, std::memory_order_release);
+}
+
+void StudioAudio::GetCallbackStats(audioCallbackStats& stats, bool clearMax) {
+	stats.callbacks = callbacks.load(std::memory_order_acquire);
+	stats.lastNs = lastNs.load(std::memory_order_relaxed);
+	stats.maxNs = maxNs.load(std::memory_order_relaxed);
+	stats.budgetNs = budgetNs;
+	stats.busyNs = busyNs.load(std::memory_order_relaxed);
+	stats.lateCallbacks = lateCallbacks.load(std::memory_order_relaxed);
+	stats.gaps = gaps.load(std::memory_order_relaxed);
+	stats.meterDropped = meterDropped.load(std::memory_order_relaxed);
+	for (int i=0; i<AUDIO_LOAD_BUCKETS; i++) {
+		stats.buckets[i] = loadBuckets[i].load(std::memory_order_relaxed);
+	}
+
+	if (clearMax) {
+		resetMax = true;
+	}
+}
+
+void StudioAudio::ResetCallbackStats() {
+	// Racing with the audio thread only loses a count or two
+	for (int i=0; i<AUDIO_LOAD_BUCKETS; i++) {
+		loadBuckets[i].store(0, std::memory_order_relaxed);
+	}
+	lateCallbacks = 0;
+	gaps = 0;
+	resetMax = true;
+}
+
+uint64_t StudioAudio::GetPercentileNs(const audioCallbackStats& stats, double p) {
+	uint64_t total = 0;
+	for (int i=0; i<AUDIO_LOAD_BUCKETS; i++) {
+		total+= stats.buckets[i];
+	}
+	if (total == 0)
+		return 0;
+
+	// Upper edge of the bucket the percentile falls in
+	uint64_t target = (uint64_t)(p * total);
+	uint64_t count = 0;
+	for (int i=0; i<AUDIO_LOAD_BUCKETS; i++) {
+		count+= stats.buckets[i];
+		if (count > target) {
+			return (i + 1) * 2 * stats.budgetNs / AUDIO_LOAD_BUCKETS;
+		}
+	}
+
+	return 2 * stats.budgetNs;
+}
@@ -0,0 +1,259 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "oamlCore.h"
+
+
+void CliUsage() {
+	fprintf(stderr, "usage: oamlStudio --simulate <oaml.defs> --track <name> [options]\n");
+	fprintf(stderr, "       oamlStudio --profile <oaml.defs> [--track <name>]... [options]\n");
+	fprintf(stderr, "  --timeline <file>     condition timeline, '<seconds> <condId> <condValue>' per line\n");
+	fprintf(stderr, "  --seconds <n>         simulated length (default 600, 120 when profiling)\n");
+	fprintf(stderr, "  --seed <n>            random seed (default 1)\n");
+	fprintf(stderr, "  --rate <n>            mix rate when profiling (default 44100)\n");
+	fprintf(stderr, "  --json                print the report as json\n");
+	fprintf(stderr, "  --require-coverage    fail if a conditional loop never played\n");
+}
+
+static const char *CliFindCommand(int argc, char **argv) {
+	for (int i=1; i<argc; i++) {
+		if (strcmp(argv[i], "--simulate") == 0 || strcmp(argv[i], "--profile") == 0)
+			return argv[i];
+	}
+	return NULL;
+}
+
+bool CliIsCommand(int argc, char **argv) {
+	return CliFindCommand(argc, argv) != NULL;
+}
+
+void CliSplitDefsPath(std::string path, std::string& dir, std::string& file) {
+	size_t pos = path.find_last_of("/\\");
+	if (pos == std::string::npos) {
+		dir = "";
+		file = path;
+	} else {
+		dir = path.substr(0, pos + 1);
+		file = path.substr(pos + 1);
+	}
+}
+
+void CliJsonString(FILE *f, const std::string& str) {
+	fputc('"', f);
+	for (size_t i=0; i<str.size(); i++) {
+		unsigned char c = str[i];
+		if (c == '"' || c == '\\') {
+			fprintf(f, "\\%c", c);
+		} else if (c < 0x20) {
+			fprintf(f, "\\u%04x", c);
+		} else {
+			fputc(c, f);
+		}
+	}
+	fputc('"', f);
+}
+
+static int CliSimulate(int argc, char **argv) {
+	std::string defs;
+	std::string track;
+	std::string timelineFile;
+	double seconds = 600.0;
+	unsigned int seed = 1;
+	bool json = false;
+	bool requireCoverage = false;
+
+	for (int i=1; i<argc; i++) {
+		bool hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--simulate") == 0 && hasValue) {
+			defs = argv[++i];
+		} else if (strcmp(argv[i], "--track") == 0 && hasValue) {
+			track = argv[++i];
+		} else if (strcmp(argv[i], "--timeline") == 0 && hasValue) {
+			timelineFile = argv[++i];
+		} else if (strcmp(argv[i], "--seconds") == 0 && hasValue) {
+			seconds = atof(argv[++i]);
+		} else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+			seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+		} else if (strcmp(argv[i], "--json") == 0) {
+			json = true;
+		} else if (strcmp(argv[i], "--require-coverage") == 0) {
+			requireCoverage = true;
+		} else {
+			CliUsage();
+			return 1;
+		}
+	}
+
+	if (defs == "" || track == "" || seconds <= 0) {
+		CliUsage();
+		return 1;
+	}
+
+	std::string error;
+	CondTimeline timeline;
+	if (timelineFile != "" && timeline.Load(timelineFile.c_str(), &error) != 0) {
+		fprintf(stderr, "oamlStudio: %s: %s\n", timelineFile.c_str(), error.c_str());
+		return 1;
+	}
+
+	// Project files are relative to the defs, just like in the studio
+	std::string dir;
+	std::string file;
+	CliSplitDefsPath(defs, dir, file);
+	SetProjectFiles(dir);
+
+	AdaptiveSim sim(file, track);
+	sim.SetTimeline(timeline);
+	sim.SetLength(seconds);
+	sim.SetSeed(seed);
+	if (sim.Run(&error) != 0) {
+		fprintf(stderr, "oamlStudio: %s\n", error.c_str());
+		return 1;
+	}
+
+	if (json) {
+		sim.WriteJson(stdout);
+	} else {
+		sim.WriteReport(stdout);
+	}
+
+	if (requireCoverage && sim.GetUncoveredCount() > 0)
+		return 2;
+
+	return 0;
+}
+
+static int CliProfile(int argc, char **argv) {
+	std::string defs;
+	std::vector<std::string> tracks;
+	std::string timelineFile;
+	double seconds = 120.0;
+	unsigned int seed = 1;
+	int rate = 44100;
+	bool json = false;
+
+	for (int i=1; i<argc; i++) {
+		bool hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--profile") == 0 && hasValue) {
+			defs = argv[++i];
+		} else if (strcmp(argv[i], "--track") == 0 && hasValue) {
+			tracks.push_back(argv[++i]);
+		} else if (strcmp(argv[i], "--timeline") == 0 && hasValue) {
+			timelineFile = argv[++i];
+		} else if (strcmp(argv[i], "--seconds") == 0 && hasValue) {
+			seconds = atof(argv[++i]);
+		} else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+			seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+		} else if (strcmp(argv[i], "--rate") == 0 && hasValue) {
+			rate = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--json") == 0) {
+			json = true;
+		} else {
+			CliUsage();
+			return 1;
+		}
+	}
+
+	if (defs == "" || seconds <= 0 || rate <= 0) {
+		CliUsage();
+		return 1;
+	}
+
+	std::string error;
+	CondTimeline timeline;
+	if (timelineFile != "" && timeline.Load(timelineFile.c_str(), &error) != 0) {
+		fprintf(stderr, "oamlStudio: %s: %s\n", timelineFile.c_str(), error.c_str());
+		return 1;
+	}
+
+	std::string dir;
+	std::string file;
+	CliSplitDefsPath(defs, dir, file);
+	SetProjectFiles(dir);
+
+	// No track given profiles every music track
+	TrackProfiler profiler(file);
+	for (std::vector<std::string>::iterator it=tracks.begin(); it<tracks.end(); ++it) {
+		profiler.AddTrack(*it);
+	}
+	profiler.SetTimeline(timeline);
+	profiler.SetLength(seconds);
+	profiler.SetSeed(seed);
+	profiler.SetSampleRate(rate);
+	if (profiler.Run(&error) != 0) {
+		fprintf(stderr, "oamlStudio: %s\n", error.c_str());
+		return 1;
+	}
+
+	if (json) {
+		profiler.WriteJson(stdout);
+	} else {
+		profiler.WriteReport(stdout);
+	}
+
+	return 0;
+}
+
+std::string CliStartTrace(int& argc, char **argv) {
+	std::string traceFile;
+	int count = 0;
+	for (int i=0; i<argc; i++) {
+		if (strcmp(argv[i], "--trace") == 0 && i+1 < argc) {
+			traceFile = argv[++i];
+			continue;
+		}
+		argv[count++] = argv[i];
+	}
+
+	if (count < argc) {
+		argv[count] = NULL;
+		argc = count;
+	}
+
+	if (traceFile.empty() == false) {
+		TraceStart();
+	}
+
+	return traceFile;
+}
+
+void CliStopTrace(const std::string& traceFile) {
+	if (traceFile.empty())
+		return;
+
+	TraceStop();
+	if (TraceWriteJson(traceFile.c_str()) == -1) {
+		fprintf(stderr, "oamlStudio: can't write %s\n", traceFile.c_str());
+	}
+}
+
+int CliMain(int argc, char **argv) {
+	const char *command = CliFindCommand(argc, argv);
+	if (command && strcmp(command, "--profile") == 0)
+		return CliProfile(argc, argv);
+
+	return CliSimulate(argc, argv);
+}
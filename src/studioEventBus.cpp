@@ -0,0 +1,138 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "oamlCommon.h"
+
+
+// Pending notifications are dispatched once per frame (~60Hz)
+#define EVENT_BUS_INTERVAL 16
+
+StudioEventBus *eventBus = NULL;
+
+StudioEventBus::StudioEventBus(StudioFrame *_frame) : wxTimer() {
+	frame = _frame;
+
+	dirty = false;
+	layout = false;
+	hasStatus = false;
+}
+
+StudioEventBus::~StudioEventBus() {
+	Stop();
+}
+
+void StudioEventBus::Schedule() {
+	if (IsRunning() == false) {
+		StartOnce(EVENT_BUS_INTERVAL);
+	}
+}
+
+void StudioEventBus::PostDirty() {
+	dirty = true;
+	Schedule();
+}
+
+void StudioEventBus::PostLayout() {
+	layout = true;
+	Schedule();
+}
+
+void StudioEventBus::PostStatusText(wxString text) {
+	status = text;
+	hasStatus = true;
+	Schedule();
+}
+
+void StudioEventBus::PostAudioRename(std::string trackName, std::string oldName, std::string newName) {
+	// Typing a name renames the audio on every keystroke, chain the renames
+	// so the panels only see the first and the last name
+	for (std::vector<audioRenameEvent>::iterator it=renames.begin(); it<renames.end(); ++it) {
+		if (it->trackName == trackName && it->newName == oldName) {
+			it->newName = newName;
+			if (it->oldName == it->newName) {
+				renames.erase(it);
+			}
+			return;
+		}
+	}
+
+	audioRenameEvent ev = { trackName, oldName, newName };
+	renames.push_back(ev);
+	Schedule();
+}
+
+void StudioEventBus::PostSelectAudio(std::string audioName, std::string filename, bool extend) {
+	// A plain selection replaces whatever was selected before
+	if (extend == false) {
+		selects.clear();
+	}
+
+	audioSelectEvent ev = { audioName, filename, extend };
+	selects.push_back(ev);
+	Schedule();
+}
+
+void StudioEventBus::Flush() {
+	TRACE_SCOPE("StudioEventBus::Flush");
+	Stop();
+
+	// Handlers may post new notifications, those will go in the next frame
+	std::vector<audioRenameEvent> pendingRenames;
+	std::vector<audioSelectEvent> pendingSelects;
+	pendingRenames.swap(renames);
+	pendingSelects.swap(selects);
+
+	bool pendingDirty = dirty;
+	bool pendingLayout = layout;
+	bool pendingStatus = hasStatus;
+	dirty = false;
+	layout = false;
+	hasStatus = false;
+
+	for (std::vector<audioRenameEvent>::iterator it=pendingRenames.begin(); it<pendingRenames.end(); ++it) {
+		frame->UpdateAudioName(it->trackName, it->oldName, it->newName);
+	}
+
+	for (std::vector<audioSelectEvent>::iterator it=pendingSelects.begin(); it<pendingSelects.end(); ++it) {
+		frame->SelectAudio(it->audioName, it->filename, it->extend);
+	}
+
+	if (pendingLayout) {
+		frame->UpdateLayout();
+	}
+
+	if (pendingDirty) {
+		frame->SetProjectDirty();
+	}
+
+	if (pendingStatus) {
+		frame->SetStatusText(status);
+	}
+}
+
+void StudioEventBus::Notify() {
+	Flush();
+}
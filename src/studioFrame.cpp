@@ -43,31 +43,37 @@
 #include <wx/filehistory.h>
 #include <wx/config.h>
 #include <wx/statline.h>
+#include <wx/choicdlg.h>
+#include <wx/numdlg.h>
+#include <wx/progdlg.h>
+#include <wx/dirdlg.h>
+#include <thread>
 #include <archive.h>
 #include <archive_entry.h>
 
 
 wxDEFINE_EVENT(EVENT_ADD_AUDIO, wxCommandEvent);
 wxDEFINE_EVENT(EVENT_ADD_LAYER, wxCommandEvent);
+wxDEFINE_EVENT(EVENT_CLOSE_DIAGNOSTICS, wxCommandEvent);
+wxDEFINE_EVENT(EVENT_CLOSE_METERS, wxCommandEvent);
 wxDEFINE_EVENT(EVENT_CLOSE_PLAYBACK, wxCommandEvent);
 wxDEFINE_EVENT(EVENT_CLOSE_SETTINGS, wxCommandEvent);
+wxDEFINE_EVENT(EVENT_IMPORT_PROGRESS, wxThreadEvent);
 wxDEFINE_EVENT(EVENT_LOAD_PROJECT, wxCommandEvent);
 wxDEFINE_EVENT(EVENT_LOAD_OTHER, wxCommandEvent);
+wxDEFINE_EVENT(EVENT_LOAD_PROGRESS, wxThreadEvent);
 wxDEFINE_EVENT(EVENT_NEW_PROJECT, wxCommandEvent);
 wxDEFINE_EVENT(EVENT_PLAY, wxCommandEvent);
 wxDEFINE_EVENT(EVENT_REMOVE_AUDIO_FILE, wxCommandEvent);
 wxDEFINE_EVENT(EVENT_QUIT, wxCommandEvent);
-wxDEFINE_EVENT(EVENT_SET_PROJECT_DIRTY, wxCommandEvent);
-wxDEFINE_EVENT(EVENT_SET_STATUS_TEXT, wxCommandEvent);
-wxDEFINE_EVENT(EVENT_SELECT_AUDIO, wxCommandEvent);
-wxDEFINE_EVENT(EVENT_UPDATE_AUDIO_NAME, wxCommandEvent);
-wxDEFINE_EVENT(EVENT_UPDATE_LAYOUT, wxCommandEvent);
+wxDEFINE_EVENT(EVENT_UI_HEARTBEAT, wxThreadEvent);
 
 
 BEGIN_EVENT_TABLE(StudioFrame, wxFrame)
 	EVT_CLOSE(StudioFrame::OnClose)
 	EVT_MENU(ID_New, StudioFrame::OnNew)
 	EVT_MENU(ID_Load, StudioFrame::OnLoad)
+	EVT_MENU(ID_CancelLoad, StudioFrame::OnCancelLoad)
 	EVT_MENU(ID_Save, StudioFrame::OnSave)
 	EVT_MENU(ID_SaveAs, StudioFrame::OnSaveAs)
 	EVT_MENU(ID_Export, StudioFrame::OnExport)
@@ -75,15 +81,21 @@ BEGIN_EVENT_TABLE(StudioFrame, wxFrame)
 	EVT_MENU(ID_About, StudioFrame::OnAbout)
 	EVT_MENU(ID_AddMusicTrack, StudioFrame::OnAddMusicTrack)
 	EVT_MENU(ID_AddSfxTrack, StudioFrame::OnAddSfxTrack)
+	EVT_MENU(ID_Bounce, StudioFrame::OnBounce)
 	EVT_MENU(ID_EditMusicTrackName, StudioFrame::OnEditMusicTrackName)
 	EVT_MENU(ID_EditSfxTrackName, StudioFrame::OnEditSfxTrackName)
 	EVT_MENU(ID_RemoveMusicTrack, StudioFrame::OnRemoveMusicTrack)
 	EVT_MENU(ID_RemoveSfxTrack, StudioFrame::OnRemoveSfxTrack)
 	EVT_MENU(ID_PlaybackPanel, StudioFrame::OnPlaybackPanel)
+	EVT_MENU(ID_MetersPanel, StudioFrame::OnMetersPanel)
 	EVT_MENU(ID_SettingsPanel, StudioFrame::OnSettingsPanel)
+	EVT_MENU(ID_DiagnosticsPanel, StudioFrame::OnDiagnosticsPanel)
+	EVT_MENU(ID_RecordTrace, StudioFrame::OnRecordTrace)
 	EVT_MENU_RANGE(wxID_FILE1, wxID_FILE9, StudioFrame::OnRecentFile)
 	EVT_COMMAND(wxID_ANY, EVENT_ADD_AUDIO, StudioFrame::OnAddAudio)
 	EVT_COMMAND(wxID_ANY, EVENT_ADD_LAYER, StudioFrame::OnAddLayer)
+	EVT_COMMAND(wxID_ANY, EVENT_CLOSE_DIAGNOSTICS, StudioFrame::OnCloseDiagnostics)
+	EVT_COMMAND(wxID_ANY, EVENT_CLOSE_METERS, StudioFrame::OnCloseMeters)
 	EVT_COMMAND(wxID_ANY, EVENT_CLOSE_PLAYBACK, StudioFrame::OnClosePlayback)
 	EVT_COMMAND(wxID_ANY, EVENT_CLOSE_SETTINGS, StudioFrame::OnCloseSettings)
 	EVT_COMMAND(wxID_ANY, EVENT_LOAD_PROJECT, StudioFrame::OnLoadProject)
@@ -91,25 +103,9 @@ BEGIN_EVENT_TABLE(StudioFrame, wxFrame)
 	EVT_COMMAND(wxID_ANY, EVENT_NEW_PROJECT, StudioFrame::OnNew)
 	EVT_COMMAND(wxID_ANY, EVENT_PLAY, StudioFrame::OnPlay)
 	EVT_COMMAND(wxID_ANY, EVENT_QUIT, StudioFrame::OnQuit)
-	EVT_COMMAND(wxID_ANY, EVENT_SELECT_AUDIO, StudioFrame::OnSelectAudio)
-	EVT_COMMAND(wxID_ANY, EVENT_SET_PROJECT_DIRTY, StudioFrame::OnSetProjectDirty)
-	EVT_COMMAND(wxID_ANY, EVENT_SET_STATUS_TEXT, StudioFrame::OnSetStatusText)
-	EVT_COMMAND(wxID_ANY, EVENT_UPDATE_AUDIO_NAME, StudioFrame::OnUpdateAudioName)
-	EVT_COMMAND(wxID_ANY, EVENT_UPDATE_LAYOUT, StudioFrame::OnUpdateLayout)
+	EVT_THREAD(wxID_ANY, StudioFrame::OnLoadProgress)
 END_EVENT_TABLE()
 
-StudioTimer::StudioTimer(StudioFrame* pane) : wxTimer() {
-	StudioTimer::pane = pane;
-	musicList = NULL;
-	sfxList = NULL;
-}
-
-void StudioTimer::Notify() {
-	wxString str = musicList ? musicList->GetItemText(labelIndex) : sfxList->GetItemText(labelIndex);
-	studioApi->TrackRename(trackName, str.ToStdString());
-	pane->UpdateTrackName(trackName, str.ToStdString());
-}
-
 void StudioFrame::UpdateTrackName(std::string trackName, std::string newName) {
 	if (trackPane) {
 		trackPane->UpdateTrackName(trackName, newName);
@@ -122,19 +118,27 @@ void StudioFrame::UpdateTrackName(std::string trackName, std::string newName) {
 	Layout();
 }
 
-StudioFrame::StudioFrame(const wxString& title, const wxPoint& pos, const wxSize& size, long style) : wxFrame(NULL, -1, title, pos, size, style) {
+StudioFrame::StudioFrame(const wxString& title, const wxPoint& pos, const wxSize& size, long style) : wxFrame(NULL, -1, title, pos, size, style), projectMem(MEM_PROJECT) {
+	TRACE_SCOPE("StudioFrame::StudioFrame");
 	config = new wxConfig("oamlStudio");
-	timer = NULL;
+	eventBus = new StudioEventBus(this);
+	loader = new ProjectLoader(this);
+	watchdog = new UiWatchdog(this);
 	trackPane = NULL;
 	controlPane = NULL;
 	rightLine = NULL;
 //	layerPanel = NULL;
+	playbackFrame = NULL;
+	meterFrame = NULL;
+	diagnosticsFrame = NULL;
+	settingsFrame = NULL;
 
 	wxMenuBar *menuBar = new wxMenuBar;
 	wxMenu *menuFile = new wxMenu;
 	menuFile->Append(ID_New, _("&New...\tCtrl-N"));
 	menuFile->AppendSeparator();
 	menuFile->Append(ID_Load, _("&Load...\tCtrl-L"));
+	menuFile->Append(ID_CancelLoad, _("&Cancel Loading"));
 	menuFile->Append(ID_Save, _("&Save...\tCtrl-S"));
 	menuFile->Append(ID_SaveAs, _("&Save As..."));
 	menuFile->Append(ID_Export, _("&Export...\tCtrl-E"));
@@ -156,6 +160,7 @@ StudioFrame::StudioFrame(const wxString& title, const wxPoint& pos, const wxSize
 	menuFile->Append(ID_AddMusicTrack, _("Add &music track"));
 	menuFile->Append(ID_AddSfxTrack, _("Add &sfx track"));
 	menuFile->AppendSeparator();
+	menuFile->Append(ID_Bounce, _("&Bounce to WAV..."));
 
 	menuBar->Append(menuFile, _("&Tracks"));
 
@@ -168,7 +173,11 @@ StudioFrame::StudioFrame(const wxString& title, const wxPoint& pos, const wxSize
 	viewMenu = new wxMenu;
 	viewMenu->AppendCheckItem(ID_PlaybackPanel, _("&Playback Panel"));
 	viewMenu->AppendCheckItem(ID_SettingsPanel, _("&Settings Panel"));
+	viewMenu->AppendCheckItem(ID_MetersPanel, _("&Meters Panel"));
 	viewMenu->AppendSeparator();
+	viewMenu->AppendCheckItem(ID_DiagnosticsPanel, _("&Diagnostics"));
+	viewMenu->AppendCheckItem(ID_RecordTrace, _("&Record trace"));
+	viewMenu->Check(ID_RecordTrace, TraceIsRecording());
 
 	menuBar->Append(viewMenu, _("&View"));
 
@@ -179,8 +188,12 @@ StudioFrame::StudioFrame(const wxString& title, const wxPoint& pos, const wxSize
 	menuBar->Append(menuFile, _("&About"));
 
 	SetMenuBar(menuBar);
+	menuBar->Enable(ID_CancelLoad, false);
 
-	CreateStatusBar();
+	// The second field shows the ui responsiveness measured by the watchdog
+	int statusWidths[2] = { -1, 420 };
+	CreateStatusBar(2);
+	SetStatusWidths(2, statusWidths);
 	SetStatusText(_("Ready"));
 
 	mainSizer = new wxBoxSizer(wxHORIZONTAL);
@@ -190,10 +203,17 @@ StudioFrame::StudioFrame(const wxString& title, const wxPoint& pos, const wxSize
 	// Left panel
 	vSizer = new wxBoxSizer(wxVERTICAL);
 
+	searchCtrl = new wxSearchCtrl(this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize(240, -1));
+	searchCtrl->SetDescriptiveText(_("Search tracks, audios and files"));
+	searchCtrl->ShowCancelButton(true);
+	searchCtrl->Bind(wxEVT_TEXT, &StudioFrame::OnSearch, this);
+	searchCtrl->Bind(wxEVT_SEARCHCTRL_CANCEL_BTN, &StudioFrame::OnSearch, this);
+	vSizer->Add(searchCtrl, 0, wxALL, 5);
+
 	wxStaticText *staticText = new wxStaticText(this, wxID_ANY, wxString("-- Music Tracks --"));
 	vSizer->Add(staticText, 0, wxALIGN_CENTER_HORIZONTAL | wxALL, 2);
 
-	musicList = new wxListView(this, wxID_ANY, wxDefaultPosition, wxSize(240, -1), wxLC_LIST | wxLC_EDIT_LABELS | wxLC_SINGLE_SEL);
+	musicList = new TrackListView(this, &trackIndex, true);
 	musicList->SetBackgroundColour(wxColour(0x80, 0x80, 0x80));
 	musicList->Bind(wxEVT_LIST_ITEM_ACTIVATED, &StudioFrame::OnMusicListActivated, this);
 	musicList->Bind(wxEVT_RIGHT_UP, &StudioFrame::OnMusicListMenu, this);
@@ -204,7 +224,7 @@ StudioFrame::StudioFrame(const wxString& title, const wxPoint& pos, const wxSize
 	staticText = new wxStaticText(this, wxID_ANY, wxString("-- Sfx Tracks --"));
 	vSizer->Add(staticText, 0, wxALIGN_CENTER_HORIZONTAL | wxALL, 2);
 
-	sfxList = new wxListView(this, wxID_ANY, wxDefaultPosition, wxSize(240, -1), wxLC_LIST | wxLC_EDIT_LABELS | wxLC_SINGLE_SEL);
+	sfxList = new TrackListView(this, &trackIndex, false);
 	sfxList->SetBackgroundColour(wxColour(0x80, 0x80, 0x80));
 	sfxList->Bind(wxEVT_LIST_ITEM_ACTIVATED, &StudioFrame::OnSfxListActivated, this);
 	sfxList->Bind(wxEVT_RIGHT_UP, &StudioFrame::OnSfxListMenu, this);
@@ -232,21 +252,31 @@ StudioFrame::StudioFrame(const wxString& title, const wxPoint& pos, const wxSize
 
 	Centre(wxBOTH);
 
-	playbackFrame = new PlaybackFrame(this, wxID_ANY);
-	playbackFrame->Show(true);
-	viewMenu->Check(ID_PlaybackPanel, playbackFrame->IsShown());
+	// The other panels are created the first time they're needed
+	DiagnosticsFrame::LoadBudgets(config);
 
-	settingsFrame = new SettingsFrame(this, wxID_ANY);
-	settingsFrame->Show(false);
-	viewMenu->Check(ID_SettingsPanel, settingsFrame->IsShown());
-
-	startupFrame = new StartupFrame(this);
+	startupFrame = new StartupFrame(this, fileHistory);
 	startupFrame->Show(true);
 
 	dirty = false;
 }
 
 StudioFrame::~StudioFrame() {
+	if (watchdog) {
+		delete watchdog;
+		watchdog = NULL;
+	}
+
+	if (loader) {
+		delete loader;
+		loader = NULL;
+	}
+
+	if (eventBus) {
+		delete eventBus;
+		eventBus = NULL;
+	}
+
 	if (config) {
 		delete config;
 		config = NULL;
@@ -258,7 +288,68 @@ StudioFrame::~StudioFrame() {
 	}
 }
 
+PlaybackFrame* StudioFrame::GetPlaybackFrame() {
+	if (playbackFrame == NULL) {
+		TRACE_SCOPE("StudioFrame::GetPlaybackFrame");
+		playbackFrame = new PlaybackFrame(this, wxID_ANY);
+		playbackFrame->EnableUpdates(loader->IsParsing() == false);
+	}
+
+	return playbackFrame;
+}
+
+// Shown along with the first project, like it always was
+void StudioFrame::OpenPlaybackFrame() {
+	if (playbackFrame)
+		return;
+
+	GetPlaybackFrame()->Show(true);
+	viewMenu->Check(ID_PlaybackPanel, true);
+}
+
+MeterFrame* StudioFrame::GetMeterFrame() {
+	if (meterFrame == NULL) {
+		TRACE_SCOPE("StudioFrame::GetMeterFrame");
+		meterFrame = new MeterFrame(this, wxID_ANY);
+
+		// Sits right on the left of the playback panel
+		if (playbackFrame) {
+			wxRect playbackRect = playbackFrame->GetRect();
+			meterFrame->SetPosition(wxPoint(playbackRect.GetX() - meterFrame->GetSize().GetWidth() - 5, playbackRect.GetY()));
+		}
+	}
+
+	return meterFrame;
+}
+
+SettingsFrame* StudioFrame::GetSettingsFrame() {
+	if (settingsFrame == NULL) {
+		TRACE_SCOPE("StudioFrame::GetSettingsFrame");
+		settingsFrame = new SettingsFrame(this, wxID_ANY);
+		if (loader->IsParsing() == false) {
+			settingsFrame->OnLoad();
+		}
+	}
+
+	return settingsFrame;
+}
+
+DiagnosticsFrame* StudioFrame::GetDiagnosticsFrame() {
+	if (diagnosticsFrame == NULL) {
+		TRACE_SCOPE("StudioFrame::GetDiagnosticsFrame");
+		diagnosticsFrame = new DiagnosticsFrame(this, wxID_ANY);
+	}
+
+	return diagnosticsFrame;
+}
+
+void StudioFrame::UpdateProjectMemory(oamlTracksInfo *info) {
+	projectMem.Set(MemEstimateProject(info));
+}
+
 void StudioFrame::SelectTrack(std::string name) {
+	TRACE_SCOPE("StudioFrame::SelectTrack");
+
 	if (controlPane) {
 		controlPane->Destroy();
 		controlPane = NULL;
@@ -283,6 +374,8 @@ void StudioFrame::SelectTrack(std::string name) {
 		return;
 	}
 
+	TRACE_SCOPE("StudioFrame::SelectTrack widgets");
+
 	controlPane = new ControlPanel(this, wxID_ANY);
 	controlPane->SetTrackMode(studioApi->TrackIsMusicTrack(name));
 	controlPane->OnSelectAudio("", "");
@@ -310,8 +403,15 @@ void StudioFrame::SelectTrack(std::string name) {
 		trackPane->AddAudio(*it);
 	}
 
+	// The track may be playing already
+	if (oaml->IsPlaying()) {
+		trackPane->StartPlayhead();
+	}
+
+	// Lay out the whole track in a single pass now instead of once per audio
 	SetSizer(mainSizer);
-	Layout();
+	eventBus->PostLayout();
+	eventBus->Flush();
 
 	controlPane->SetTrack(name);
 	controlPane->OnSelectAudio("", "");
@@ -319,22 +419,19 @@ void StudioFrame::SelectTrack(std::string name) {
 	trackControl->SetTrack(name);
 }
 
-void StudioFrame::OnSetProjectDirty(wxCommandEvent& WXUNUSED(event)) {
-	dirty = true;
-}
-
 void StudioFrame::OnMusicListActivated(wxListEvent& event) {
+	TRACE_SCOPE("StudioFrame::OnMusicListActivated");
 	int index = event.GetIndex();
 	if (index == -1) {
 		wxMessageBox(_("You must choose a track!"));
 		return;
 	}
 
-	wxString str = musicList->GetItemText(index);
-	SelectTrack(str.ToStdString());
+	SelectTrack(musicList->GetTrackName(index));
 }
 
 void StudioFrame::OnMusicListMenu(wxMouseEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnMusicListMenu");
 	wxMenu menu(wxT(""));
 	menu.Append(ID_AddMusicTrack, wxT("&Add Track"));
 	menu.Append(ID_EditMusicTrackName, wxT("Edit Track &Name"));
@@ -342,30 +439,41 @@ void StudioFrame::OnMusicListMenu(wxMouseEvent& WXUNUSED(event)) {
 	PopupMenu(&menu);
 }
 
-void StudioFrame::OnMusicEndLabelEdit(wxListEvent& event) {
-	if (timer == NULL) {
-		timer = new StudioTimer(this);
-	}
+void StudioFrame::RenameTrack(TrackListView* list, wxListEvent& event) {
+	// The list is virtual, the new name is shown once it's in the index
+	event.Veto();
+	if (event.IsEditCancelled() || IsLoading())
+		return;
+
+	std::string trackName = list->GetTrackName(event.GetIndex());
+	std::string newName = event.GetLabel().ToStdString();
+	if (newName == "" || newName == trackName)
+		return;
+
+	studioApi->TrackRename(trackName, newName);
+	UpdateTrackName(trackName, newName);
+	SetProjectDirty();
+	RebuildTrackIndex();
+}
 
-	wxString str = musicList->GetItemText(event.GetIndex());
-	timer->labelIndex = event.GetIndex();
-	timer->musicList = musicList;
-	timer->trackName = str.ToStdString();
-	timer->StartOnce(10);
+void StudioFrame::OnMusicEndLabelEdit(wxListEvent& event) {
+	TRACE_SCOPE("StudioFrame::OnMusicEndLabelEdit");
+	RenameTrack(musicList, event);
 }
 
 void StudioFrame::OnSfxListActivated(wxListEvent& event) {
+	TRACE_SCOPE("StudioFrame::OnSfxListActivated");
 	int index = event.GetIndex();
 	if (index == -1) {
 		wxMessageBox(_("You must choose a track!"));
 		return;
 	}
 
-	wxString str = sfxList->GetItemText(index);
-	SelectTrack(str.ToStdString());
+	SelectTrack(sfxList->GetTrackName(index));
 }
 
 void StudioFrame::OnSfxListMenu(wxMouseEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnSfxListMenu");
 	wxMenu menu(wxT(""));
 	menu.Append(ID_AddSfxTrack, wxT("&Add Track"));
 	menu.Append(ID_EditSfxTrackName, wxT("Edit Track &Name"));
@@ -374,18 +482,39 @@ void StudioFrame::OnSfxListMenu(wxMouseEvent& WXUNUSED(event)) {
 }
 
 void StudioFrame::OnSfxEndLabelEdit(wxListEvent& event) {
-	if (timer == NULL) {
-		timer = new StudioTimer(this);
+	TRACE_SCOPE("StudioFrame::OnSfxEndLabelEdit");
+	RenameTrack(sfxList, event);
+}
+
+void StudioFrame::RebuildTrackIndex() {
+	trackIndex.Build(oaml->GetTracksInfo());
+
+	std::string query = searchCtrl->GetValue().ToStdString();
+	musicList->Filter(query);
+	sfxList->Filter(query);
+}
+
+void StudioFrame::OnSearch(wxCommandEvent& event) {
+	TRACE_SCOPE("StudioFrame::OnSearch");
+	// Clearing the text triggers a new search
+	if (event.GetEventType() == wxEVT_SEARCHCTRL_CANCEL_BTN) {
+		searchCtrl->Clear();
+		return;
 	}
 
-	wxString str = sfxList->GetItemText(event.GetIndex());
-	timer->labelIndex = event.GetIndex();
-	timer->sfxList = sfxList;
-	timer->trackName = str.ToStdString();
-	timer->StartOnce(10);
+	// Audio and file names may have changed since the index was built, it
+	// waits for the loader when a project is being parsed
+	if (trackIndex.IsStale() && loader->IsParsing() == false) {
+		trackIndex.Build(oaml->GetTracksInfo());
+	}
+
+	std::string query = searchCtrl->GetValue().ToStdString();
+	musicList->Filter(query);
+	sfxList->Filter(query);
 }
 
 void StudioFrame::OnClose(wxCloseEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnClose");
 	if (dirty) {
 		int ret = wxMessageBox("There are unsaved changes on the project, do you really want to quit without saving?", "Confirm", wxYES_NO, this);
 		if (ret == wxNO) {
@@ -398,27 +527,39 @@ void StudioFrame::OnClose(wxCloseEvent& WXUNUSED(event)) {
 		fileHistory->Save(*config);
 	}
 
+	// The loader posts events to us, make sure it's gone before we are
+	loader->Cancel();
+	loader->Join();
+
 	Destroy();
 }
 
 void StudioFrame::OnQuit(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnQuit");
 	// Close the app
 	Close(TRUE);
 }
 
 void StudioFrame::OnNew(wxCommandEvent& event) {
-	// Destroy the track panel
-	if (trackPane) {
-		trackPane->Destroy();
-	}
+	TRACE_SCOPE("StudioFrame::OnNew");
+	// Abandon any project that's still loading
+	loader->Cancel();
+	loader->Join();
+	studioAudio->WaitOpen();
+	GetMenuBar()->Enable(ID_CancelLoad, false);
+	OpenPlaybackFrame();
+	playbackFrame->EnableUpdates(true);
 
-	// Clear music and sfx listviews
-	musicList->ClearAll();
-	sfxList->ClearAll();
+	// Destroy the track panel
+	SelectTrack("");
 
 	// Tell oaml we're creating a new project
 	studioApi->ProjectNew();
 
+	// Clear music and sfx listviews
+	searchCtrl->Clear();
+	RebuildTrackIndex();
+
 	// Ask the user to save it, path resolution will be based on the project path
 	if (SaveAs() == false) {
 		startupFrame->Show(true);
@@ -426,47 +567,141 @@ void StudioFrame::OnNew(wxCommandEvent& event) {
 }
 
 void StudioFrame::Load(std::string filename) {
+	TRACE_SCOPE("StudioFrame::Load");
+	// Only one project can be loading at a time
+	loader->Cancel();
+	loader->Join();
+	studioAudio->WaitOpen();
+
 	defsPath = filename;
 	wxFileName fname(defsPath);
 	projectPath = fname.GetPathWithSep();
-	InitCallbacks(projectPath);
+	SetProjectFiles(projectPath);
+
+	// Nothing may touch oaml on this thread until the model is ready
+	SelectTrack("");
+	trackIndex.Clear();
+	std::string query = searchCtrl->GetValue().ToStdString();
+	musicList->Filter(query);
+	sfxList->Filter(query);
+	if (playbackFrame) {
+		playbackFrame->EnableUpdates(false);
+	}
+	peakCache.Clear();
 
-	if (oaml->Init(fname.GetFullName().ToStdString().c_str()) != OAML_OK) {
-		wxMessageBox(_("Error loading project"));
+	GetMenuBar()->Enable(ID_CancelLoad, true);
+	SetStatusText(_("Loading project.."));
 
-		for (size_t i=0; i<fileHistory->GetCount(); i++) {
-			if (fileHistory->GetHistoryFile(i) == fname.GetFullPath()) {
-				fileHistory->RemoveFileFromHistory(i);
-				break;
-			}
-		}
+	loader->Start(fname.GetFullName().ToStdString());
+}
+
+bool StudioFrame::IsLoading() {
+	if (loader->IsParsing() == false)
+		return false;
+
+	wxMessageBox(_("Please wait until the project has finished loading"));
+	return true;
+}
+
+void StudioFrame::OnLoadProgress(wxThreadEvent& event) {
+	TRACE_SCOPE("StudioFrame::OnLoadProgress");
+	loadProgress progress = event.GetPayload<loadProgress>();
+	if (progress.generation != loader->GetGeneration())
 		return;
-	}
 
-	fileHistory->AddFileToHistory(filename);
+	switch (progress.stage) {
+		case LOAD_STAGE_PARSE:
+			SetStatusText(_("Loading project: reading definitions.."));
+			break;
 
-	musicList->ClearAll();
-	sfxList->ClearAll();
+		case LOAD_STAGE_MODEL_READY:
+			fileHistory->AddFileToHistory(defsPath);
 
-	oamlTracksInfo *info = oaml->GetTracksInfo();
+			RebuildTrackIndex();
+			UpdateProjectMemory(oaml->GetTracksInfo());
+			if (settingsFrame) {
+				settingsFrame->OnLoad();
+			}
+			OpenPlaybackFrame();
+			playbackFrame->EnableUpdates(true);
+			break;
+
+		case LOAD_STAGE_CHECK_FILES:
+			SetStatusText(wxString::Format(_("Loading project: checking files %d/%d"), progress.done, progress.total));
+			break;
+
+		case LOAD_STAGE_PROBE:
+			SetStatusText(wxString::Format(_("Loading project: reading file headers %d/%d"), progress.done, progress.total));
+			break;
+
+		case LOAD_STAGE_PEAKS:
+			SetStatusText(wxString::Format(_("Loading project: computing waveforms %d/%d"), progress.done, progress.total));
+			break;
+
+		case LOAD_STAGE_DONE:
+			loader->Join();
+			GetMenuBar()->Enable(ID_CancelLoad, false);
+
+			if (progress.missing || progress.unreadable) {
+				SetStatusText(wxString::Format(_("Ready (%d files missing, %d unreadable)"), progress.missing, progress.unreadable));
+			} else {
+				SetStatusText(_("Ready"));
+			}
+			break;
 
-	for (size_t i=0; i<info->tracks.size(); i++) {
-		oamlTrackInfo *track = &info->tracks[i];
-		if (track->musicTrack) {
-			musicList->InsertItem(musicList->GetItemCount(), wxString(track->name));
-		} else if (track->sfxTrack) {
-			sfxList->InsertItem(sfxList->GetItemCount(), wxString(track->name));
-		}
+		case LOAD_STAGE_FAILED:
+			{ loader->Join();
+			GetMenuBar()->Enable(ID_CancelLoad, false);
+			if (playbackFrame) {
+				playbackFrame->EnableUpdates(true);
+			}
+			SetStatusText(_("Ready"));
+
+			wxMessageBox(_("Error loading project"));
+
+			wxFileName fname(defsPath);
+			for (size_t i=0; i<fileHistory->GetCount(); i++) {
+				if (fileHistory->GetHistoryFile(i) == fname.GetFullPath()) {
+					fileHistory->RemoveFileFromHistory(i);
+					break;
+				}
+			}
+			} break;
+
+		case LOAD_STAGE_CANCELLED:
+			loader->Join();
+			GetMenuBar()->Enable(ID_CancelLoad, false);
+			if (playbackFrame) {
+				playbackFrame->EnableUpdates(true);
+			}
+
+			if (progress.modelReady) {
+				// The tracks are usable, only the background work was stopped
+				SetStatusText(_("Ready (waveforms are computed on demand)"));
+			} else {
+				// Don't leave a half loaded project behind
+				studioApi->ProjectNew();
+				RebuildTrackIndex();
+				SetStatusText(_("Loading cancelled"));
+				startupFrame->Show(true);
+			}
+			break;
 	}
+}
 
-	settingsFrame->OnLoad();
+void StudioFrame::OnCancelLoad(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnCancelLoad");
+	loader->Cancel();
+	SetStatusText(_("Cancelling.."));
 }
 
 void StudioFrame::OnLoadProject(wxCommandEvent& event) {
+	TRACE_SCOPE("StudioFrame::OnLoadProject");
 	Load(event.GetString().ToStdString());
 }
 
 void StudioFrame::OnLoad(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnLoad");
 	wxFileDialog openFileDialog(this, _("Open oaml.defs"), wxEmptyString, "oaml.defs", "*.defs", wxFD_OPEN|wxFD_FILE_MUST_EXIST);
 	if (openFileDialog.ShowModal() == wxID_CANCEL)
 		return;
@@ -476,137 +711,19 @@ void StudioFrame::OnLoad(wxCommandEvent& WXUNUSED(event)) {
 }
 
 void StudioFrame::OnRecentFile(wxCommandEvent& event) {
+	TRACE_SCOPE("StudioFrame::OnRecentFile");
 	wxString path(fileHistory->GetHistoryFile(event.GetId() - wxID_FILE1));
 	if (path.empty() == false) {
 		Load(path.ToStdString());
 	}
 }
 
-void StudioFrame::AddSimpleChildToNode(tinyxml2::XMLNode *node, const char *name, const char *value) {
-	tinyxml2::XMLElement *el = node->GetDocument()->NewElement(name);
-	el->SetText(value);
-	node->InsertEndChild(el);
-}
-
-void StudioFrame::AddSimpleChildToNode(tinyxml2::XMLNode *node, const char *name, int value) {
-	tinyxml2::XMLElement *el = node->GetDocument()->NewElement(name);
-	el->SetText(value);
-	node->InsertEndChild(el);
-}
-
-void StudioFrame::AddSimpleChildToNode(tinyxml2::XMLNode *node, const char *name, float value) {
-	tinyxml2::XMLElement *el = node->GetDocument()->NewElement(name);
-	el->SetText(value);
-	node->InsertEndChild(el);
-}
-
-tinyxml2::XMLNode* StudioFrame::CreateAudioDefs(tinyxml2::XMLDocument& xmlDoc, oamlAudioInfo *audio, bool createPkg) {
-	tinyxml2::XMLNode *audioEl = xmlDoc.NewElement("audio");
-	if (audioEl == NULL)
-		return NULL;
-
-	AddSimpleChildToNode(audioEl, "name", audio->name.c_str());
-
-	for (std::vector<oamlAudioFileInfo>::iterator file=audio->files.begin(); file<audio->files.end(); ++file) {
-		tinyxml2::XMLElement *el = audioEl->GetDocument()->NewElement("filename");
-
-		if (createPkg) {
-			wxFileName fname(file->filename);
-			el->SetText(fname.GetFullName().ToStdString().c_str());
-		} else {
-			el->SetText(file->filename.c_str());
-		}
-
-		if (file->layer != "") {
-			el->SetAttribute("layer", file->layer.c_str());
-		}
-		if (file->randomChance != -1) {
-			el->SetAttribute("randomChance", file->randomChance);
-		}
-
-		audioEl->InsertEndChild(el);
-	}
-
-	if (audio->type) AddSimpleChildToNode(audioEl, "type", audio->type);
-	if (audio->volume) AddSimpleChildToNode(audioEl, "volume", audio->volume);
-	if (audio->bpm) AddSimpleChildToNode(audioEl, "bpm", audio->bpm);
-	if (audio->beatsPerBar) AddSimpleChildToNode(audioEl, "beatsPerBar", audio->beatsPerBar);
-	if (audio->bars) AddSimpleChildToNode(audioEl, "bars", audio->bars);
-	if (audio->minMovementBars) AddSimpleChildToNode(audioEl, "minMovementBars", audio->minMovementBars);
-	if (audio->randomChance) AddSimpleChildToNode(audioEl, "randomChance", audio->randomChance);
-	if (audio->playOrder) AddSimpleChildToNode(audioEl, "playOrder", audio->playOrder);
-	if (audio->fadeIn) AddSimpleChildToNode(audioEl, "fadeIn", audio->fadeIn);
-	if (audio->fadeOut) AddSimpleChildToNode(audioEl, "fadeOut", audio->fadeOut);
-	if (audio->xfadeIn) AddSimpleChildToNode(audioEl, "xfadeIn", audio->xfadeIn);
-	if (audio->xfadeOut) AddSimpleChildToNode(audioEl, "xfadeOut", audio->xfadeOut);
-	if (audio->condId) AddSimpleChildToNode(audioEl, "condId", audio->condId);
-	if (audio->condType) AddSimpleChildToNode(audioEl, "condType", audio->condType);
-	if (audio->condValue) AddSimpleChildToNode(audioEl, "condValue", audio->condValue);
-	if (audio->condValue2) AddSimpleChildToNode(audioEl, "condValue2", audio->condValue2);
-
-	return audioEl;
-}
-
-tinyxml2::XMLNode* StudioFrame::CreateTrackDefs(tinyxml2::XMLDocument& xmlDoc, oamlTrackInfo *track, bool createPkg) {
-	tinyxml2::XMLNode *trackEl = xmlDoc.NewElement("track");
-	if (track->sfxTrack) {
-		trackEl->ToElement()->SetAttribute("type", "sfx");
-	} else {
-		trackEl->ToElement()->SetAttribute("type", "music");
-	}
-
-	AddSimpleChildToNode(trackEl, "name", track->name.c_str());
-
-	if (track->groups.size() > 0) {
-		for (std::vector<std::string>::iterator it=track->groups.begin(); it<track->groups.end(); ++it) {
-			AddSimpleChildToNode(trackEl, "group", it->c_str());
-		}
-	}
-	if (track->subgroups.size() > 0) {
-		for (std::vector<std::string>::iterator it=track->subgroups.begin(); it<track->subgroups.end(); ++it) {
-			AddSimpleChildToNode(trackEl, "subgroup", it->c_str());
-		}
-	}
-	if (track->volume) AddSimpleChildToNode(trackEl, "volume", track->volume);
-	if (track->fadeIn) AddSimpleChildToNode(trackEl, "fadeIn", track->fadeIn);
-	if (track->fadeOut) AddSimpleChildToNode(trackEl, "fadeOut", track->fadeOut);
-	if (track->xfadeIn) AddSimpleChildToNode(trackEl, "xfadeIn", track->xfadeIn);
-	if (track->xfadeOut) AddSimpleChildToNode(trackEl, "xfadeOut", track->xfadeOut);
-
-	for (std::vector<oamlAudioInfo>::iterator audio=track->audios.begin(); audio<track->audios.end(); ++audio) {
-		tinyxml2::XMLNode *el = CreateAudioDefs(xmlDoc, &(*audio), createPkg);
-		if (el != NULL) {
-			trackEl->InsertEndChild(el);
-		}
-	}
-
-	return trackEl;
-}
-
-void StudioFrame::CreateDefs(tinyxml2::XMLDocument& xmlDoc, bool createPkg) {
-	xmlDoc.InsertFirstChild(xmlDoc.NewDeclaration());
-
-	oamlTracksInfo *info = oaml->GetTracksInfo();
-	tinyxml2::XMLNode *prjEl = xmlDoc.NewElement("project");
-
-	if (info->bpm) AddSimpleChildToNode(prjEl, "bpm", info->bpm);
-	if (info->beatsPerBar) AddSimpleChildToNode(prjEl, "beatsPerBar", info->beatsPerBar);
-
-	for (std::vector<oamlTrackInfo>::iterator track=info->tracks.begin(); track<info->tracks.end(); ++track) {
-		tinyxml2::XMLNode *el = CreateTrackDefs(xmlDoc, &(*track), createPkg);
-		if (el != NULL) {
-			prjEl->InsertEndChild(el);
-		}
-	}
-
-	xmlDoc.InsertEndChild(prjEl);
-}
-
 void StudioFrame::Save() {
+	TRACE_SCOPE("StudioFrame::Save");
 	tinyxml2::XMLDocument xmlDoc;
 
 	// Create the xml definitions and save the file
-	CreateDefs(xmlDoc);
+	ExportCreateDefs(xmlDoc, oaml->GetTracksInfo());
 	xmlDoc.SaveFile(defsPath.c_str());
 
 	// We've saved our changes, we're clean!
@@ -621,7 +738,7 @@ bool StudioFrame::SaveAs() {
 	defsPath = openFileDialog.GetPath();
 	wxFileName fname(defsPath);
 	projectPath = fname.GetPathWithSep();
-	InitCallbacks(projectPath);
+	SetProjectFiles(projectPath);
 
 	fileHistory->AddFileToHistory(defsPath);
 
@@ -630,121 +747,26 @@ bool StudioFrame::SaveAs() {
 }
 
 void StudioFrame::OnSave(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnSave");
+	if (IsLoading())
+		return;
+
 	Save();
 }
 
 void StudioFrame::OnSaveAs(wxCommandEvent& WXUNUSED(event)) {
-	SaveAs();
-}
-
-int StudioFrame::WriteDefsToZip(struct archive *zip) {
-	tinyxml2::XMLDocument xmlDoc;
-	tinyxml2::XMLPrinter printer;
-
-	CreateDefs(xmlDoc, true);
-	xmlDoc.Accept(&printer);
-	const char *buffer = printer.CStr();
-
-	struct archive_entry *entry = archive_entry_new();
-	if (entry == NULL) {
-		wxMessageBox(_("archive_entry_new error"));
-		return -1;
-	}
-
-	archive_entry_set_pathname(entry, "oaml.defs");
-	archive_entry_set_size(entry, strlen(buffer));
-	archive_entry_set_filetype(entry, AE_IFREG);
-	archive_entry_set_perm(entry, 0644);
-	archive_write_header(zip, entry);
-	if (archive_write_data(zip, buffer, strlen(buffer)) != strlen(buffer)) {
-		wxMessageBox(_("archive_write_data error"));
-		return -1;
-	}
-	archive_entry_free(entry);
-
-	return 0;
-}
-
-int StudioFrame::WriteFileToZip(struct archive *zip, std::string file) {
-	const char *filename = file.c_str();
-	void *fd = studioCbs.open(filename);
-	if (fd == NULL) {
-		wxString str;
-		str.Printf(wxT("Error creating file %s"), filename);
-		wxMessageBox(str);
-
-		return -1;
-	}
-
-	studioCbs.seek(fd, 0, SEEK_END);
-	size_t size = studioCbs.tell(fd);
-	studioCbs.seek(fd, 0, SEEK_SET);
-
-	wxFileName fname(filename);
-
-	struct archive_entry *entry = archive_entry_new();
-	if (entry == NULL) {
-		wxMessageBox(_("archive_entry_new error"));
-		return -1;
-	}
-
-	archive_entry_set_pathname(entry, fname.GetFullName().ToStdString().c_str());
-	archive_entry_set_size(entry, size);
-	archive_entry_set_filetype(entry, AE_IFREG);
-	archive_entry_set_perm(entry, 0644);
-	archive_write_header(zip, entry);
-
-	char buffer[4096];
-	while (size > 0) {
-		int bytes = studioCbs.read(buffer, 1, 4096, fd);
-		if (bytes == 0) break;
-
-		if (archive_write_data(zip, buffer, bytes) != bytes) {
-			studioCbs.close(fd);
-			wxMessageBox(_("archive_write_data error"));
-			return -1;
-		}
-	}
-
-	studioCbs.close(fd);
-	archive_entry_free(entry);
-
-	return 0;
-}
-
-int StudioFrame::CreateZip(std::string zfile, std::vector<std::string> files) {
-	struct archive *zip;
-
-	zip = archive_write_new();
-	if (zip == NULL) {
-		wxMessageBox(_("archive_write_new error"));
-		return -1;
-	}
-	archive_write_set_format_zip(zip);
-//	archive_write_zip_set_compression_store(zip);
-	archive_write_open_filename(zip, zfile.c_str());
-
-	if (WriteDefsToZip(zip)) {
-		archive_write_close(zip);
-		archive_write_finish(zip);
-		return -1;
-	}
-
-	for (size_t i=0; i<files.size(); i++) {
-		if (WriteFileToZip(zip, files[i])) {
-			archive_write_close(zip);
-			archive_write_finish(zip);
-			return -1;
-		}
-	}
-
-	archive_write_close(zip);
-	archive_write_finish(zip);
+	TRACE_SCOPE("StudioFrame::OnSaveAs");
+	if (IsLoading())
+		return;
 
-	return 0;
+	SaveAs();
 }
 
 void StudioFrame::OnExport(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnExport");
+	if (IsLoading())
+		return;
+
 	std::vector<std::string> list;
 
 	oamlTracksInfo* info = oaml->GetTracksInfo();
@@ -760,10 +782,14 @@ void StudioFrame::OnExport(wxCommandEvent& WXUNUSED(event)) {
 	if (openFileDialog.ShowModal() == wxID_CANCEL)
 		return;
 
-	CreateZip(wxString(openFileDialog.GetPath()).ToStdString(), list);
+	std::string error;
+	if (ExportCreateZip(wxString(openFileDialog.GetPath()).ToStdString(), info, list, error)) {
+		wxMessageBox(error);
+	}
 }
 
 void StudioFrame::OnAbout(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnAbout");
 	wxString str;
 
 	// TODO - Make a nice custom dialog
@@ -780,6 +806,10 @@ void StudioFrame::OnAbout(wxCommandEvent& WXUNUSED(event)) {
 }
 
 void StudioFrame::OnAddMusicTrack(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnAddMusicTrack");
+	if (IsLoading())
+		return;
+
 	oamlTracksInfo *info = oaml->GetTracksInfo();
 	int index = info ? info->tracks.size() : 0;
 
@@ -787,13 +817,21 @@ void StudioFrame::OnAddMusicTrack(wxCommandEvent& WXUNUSED(event)) {
 	snprintf(name, 1024, "Track%d", index);
 	studioApi->TrackNew(std::string(name), false);
 
-	musicList->InsertItem(index, wxString(name));
+	// Make sure the new track isn't hidden by the current search
+	searchCtrl->Clear();
+	RebuildTrackIndex();
 	SelectTrack(name);
 
-	musicList->EditLabel(index);
+	long item = musicList->FindTrack(name);
+	musicList->EnsureVisible(item);
+	musicList->EditLabel(item);
 }
 
 void StudioFrame::OnAddSfxTrack(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnAddSfxTrack");
+	if (IsLoading())
+		return;
+
 	oamlTracksInfo *info = oaml->GetTracksInfo();
 	int index = info ? info->tracks.size() : 0;
 
@@ -801,23 +839,36 @@ void StudioFrame::OnAddSfxTrack(wxCommandEvent& WXUNUSED(event)) {
 	snprintf(name, 1024, "Track%d", index);
 	studioApi->TrackNew(std::string(name), true);
 
-	sfxList->InsertItem(index, wxString(name));
+	// Make sure the new track isn't hidden by the current search
+	searchCtrl->Clear();
+	RebuildTrackIndex();
 	SelectTrack(name);
 
-	sfxList->EditLabel(index);
+	long item = sfxList->FindTrack(name);
+	sfxList->EnsureVisible(item);
+	sfxList->EditLabel(item);
 }
 
 void StudioFrame::OnEditMusicTrackName(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnEditMusicTrackName");
 	musicList->EditLabel(musicList->GetFirstSelected());
 }
 
 void StudioFrame::OnEditSfxTrackName(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnEditSfxTrackName");
 	sfxList->EditLabel(sfxList->GetFirstSelected());
 }
 
 void StudioFrame::OnRemoveMusicTrack(wxCommandEvent& WXUNUSED(event)) {
-	wxString str = musicList->GetItemText(musicList->GetFirstSelected());
-	std::string name = str.ToStdString();
+	TRACE_SCOPE("StudioFrame::OnRemoveMusicTrack");
+	if (IsLoading())
+		return;
+
+	std::string name = musicList->GetTrackName(musicList->GetFirstSelected());
+	if (name == "")
+		return;
+
+	wxString str(name);
 
 	wxString msg = "Are you sure you want to remove track '" + str + "'?";
 	int ret = wxMessageBox(msg, "Confirm", wxYES_NO, this);
@@ -830,45 +881,52 @@ void StudioFrame::OnRemoveMusicTrack(wxCommandEvent& WXUNUSED(event)) {
 		SelectTrack("");
 	}
 
-	// Remove the track from the list
-	musicList->DeleteItem(musicList->GetFirstSelected());
-
-	// Remove the track from oaml
+	// Remove the track from oaml and the list
 	studioApi->TrackRemove(name);
 
-	// Mark the project dirty
+	// Mark the project dirty, then rebuild the index it just invalidated
 	SetProjectDirty();
+	RebuildTrackIndex();
 }
 
 void StudioFrame::OnRemoveSfxTrack(wxCommandEvent& WXUNUSED(event)) {
-	wxString str = sfxList->GetItemText(sfxList->GetFirstSelected());
-	std::string name = str.ToStdString();
+	TRACE_SCOPE("StudioFrame::OnRemoveSfxTrack");
+	if (IsLoading())
+		return;
+
+	std::string name = sfxList->GetTrackName(sfxList->GetFirstSelected());
+	if (name == "")
+		return;
 
 	// If the track is currently selected deselect it
 	if (trackControl && trackControl->GetTrackName() == name) {
 		SelectTrack("");
 	}
 
-	// Remove the track from the list
-	sfxList->DeleteItem(sfxList->GetFirstSelected());
-
-	// Remove the track from oaml
+	// Remove the track from oaml and the list
 	studioApi->TrackRemove(name);
 
-	// Mark the project dirty
+	// Mark the project dirty, then rebuild the index it just invalidated
 	SetProjectDirty();
+	RebuildTrackIndex();
 }
 
-void StudioFrame::OnSelectAudio(wxCommandEvent& event) {
-	std::string str = event.GetString().ToStdString();
-	int len = event.GetInt();
+void StudioFrame::SelectAudio(std::string audioName, std::string filename, bool extend) {
+	if (trackPane) {
+		trackPane->SelectAudio(audioName, filename, extend);
+	}
 
 	if (controlPane) {
-		controlPane->OnSelectAudio(str.substr(0, len), str.substr(len));
+		if (trackPane) {
+			controlPane->OnSelectAudios(trackPane->GetSelection());
+		} else {
+			controlPane->OnSelectAudio(audioName, filename);
+		}
 	}
 }
 
 void StudioFrame::OnAddAudio(wxCommandEvent& event) {
+	TRACE_SCOPE("StudioFrame::OnAddAudio");
 	if (controlPane == NULL)
 		return;
 
@@ -879,6 +937,7 @@ void StudioFrame::OnAddAudio(wxCommandEvent& event) {
 }
 
 void StudioFrame::OnAddLayer(wxCommandEvent& event) {
+	TRACE_SCOPE("StudioFrame::OnAddLayer");
 /*	oamlAudioInfo* audio = GetAudioInfo(controlPane->GetTrackName(), event.GetString().ToStdString());
 	if (audio == NULL)
 		return;
@@ -890,6 +949,7 @@ void StudioFrame::OnAddLayer(wxCommandEvent& event) {
 }
 
 void StudioFrame::OnRemoveAudio(wxCommandEvent& event) {
+	TRACE_SCOPE("StudioFrame::OnRemoveAudio");
 	if (controlPane) {
 		controlPane->OnSelectAudio("", "");
 	}
@@ -901,55 +961,226 @@ void StudioFrame::OnRemoveAudio(wxCommandEvent& event) {
 }
 
 void StudioFrame::OnPlay(wxCommandEvent& WXUNUSED(event)) {
-	if (controlPane == NULL)
+	TRACE_SCOPE("StudioFrame::OnPlay");
+	if (controlPane == NULL || IsLoading())
 		return;
 
 	if (controlPane->IsMusicMode()) {
 		oaml->PlayTrack(controlPane->GetTrack());
+		GetPlaybackFrame()->SetPlayingTrack(controlPane->GetTrack());
+		if (trackPane) {
+			trackPane->StartPlayhead();
+		}
 	} else {
 		oaml->PlaySfx(controlPane->GetAudioName());
+		GetPlaybackFrame()->SetPlayingTrack("");
+	}
+
+	GetPlaybackFrame()->Wake();
+}
+
+void StudioFrame::OnBounce(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnBounce");
+	if (IsLoading())
+		return;
+
+	// Every bounce loads the project from disk on its own oaml instance
+	if (defsPath == "") {
+		wxMessageBox(_("The project must be saved before bouncing"));
+		return;
+	}
+	if (dirty) {
+		int ret = wxMessageBox(_("The project has unsaved changes, save it before bouncing?"), _("Confirm"), wxYES_NO | wxCANCEL, this);
+		if (ret == wxCANCEL)
+			return;
+		if (ret == wxYES)
+			Save();
+	}
+
+	wxArrayString names;
+	oamlTracksInfo *info = oaml->GetTracksInfo();
+	for (std::vector<oamlTrackInfo>::iterator track=info->tracks.begin(); track<info->tracks.end(); ++track) {
+		if (track->musicTrack) {
+			names.Add(wxString(track->name));
+		}
+	}
+	if (names.GetCount() == 0) {
+		wxMessageBox(_("There are no music tracks to bounce"));
+		return;
+	}
+
+	wxMultiChoiceDialog tracksDialog(this, _("Tracks to bounce"), _("Bounce to WAV"), names);
+	if (tracksDialog.ShowModal() == wxID_CANCEL)
+		return;
+
+	wxArrayInt selections = tracksDialog.GetSelections();
+	if (selections.GetCount() == 0)
+		return;
+
+	long seconds = wxGetNumberFromUser(_("Length of each bounce"), _("Seconds:"), _("Bounce to WAV"), 600, 1, 36000, this);
+	if (seconds == -1)
+		return;
+
+	wxArrayString formats;
+	formats.Add(_("16 bit"));
+	formats.Add(_("24 bit"));
+	formats.Add(_("32 bit"));
+	formats.Add(_("32 bit float"));
+	int formatIds[] = { AF_FORMAT_SINT16, AF_FORMAT_SINT24, AF_FORMAT_SINT32, AF_FORMAT_FLOAT32 };
+
+	int formatIndex = wxGetSingleChoiceIndex(_("Sample format"), _("Bounce to WAV"), formats, this);
+	if (formatIndex == -1)
+		return;
+
+	CondTimeline timeline;
+	if (wxMessageBox(_("Drive the conditions from a timeline script?"), _("Bounce to WAV"), wxYES_NO, this) == wxYES) {
+		wxFileDialog openFileDialog(this, _("Open condition timeline"), wxEmptyString, "", "*.*", wxFD_OPEN|wxFD_FILE_MUST_EXIST);
+		if (openFileDialog.ShowModal() == wxID_CANCEL)
+			return;
+
+		std::string error;
+		if (timeline.Load(openFileDialog.GetPath().ToStdString().c_str(), &error) != 0) {
+			wxMessageBox(wxString::Format(_("Error loading timeline: %s"), error.c_str()));
+			return;
+		}
+	}
+
+	wxDirDialog dirDialog(this, _("Output directory"), wxString(projectPath));
+	if (dirDialog.ShowModal() == wxID_CANCEL)
+		return;
+
+	OfflineBounce bounce(wxFileName(defsPath).GetFullName().ToStdString(), 44100, 2, formatIds[formatIndex]);
+	for (size_t i=0; i<selections.GetCount(); i++) {
+		wxString name = names.Item(selections.Item(i));
+		wxString safeName = name;
+		safeName.Replace("/", "_");
+		safeName.Replace("\\", "_");
+		safeName.Replace(":", "_");
+
+		wxFileName outFile(dirDialog.GetPath(), safeName + ".wav");
+		bounce.AddJob(name.ToStdString(), outFile.GetFullPath().ToStdString(), (double)seconds, timeline);
+	}
+
+	wxProgressDialog progress(_("Bounce to WAV"), _("Rendering.."), 1000, this, wxPD_APP_MODAL | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME | wxPD_REMAINING_TIME);
+
+	std::thread worker(&OfflineBounce::Run, &bounce, 0);
+	while (bounce.IsFinished() == false) {
+		wxMilliSleep(50);
+		if (progress.Update((int)(bounce.GetProgress() * 999)) == false) {
+			bounce.Cancel();
+		}
+	}
+	worker.join();
+
+	if (bounce.IsCancelled()) {
+		SetStatusText(_("Bounce cancelled"));
+		return;
+	}
+
+	wxString errors;
+	const std::vector<bounceJob>& jobs = bounce.GetJobs();
+	for (std::vector<bounceJob>::const_iterator it=jobs.begin(); it<jobs.end(); ++it) {
+		if (it->result != 0) {
+			errors+= wxString::Format("%s: %s\n", it->trackName.c_str(), it->error.c_str());
+		}
+	}
+
+	if (errors.IsEmpty() == false) {
+		wxMessageBox(_("Some tracks couldn't be bounced:\n") + errors);
+	} else {
+		SetStatusText(wxString::Format(_("Bounced %d tracks"), (int)jobs.size()));
 	}
 }
 
 void StudioFrame::OnPlaybackPanel(wxCommandEvent& WXUNUSED(event)) {
-	bool show = playbackFrame->IsShown() ? false : true;
+	TRACE_SCOPE("StudioFrame::OnPlaybackPanel");
+	bool show = GetPlaybackFrame()->IsShown() ? false : true;
 	playbackFrame->Show(show);
 	viewMenu->Check(ID_PlaybackPanel, show);
 }
 
 void StudioFrame::OnClosePlayback(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnClosePlayback");
 	playbackFrame->Show(false);
 	viewMenu->Check(ID_PlaybackPanel, false);
 }
 
+void StudioFrame::OnMetersPanel(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnMetersPanel");
+	bool show = GetMeterFrame()->IsShown() ? false : true;
+	meterFrame->Show(show);
+	viewMenu->Check(ID_MetersPanel, show);
+}
+
+void StudioFrame::OnCloseMeters(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnCloseMeters");
+	meterFrame->Show(false);
+	viewMenu->Check(ID_MetersPanel, false);
+}
+
+void StudioFrame::OnDiagnosticsPanel(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnDiagnosticsPanel");
+	bool show = GetDiagnosticsFrame()->IsShown() ? false : true;
+	diagnosticsFrame->Show(show);
+	viewMenu->Check(ID_DiagnosticsPanel, show);
+}
+
+void StudioFrame::OnCloseDiagnostics(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnCloseDiagnostics");
+	diagnosticsFrame->Show(false);
+	viewMenu->Check(ID_DiagnosticsPanel, false);
+}
+
 void StudioFrame::OnSettingsPanel(wxCommandEvent& WXUNUSED(event)) {
-	bool show = settingsFrame->IsShown() ? false : true;
+	TRACE_SCOPE("StudioFrame::OnSettingsPanel");
+	bool show = GetSettingsFrame()->IsShown() ? false : true;
 	settingsFrame->Show(show);
 	settingsFrame->Center();
 	viewMenu->Check(ID_SettingsPanel, show);
 }
 
 void StudioFrame::OnCloseSettings(wxCommandEvent& WXUNUSED(event)) {
+	TRACE_SCOPE("StudioFrame::OnCloseSettings");
 	settingsFrame->Show(false);
 	viewMenu->Check(ID_SettingsPanel, false);
 }
 
-void StudioFrame::OnUpdateAudioName(wxCommandEvent& event) {
-	if (controlPane == NULL)
+void StudioFrame::OnRecordTrace(wxCommandEvent& WXUNUSED(event)) {
+	if (TraceIsRecording() == false) {
+		TraceStart();
+		viewMenu->Check(ID_RecordTrace, true);
+		SetStatusText(_("Recording trace"));
 		return;
+	}
 
-	std::string str = event.GetString().ToStdString();
-	int len = event.GetInt();
-	if (trackPane) {
-		trackPane->UpdateAudioName(str.substr(0, len), str.substr(len));
+	TraceStop();
+	viewMenu->Check(ID_RecordTrace, false);
+	SetStatusText(_("Ready"));
+
+	wxFileDialog saveFileDialog(this, _("Save trace"), wxEmptyString, "oamlStudio-trace.json", "*.json", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+	if (saveFileDialog.ShowModal() == wxID_CANCEL)
+		return;
+
+	if (TraceWriteJson(saveFileDialog.GetPath().ToStdString().c_str()) == -1) {
+		wxMessageBox(_("Error writing the trace"));
 	}
 }
 
-void StudioFrame::OnSetStatusText(wxCommandEvent& event) {
-	SetStatusText(event.GetString());
+void StudioFrame::UpdateAudioName(std::string trackName, std::string oldName, std::string newName) {
+	if (controlPane == NULL || controlPane->GetTrackName() != trackName)
+		return;
+
+	if (trackPane) {
+		trackPane->UpdateAudioName(oldName, newName);
+	}
 }
 
-void StudioFrame::OnUpdateLayout(wxCommandEvent& WXUNUSED(event)) {
+void StudioFrame::UpdateLayout() {
+	TRACE_SCOPE("StudioFrame::UpdateLayout");
+	if (trackPane) {
+		trackPane->UpdateLayout();
+	}
+
 	Layout();
 }
 
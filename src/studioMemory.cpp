@@ -0,0 +1,287 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+#include <set>
+
+#include "oamlCore.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#else
+#include <unistd.h>
+#endif
+
+
+static const char *memNames[MEM_SUBSYSTEMS] = {
+	"Decoded PCM",
+	"Waveform peaks",
+	"Peak cache",
+	"Widgets",
+	"Decoders",
+	"Project model",
+	"Export buffers"
+};
+
+static const char *memKeys[MEM_SUBSYSTEMS] = {
+	"Pcm",
+	"Peaks",
+	"PeakCache",
+	"Widgets",
+	"Decoders",
+	"Project",
+	"Export"
+};
+
+static std::atomic<int64_t> memBytes[MEM_SUBSYSTEMS];
+static std::atomic<int64_t> memPeakBytes[MEM_SUBSYSTEMS];
+static std::atomic<int64_t> memObjects[MEM_SUBSYSTEMS];
+static std::atomic<int64_t> memBudget[MEM_SUBSYSTEMS];
+static std::atomic<bool> memOverBudget[MEM_SUBSYSTEMS];
+
+// Per file and per kind detail, only touched when something is charged to
+// a file or an object is created, never from the audio callback
+static std::mutex memMutex;
+static std::map<std::string, int64_t> memFiles;
+static std::map<std::string, int64_t> memDecoded;
+static std::map<std::string, int64_t> memKinds;
+
+void MemCharge(int subsystem, const std::string& file, int64_t delta) {
+	if (delta == 0)
+		return;
+
+	int64_t bytes = memBytes[subsystem].fetch_add(delta, std::memory_order_relaxed) + delta;
+	int64_t peak = memPeakBytes[subsystem].load(std::memory_order_relaxed);
+	while (bytes > peak && memPeakBytes[subsystem].compare_exchange_weak(peak, bytes, std::memory_order_relaxed) == false) {
+	}
+
+	int64_t budget = memBudget[subsystem].load(std::memory_order_relaxed);
+	if (budget > 0 && bytes > budget) {
+		if (memOverBudget[subsystem].exchange(true) == false) {
+			fprintf(stderr, "oamlStudio: %s over budget: %.1f MB of %.1f MB\n", memNames[subsystem], bytes / 1048576.0, budget / 1048576.0);
+		}
+	} else {
+		memOverBudget[subsystem].store(false, std::memory_order_relaxed);
+	}
+
+	if (file.empty() == false) {
+		std::lock_guard<std::mutex> lock(memMutex);
+		int64_t& held = memFiles[file];
+		held+= delta;
+		if (held <= 0) {
+			memFiles.erase(file);
+		}
+	}
+}
+
+void MemAddObjects(int subsystem, const char *kind, int delta) {
+	memObjects[subsystem].fetch_add(delta, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(memMutex);
+	memKinds[kind]+= delta;
+}
+
+void MemGet(int subsystem, memCounter& out) {
+	out.bytes = memBytes[subsystem].load(std::memory_order_relaxed);
+	out.peakBytes = memPeakBytes[subsystem].load(std::memory_order_relaxed);
+	out.objects = memObjects[subsystem].load(std::memory_order_relaxed);
+	out.budget = memBudget[subsystem].load(std::memory_order_relaxed);
+}
+
+void MemGetObjects(std::map<std::string, int64_t>& out) {
+	std::lock_guard<std::mutex> lock(memMutex);
+	out = memKinds;
+}
+
+void MemResetPeaks() {
+	for (int i=0; i<MEM_SUBSYSTEMS; i++) {
+		memPeakBytes[i].store(memBytes[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+}
+
+void MemSetBudget(int subsystem, int64_t bytes) {
+	memBudget[subsystem].store(bytes, std::memory_order_relaxed);
+	memOverBudget[subsystem].store(false, std::memory_order_relaxed);
+}
+
+const char* MemGetName(int subsystem) {
+	return memNames[subsystem];
+}
+
+const char* MemGetKey(int subsystem) {
+	return memKeys[subsystem];
+}
+
+void MemSetDecodedSize(const std::string& file, int64_t bytes) {
+	std::lock_guard<std::mutex> lock(memMutex);
+	memDecoded[file] = bytes;
+}
+
+// Short strings live inside the std::string itself
+static int64_t MemStringBytes(const std::string& str) {
+	return str.capacity() > 15 ? (int64_t)str.capacity() + 1 : 0;
+}
+
+static int64_t MemEstimateTrack(const oamlTrackInfo& track) {
+	int64_t bytes = sizeof(oamlTrackInfo) + MemStringBytes(track.name);
+
+	bytes+= (track.groups.capacity() + track.subgroups.capacity()) * sizeof(std::string);
+	for (size_t i=0; i<track.groups.size(); i++) {
+		bytes+= MemStringBytes(track.groups[i]);
+	}
+	for (size_t i=0; i<track.subgroups.size(); i++) {
+		bytes+= MemStringBytes(track.subgroups[i]);
+	}
+
+	bytes+= track.audios.capacity() * sizeof(oamlAudioInfo);
+	for (size_t i=0; i<track.audios.size(); i++) {
+		const oamlAudioInfo& audio = track.audios[i];
+		bytes+= MemStringBytes(audio.name);
+		bytes+= audio.files.capacity() * sizeof(oamlAudioFileInfo);
+		for (size_t j=0; j<audio.files.size(); j++) {
+			bytes+= MemStringBytes(audio.files[j].filename) + MemStringBytes(audio.files[j].layer);
+		}
+	}
+
+	return bytes;
+}
+
+// Measured on the copy GetTracksInfo() hands out, the model inside oaml is
+// built from the same definitions and comes out about the same size
+int64_t MemEstimateProject(oamlTracksInfo *info) {
+	if (info == NULL)
+		return 0;
+
+	int64_t bytes = sizeof(oamlTracksInfo) + info->tracks.capacity() * sizeof(oamlTrackInfo);
+	for (size_t i=0; i<info->tracks.size(); i++) {
+		bytes+= MemEstimateTrack(info->tracks[i]) - sizeof(oamlTrackInfo);
+	}
+	return bytes;
+}
+
+// A file used by several audios of a track counts once for it, but counts
+// for every track that uses it
+void MemGetTrackUsage(oamlTracksInfo *info, std::vector<memTrackUsage>& out) {
+	out.clear();
+	if (info == NULL)
+		return;
+
+	std::lock_guard<std::mutex> lock(memMutex);
+
+	for (size_t i=0; i<info->tracks.size(); i++) {
+		const oamlTrackInfo& track = info->tracks[i];
+
+		memTrackUsage usage;
+		usage.name = track.name;
+		usage.files = 0;
+		usage.decodedBytes = 0;
+		usage.heldBytes = 0;
+		usage.modelBytes = MemEstimateTrack(track);
+
+		std::set<std::string> seen;
+		for (size_t j=0; j<track.audios.size(); j++) {
+			const std::vector<oamlAudioFileInfo>& files = track.audios[j].files;
+			for (size_t k=0; k<files.size(); k++) {
+				if (seen.insert(files[k].filename).second == false)
+					continue;
+
+				usage.files++;
+
+				std::map<std::string, int64_t>::iterator it = memDecoded.find(files[k].filename);
+				if (it != memDecoded.end()) {
+					usage.decodedBytes+= it->second;
+				}
+
+				it = memFiles.find(files[k].filename);
+				if (it != memFiles.end()) {
+					usage.heldBytes+= it->second;
+				}
+			}
+		}
+
+		out.push_back(usage);
+	}
+}
+
+// Resident set size, 0 where we can't tell
+int64_t MemGetProcessBytes() {
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS pmc;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+		return (int64_t)pmc.WorkingSetSize;
+	return 0;
+#elif defined(__APPLE__)
+	mach_task_basic_info_data_t info;
+	mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+	if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS)
+		return (int64_t)info.resident_size;
+	return 0;
+#else
+	FILE *f = fopen("/proc/self/statm", "r");
+	if (f == NULL)
+		return 0;
+
+	long long pages = 0;
+	long long resident = 0;
+	if (fscanf(f, "%lld %lld", &pages, &resident) != 2) {
+		resident = 0;
+	}
+	fclose(f);
+	return (int64_t)resident * sysconf(_SC_PAGESIZE);
+#endif
+}
+
+void MemTraceCounters() {
+	if (TraceIsRecording() == false)
+		return;
+
+	for (int i=0; i<MEM_SUBSYSTEMS; i++) {
+		TraceCounter(memNames[i], memBytes[i].load(std::memory_order_relaxed));
+	}
+	TraceCounter("Process resident", MemGetProcessBytes());
+}
+
+void MemAccount::SetFile(const std::string& _file) {
+	if (_file == file)
+		return;
+
+	// Moves the charge over, the subsystem total stays the same
+	if (bytes) {
+		MemCharge(subsystem, file, -bytes);
+		MemCharge(subsystem, _file, bytes);
+	}
+	file = _file;
+}
+
+void MemAccount::Set(int64_t _bytes) {
+	MemCharge(subsystem, file, _bytes - bytes);
+	bytes = _bytes;
+}
@@ -0,0 +1,224 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <mutex>
+
+#include "oamlCore.h"
+
+
+std::atomic<bool> traceEnabled(false);
+thread_local std::atomic<const char*> traceScopeName(NULL);
+
+// Buffers are never freed. Once its thread exits a buffer goes to the next
+// new thread, but only if nothing was recorded in it since the last start,
+// so the spans of finished workers stay in the dump.
+static std::mutex traceMutex;
+static std::vector<traceBuffer*> traceBuffers;
+static int traceNextTid = 1;
+
+class TraceThread {
+public:
+	traceBuffer *buffer;
+	char name[TRACE_THREAD_NAME];
+
+	TraceThread() : buffer(NULL) { name[0] = 0; }
+	~TraceThread() {
+		if (buffer) {
+			buffer->owned.store(false, std::memory_order_release);
+		}
+	}
+};
+
+static thread_local TraceThread traceThread;
+
+static traceBuffer* TraceGetBuffer() {
+	if (traceThread.buffer)
+		return traceThread.buffer;
+
+	std::lock_guard<std::mutex> lock(traceMutex);
+
+	traceBuffer *buffer = NULL;
+	for (size_t i=0; i<traceBuffers.size(); i++) {
+		traceBuffer *it = traceBuffers[i];
+		if (it->owned.load(std::memory_order_acquire) == false && it->head.load() == it->start.load()) {
+			buffer = it;
+			break;
+		}
+	}
+
+	if (buffer == NULL) {
+		buffer = new traceBuffer;
+		buffer->head = 0;
+		buffer->start = 0;
+		traceBuffers.push_back(buffer);
+	}
+
+	buffer->owned = true;
+	buffer->tid = traceNextTid++;
+	memcpy(buffer->name, traceThread.name, TRACE_THREAD_NAME);
+	buffer->start.store(buffer->head.load());
+
+	traceThread.buffer = buffer;
+	return buffer;
+}
+
+uint64_t TraceNowNs() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TraceStart() {
+	std::lock_guard<std::mutex> lock(traceMutex);
+
+	// Drop whatever was recorded before, the writers never see this
+	for (size_t i=0; i<traceBuffers.size(); i++) {
+		traceBuffers[i]->start.store(traceBuffers[i]->head.load(std::memory_order_acquire));
+	}
+
+	traceEnabled.store(true);
+}
+
+void TraceStop() {
+	traceEnabled.store(false);
+}
+
+bool TraceIsRecording() {
+	return traceEnabled.load(std::memory_order_relaxed);
+}
+
+// Kept aside until the thread records its first span
+void TraceSetThreadName(const char *name) {
+	snprintf(traceThread.name, TRACE_THREAD_NAME, "%s", name);
+	if (traceThread.buffer) {
+		memcpy(traceThread.buffer->name, traceThread.name, TRACE_THREAD_NAME);
+	}
+}
+
+// The address stays valid for as long as the calling thread runs
+std::atomic<const char*>* TraceGetScopeName() {
+	return &traceScopeName;
+}
+
+void TraceRecord(const char *name, uint64_t startNs, uint64_t endNs) {
+	traceBuffer *buffer = TraceGetBuffer();
+
+	uint64_t head = buffer->head.load(std::memory_order_relaxed);
+	traceEvent& ev = buffer->events[head % TRACE_BUFFER_EVENTS];
+	ev.name = name;
+	ev.type = TRACE_SPAN;
+	ev.startNs = startNs;
+	ev.endNs = endNs;
+	buffer->head.store(head + 1, std::memory_order_release);
+}
+
+// Counters with the same name make one graph, whichever thread samples them
+void TraceCounter(const char *name, int64_t value) {
+	if (traceEnabled.load(std::memory_order_relaxed) == false)
+		return;
+
+	traceBuffer *buffer = TraceGetBuffer();
+
+	uint64_t head = buffer->head.load(std::memory_order_relaxed);
+	traceEvent& ev = buffer->events[head % TRACE_BUFFER_EVENTS];
+	ev.name = name;
+	ev.type = TRACE_COUNTER;
+	ev.startNs = TraceNowNs();
+	ev.endNs = ev.startNs;
+	ev.value = value;
+	buffer->head.store(head + 1, std::memory_order_release);
+}
+
+static void TraceJsonName(FILE *f, const char *name) {
+	fputc('"', f);
+	for (const char *p = name; *p; p++) {
+		unsigned char c = *p;
+		if (c == '"' || c == '\\') {
+			fprintf(f, "\\%c", c);
+		} else if (c < 0x20) {
+			fprintf(f, "\\u%04x", c);
+		} else {
+			fputc(c, f);
+		}
+	}
+	fputc('"', f);
+}
+
+// Chrome trace event format, loads in chrome://tracing and ui.perfetto.dev.
+// Call it after TraceStop(), spans still being written while dumping may
+// come out torn once a ring wraps around.
+int TraceWriteJson(const char *filename) {
+	FILE *f = fopen(filename, "w");
+	if (f == NULL)
+		return -1;
+
+	std::lock_guard<std::mutex> lock(traceMutex);
+
+	uint64_t base = UINT64_MAX;
+	for (size_t i=0; i<traceBuffers.size(); i++) {
+		traceBuffer *buffer = traceBuffers[i];
+		uint64_t head = buffer->head.load(std::memory_order_acquire);
+		uint64_t start = buffer->start.load();
+		if (head - start > TRACE_BUFFER_EVENTS) start = head - TRACE_BUFFER_EVENTS;
+		for (uint64_t j=start; j<head; j++) {
+			uint64_t ts = buffer->events[j % TRACE_BUFFER_EVENTS].startNs;
+			if (ts < base) base = ts;
+		}
+	}
+
+	fprintf(f, "{\"traceEvents\": [");
+
+	bool first = true;
+	for (size_t i=0; i<traceBuffers.size(); i++) {
+		traceBuffer *buffer = traceBuffers[i];
+
+		if (buffer->name[0]) {
+			fprintf(f, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": ", first ? "" : ",", buffer->tid);
+			TraceJsonName(f, buffer->name);
+			fprintf(f, "}}");
+			first = false;
+		}
+
+		uint64_t head = buffer->head.load(std::memory_order_acquire);
+		uint64_t start = buffer->start.load();
+		if (head - start > TRACE_BUFFER_EVENTS) start = head - TRACE_BUFFER_EVENTS;
+
+		for (uint64_t j=start; j<head; j++) {
+			const traceEvent& ev = buffer->events[j % TRACE_BUFFER_EVENTS];
+
+			fprintf(f, "%s\n{\"name\": ", first ? "" : ",");
+			TraceJsonName(f, ev.name);
+			if (ev.type == TRACE_COUNTER) {
+				fprintf(f, ", \"ph\": \"C\", \"pid\": 1, \"ts\": %.3f, \"args\": {\"value\": %lld}}", (ev.startNs - base) / 1000.0, (long long)ev.value);
+			} else {
+				fprintf(f, ", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}", buffer->tid, (ev.startNs - base) / 1000.0, (ev.endNs - ev.startNs) / 1000.0);
+			}
+			first = false;
+		}
+	}
+
+	fprintf(f, "\n], \"displayTimeUnit\": \"ms\"}\n");
+
+	return fclose(f) == 0 ? 0 : -1;
+}
@@ -126,8 +126,7 @@ void TrackControl::OnVolumeChange(wxCommandEvent& WXUNUSED(event)) {
 		studioApi->TrackSetVolume(trackName, vol);
 
 		// Mark the project dirty
-		wxCommandEvent event(EVENT_SET_PROJECT_DIRTY);
-		wxPostEvent(GetParent(), event);
+		eventBus->PostDirty();
 	}
 }
 
@@ -140,8 +139,7 @@ void TrackControl::OnFadeInChange(wxCommandEvent& WXUNUSED(event)) {
 		studioApi->TrackSetFadeIn(trackName, value);
 
 		// Mark the project dirty
-		wxCommandEvent event(EVENT_SET_PROJECT_DIRTY);
-		wxPostEvent(GetParent(), event);
+		eventBus->PostDirty();
 	}
 }
 
@@ -154,8 +152,7 @@ void TrackControl::OnFadeOutChange(wxCommandEvent& WXUNUSED(event)) {
 		studioApi->TrackSetFadeOut(trackName, value);
 
 		// Mark the project dirty
-		wxCommandEvent event(EVENT_SET_PROJECT_DIRTY);
-		wxPostEvent(GetParent(), event);
+		eventBus->PostDirty();
 	}
 }
 
@@ -168,8 +165,7 @@ void TrackControl::OnXFadeInChange(wxCommandEvent& WXUNUSED(event)) {
 		studioApi->TrackSetXFadeIn(trackName, value);
 
 		// Mark the project dirty
-		wxCommandEvent event(EVENT_SET_PROJECT_DIRTY);
-		wxPostEvent(GetParent(), event);
+		eventBus->PostDirty();
 	}
 }
 
@@ -182,8 +178,7 @@ void TrackControl::OnXFadeOutChange(wxCommandEvent& WXUNUSED(event)) {
 		studioApi->TrackSetXFadeOut(trackName, value);
 
 		// Mark the project dirty
-		wxCommandEvent event(EVENT_SET_PROJECT_DIRTY);
-		wxPostEvent(GetParent(), event);
+		eventBus->PostDirty();
 	}
 }
 
@@ -0,0 +1,121 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "oamlCommon.h"
+
+
+TrackIndex::TrackIndex() {
+	generation = 0;
+	stale = false;
+}
+
+std::string TrackIndex::Normalize(const std::string& str) {
+	std::string ret = str;
+	for (size_t i=0; i<ret.size(); i++) {
+		ret[i] = (char)tolower((unsigned char)ret[i]);
+	}
+	return ret;
+}
+
+void TrackIndex::AddKey(const std::string& key) {
+	for (size_t i=0; i<key.size(); i++) {
+		text.push_back((char)tolower((unsigned char)key[i]));
+	}
+	text.push_back('\0');
+}
+
+void TrackIndex::Clear() {
+	entries.clear();
+	text.clear();
+
+	generation++;
+	stale = false;
+}
+
+void TrackIndex::Build(oamlTracksInfo *info) {
+	Clear();
+
+	if (info == NULL)
+		return;
+
+	entries.reserve(info->tracks.size());
+	for (std::vector<oamlTrackInfo>::iterator track=info->tracks.begin(); track<info->tracks.end(); ++track) {
+		trackIndexEntry entry;
+		entry.name = track->name;
+		entry.musicTrack = track->musicTrack;
+		entry.textBegin = text.size();
+
+		AddKey(track->name);
+		for (std::vector<oamlAudioInfo>::iterator audio=track->audios.begin(); audio<track->audios.end(); ++audio) {
+			AddKey(audio->name);
+			for (std::vector<oamlAudioFileInfo>::iterator file=audio->files.begin(); file<audio->files.end(); ++file) {
+				AddKey(file->filename);
+			}
+		}
+
+		entry.textEnd = text.size();
+		entries.push_back(entry);
+	}
+}
+
+bool TrackIndex::Matches(int index, const std::string& query) const {
+	if (query.empty())
+		return true;
+
+	// Fuzzy match, the query must be a subsequence of one of the keys
+	const char *p = text.data() + entries[index].textBegin;
+	const char *end = text.data() + entries[index].textEnd;
+	size_t q = 0;
+	for (; p < end; p++) {
+		if (*p == '\0') {
+			q = 0;
+		} else if (*p == query[q]) {
+			if (++q == query.size())
+				return true;
+		}
+	}
+
+	return false;
+}
+
+void TrackIndex::Filter(const std::string& query, bool musicTracks, const std::vector<int> *candidates, std::vector<int>& result) const {
+	result.clear();
+
+	if (candidates) {
+		for (std::vector<int>::const_iterator it=candidates->begin(); it<candidates->end(); ++it) {
+			if (Matches(*it, query)) {
+				result.push_back(*it);
+			}
+		}
+	} else {
+		for (int i=0; i<(int)entries.size(); i++) {
+			if (entries[i].musicTrack == musicTracks && Matches(i, query)) {
+				result.push_back(i);
+			}
+		}
+	}
+}
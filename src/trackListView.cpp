@@ -0,0 +1,84 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "oamlCommon.h"
+
+#include <wx/listctrl.h>
+
+
+TrackListView::TrackListView(wxWindow *parent, TrackIndex *_index, bool _musicTracks) : wxListView(parent, wxID_ANY, wxDefaultPosition, wxSize(240, -1), wxLC_REPORT | wxLC_VIRTUAL | wxLC_NO_HEADER | wxLC_EDIT_LABELS | wxLC_SINGLE_SEL) {
+	index = _index;
+	musicTracks = _musicTracks;
+	lastGeneration = -1;
+
+	InsertColumn(0, wxEmptyString, wxLIST_FORMAT_LEFT, 236);
+	SetItemCount(0);
+
+	Bind(wxEVT_SIZE, &TrackListView::OnSize, this);
+}
+
+void TrackListView::OnSize(wxSizeEvent& event) {
+	SetColumnWidth(0, GetClientSize().GetWidth());
+	event.Skip();
+}
+
+void TrackListView::Filter(std::string query) {
+	query = TrackIndex::Normalize(query);
+
+	// While the user keeps typing the results can only get narrower, so
+	// only the items already shown need to be checked again
+	bool narrow = lastGeneration == index->GetGeneration() && lastQuery.empty() == false && query.compare(0, lastQuery.size(), lastQuery) == 0;
+
+	std::vector<int> result;
+	index->Filter(query, musicTracks, narrow ? &items : NULL, result);
+	items.swap(result);
+
+	lastQuery = query;
+	lastGeneration = index->GetGeneration();
+
+	SetItemCount(items.size());
+	Refresh();
+}
+
+std::string TrackListView::GetTrackName(long item) const {
+	if (item < 0 || item >= (long)items.size())
+		return "";
+
+	return index->GetName(items[item]);
+}
+
+long TrackListView::FindTrack(std::string name) const {
+	for (size_t i=0; i<items.size(); i++) {
+		if (index->GetName(items[i]) == name)
+			return (long)i;
+	}
+
+	return -1;
+}
+
+wxString TrackListView::OnGetItemText(long item, long WXUNUSED(column)) const {
+	return wxString(GetTrackName(item));
+}
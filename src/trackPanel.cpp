@@ -23,6 +23,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 
 #include "oamlCommon.h"
 #include "tinyxml2.h"
@@ -51,6 +52,11 @@ TrackPanel::TrackPanel(wxWindow* parent, wxWindowID id, std::string name) : wxSc
 	musicMode = true;
 	panelCount = 3;
 
+	playheadTimer = new TrackPlayheadTimer(this);
+	audioStartMs = 0;
+	pausedMs = 0;
+	pausedSinceMs = -1;
+
 	SetBackgroundColour(wxColour(0x40, 0x40, 0x40));
 	SetScrollRate(50, 50);
 
@@ -61,18 +67,28 @@ TrackPanel::TrackPanel(wxWindow* parent, wxWindowID id, std::string name) : wxSc
 
 	sizer->Fit(this);
 
-	Bind(EVENT_UPDATE_LAYOUT, &TrackPanel::UpdateLayout, this);
+	MemAddObjects(MEM_WIDGETS, "TrackPanel", 1);
+}
+
+TrackPanel::~TrackPanel() {
+	delete playheadTimer;
+
+	MemAddObjects(MEM_WIDGETS, "TrackPanel", -1);
 }
 
-void TrackPanel::UpdateLayout(wxCommandEvent& event) {
+void TrackPanel::UpdateLayout() {
+	TRACE_SCOPE("TrackPanel::UpdateLayout");
+	for (int i=0; i<panelCount; i++) {
+		audioPanel[i]->UpdateLayout();
+	}
+
 	SetSizer(sizer);
 	Layout();
 	sizer->Fit(this);
-
-	wxPostEvent(GetParent(), event);
 }
 
 void TrackPanel::SetTrackMode(bool mode) {
+	TRACE_SCOPE("TrackPanel::SetTrackMode");
 	wxString musicTexts[3] = { "Intros", "Main loops", "Conditional loops" };
 	wxString sfxTexts[1] = { "Sfxs" };
 
@@ -104,21 +120,14 @@ int TrackPanel::GetPanelIndex(std::string audioFile) {
 }
 
 void TrackPanel::AddAudio(std::string audioFile) {
+	TRACE_SCOPE("TrackPanel::AddAudio");
 	int i = GetPanelIndex(audioFile);
 	audioPanel[i]->AddAudio(audioFile);
-
-	SetSizer(sizer);
-	Layout();
-	sizer->Fit(this);
 }
 
 void TrackPanel::RemoveAudio(std::string audioFile) {
 	int i = GetPanelIndex(audioFile);
 	audioPanel[i]->RemoveAudio(audioFile);
-
-	SetSizer(sizer);
-	Layout();
-	sizer->Fit(this);
 }
 
 void TrackPanel::UpdateTrackName(std::string oldName, std::string newName) {
@@ -136,4 +145,104 @@ void TrackPanel::UpdateAudioName(std::string oldName, std::string newName) {
 	for (int i=0; i<panelCount; i++) {
 		audioPanel[i]->UpdateAudioName(oldName, newName);
 	}
+
+	for (std::vector<audioSelection>::iterator it=selection.begin(); it<selection.end(); ++it) {
+		if (it->audioName == oldName) {
+			it->audioName = newName;
+		}
+	}
+}
+
+void TrackPanel::SelectAudio(std::string audioName, std::string filename, bool extend) {
+	TRACE_SCOPE("TrackPanel::SelectAudio");
+	audioSelection sel = { audioName, filename };
+
+	if (audioName == "") {
+		selection.clear();
+	} else if (extend) {
+		// Toggle the audio file in the current selection, the last one
+		// added is the one shown by the control panel
+		std::vector<audioSelection>::iterator it;
+		for (it=selection.begin(); it<selection.end(); ++it) {
+			if (it->audioName == audioName && it->filename == filename)
+				break;
+		}
+
+		if (it != selection.end()) {
+			selection.erase(it);
+		} else {
+			selection.push_back(sel);
+		}
+	} else {
+		selection.clear();
+		selection.push_back(sel);
+	}
+
+	UpdateSelection();
+}
+
+void TrackPanel::UpdateSelection() {
+	std::vector<audioSelection> sorted = selection;
+	std::sort(sorted.begin(), sorted.end(), AudioSelectionLess);
+
+	for (int i=0; i<panelCount; i++) {
+		audioPanel[i]->UpdateSelection(sorted);
+	}
+}
+
+void TrackPanel::StartPlayhead() {
+	audioStartMs = 0;
+	pausedMs = 0;
+	pausedSinceMs = -1;
+
+	playheadTimer->Start(PLAYHEAD_RATE);
+}
+
+void TrackPanel::UpdatePlayhead() {
+	if (oaml->IsPlaying() == false) {
+		ShowPlayTime("", -1);
+		playheadTimer->Stop();
+		return;
+	}
+
+	// The playback panel tells us which audio plays and since when
+	const playbackState& state = playbackCurrent;
+
+	if (state.playing == 0 || trackName != state.track || state.audio[0] == 0) {
+		ShowPlayTime("", -1);
+		return;
+	}
+
+	double now = PlaybackNowMs();
+	if (state.audioStartMs != audioStartMs) {
+		audioStartMs = state.audioStartMs;
+		pausedMs = 0;
+		pausedSinceMs = -1;
+	}
+
+	if (state.paused) {
+		if (pausedSinceMs < 0) pausedSinceMs = now;
+		return;
+	}
+
+	if (pausedSinceMs >= 0) {
+		pausedMs+= now - pausedSinceMs;
+		pausedSinceMs = -1;
+	}
+
+	ShowPlayTime(state.audio, now - audioStartMs - pausedMs);
+}
+
+void TrackPanel::ShowPlayTime(std::string audioName, double ms) {
+	for (int i=0; i<panelCount; i++) {
+		audioPanel[i]->SetPlayTime(audioName, ms);
+	}
+}
+
+TrackPlayheadTimer::TrackPlayheadTimer(TrackPanel* pane) : wxTimer() {
+	TrackPlayheadTimer::pane = pane;
+}
+
+void TrackPlayheadTimer::Notify() {
+	pane->UpdatePlayhead();
 }
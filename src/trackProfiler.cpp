@@ -0,0 +1,274 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "oamlCore.h"
+
+
+static uint64_t ElapsedNs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+static double NsPerFrame(uint64_t ns, long long frames) {
+	return frames > 0 ? (double)ns / frames : 0.0;
+}
+
+TrackProfiler::TrackProfiler(std::string _defsFile) {
+	defsFile = _defsFile;
+	fileContext = GetProjectFiles();
+	seconds = 120.0;
+	seed = 1;
+	sampleRate = 44100;
+	elapsedSeconds = 0;
+}
+
+int TrackProfiler::Run(std::string *error) {
+	results.clear();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	// A first instance just to list the tracks
+	oamlApi *api = new oamlApi();
+	api->SetFileCallbacks(fileContext->GetCallbacks());
+	if (api->Init(defsFile.c_str()) != OAML_OK) {
+		if (error) *error = "error loading " + defsFile;
+		delete api;
+		return -1;
+	}
+
+	std::vector<oamlTrackInfo> tracks;
+	oamlTracksInfo *info = api->GetTracksInfo();
+	if (trackNames.empty()) {
+		for (std::vector<oamlTrackInfo>::iterator it=info->tracks.begin(); it<info->tracks.end(); ++it) {
+			if (it->musicTrack) {
+				tracks.push_back(*it);
+			}
+		}
+	} else {
+		for (std::vector<std::string>::iterator name=trackNames.begin(); name<trackNames.end(); ++name) {
+			bool found = false;
+			for (std::vector<oamlTrackInfo>::iterator it=info->tracks.begin(); it<info->tracks.end(); ++it) {
+				if (it->name == *name) {
+					tracks.push_back(*it);
+					found = true;
+					break;
+				}
+			}
+
+			if (found == false) {
+				if (error) *error = "track not found: " + *name;
+				api->Shutdown();
+				delete api;
+				return -1;
+			}
+		}
+	}
+
+	api->Shutdown();
+	delete api;
+
+	// Every track starts from a fresh instance so they don't share decoders
+	for (std::vector<oamlTrackInfo>::iterator it=tracks.begin(); it<tracks.end(); ++it) {
+		api = new oamlApi();
+		api->SetFileCallbacks(fileContext->GetCallbacks());
+		if (api->Init(defsFile.c_str()) != OAML_OK) {
+			if (error) *error = "error loading " + defsFile;
+			delete api;
+			return -1;
+		}
+
+		profileTrackResult result;
+		int ret = ProfileTrack(api, *it, result);
+
+		api->Shutdown();
+		delete api;
+
+		if (ret != 0) {
+			if (error) *error = "error playing track " + it->name;
+			return -1;
+		}
+
+		results.push_back(result);
+	}
+
+	elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return 0;
+}
+
+int TrackProfiler::ProfileTrack(oamlApi *api, oamlTrackInfo& track, profileTrackResult& result) {
+	oamlStudioApi *studio = api->GetStudioApi();
+
+	result.trackName = track.name;
+	result.frames = 0;
+	result.mixNs = 0;
+	result.updateNs = 0;
+	result.worstBlockNsPerFrame = 0;
+	result.peakVoices = 0;
+	result.peakFilesReferenced = 0;
+	result.mixAllocs = 0;
+	result.mixAllocBytes = 0;
+	result.audios.clear();
+
+	std::vector<std::string> names;
+	for (std::vector<oamlAudioInfo>::iterator audio=track.audios.begin(); audio<track.audios.end(); ++audio) {
+		profileAudioResult ar;
+		ar.audioName = audio->name;
+		ar.frames = 0;
+		ar.trackMixNs = 0;
+		ar.peakVoices = 0;
+		ar.resampledFiles = 0;
+
+		// oaml converts files that aren't at the mix rate while mixing
+		std::vector<std::string> files;
+		studio->AudioGetAudioFileList(track.name, audio->name, files);
+		ar.files = (int)files.size();
+		for (std::vector<std::string>::iterator file=files.begin(); file<files.end(); ++file) {
+			audioFile *handle = CreateAudioFile(*file, fileContext->GetCallbacks());
+			if (handle == NULL)
+				continue;
+
+			if (handle->Open(file->c_str()) == 0 && handle->GetSamplesPerSec() != sampleRate) {
+				ar.resampledFiles++;
+			}
+			delete handle;
+		}
+
+		result.audios.push_back(ar);
+		names.push_back(audio->name);
+	}
+
+	// oaml picks random audios with rand(), seeding it makes runs repeatable
+	srand(seed);
+
+	api->SetAudioFormat(sampleRate, 2, 2);
+	if (api->PlayTrack(track.name.c_str()) != OAML_OK)
+		return -1;
+
+	int16_t block[PROFILE_BLOCK_FRAMES * 2];
+	long long totalFrames = (long long)(seconds * sampleRate);
+	std::vector<int> playing;
+
+	timeline.Rewind();
+	while (result.frames < totalFrames) {
+		double time = (double)result.frames / sampleRate;
+
+		condEvent ev;
+		while (timeline.PopDue(time, ev)) {
+			api->SetCondition(ev.condId, ev.condValue);
+		}
+
+		allocStats before;
+		allocStats after;
+		AllocCounterGet(before);
+
+		memset(block, 0, sizeof(block));
+
+		AllocCounterEnable(true);
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		api->MixToBuffer(block, PROFILE_BLOCK_FRAMES * 2);
+		std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+		AllocCounterEnable(false);
+
+		api->Update();
+		std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+		AllocCounterGet(after);
+		result.mixAllocs+= after.count - before.count;
+		result.mixAllocBytes+= after.bytes - before.bytes;
+
+		uint64_t mixNs = ElapsedNs(t0, t1);
+		result.mixNs+= mixNs;
+		result.updateNs+= ElapsedNs(t1, t2);
+		result.frames+= PROFILE_BLOCK_FRAMES;
+
+		double blockNsPerFrame = NsPerFrame(mixNs, PROFILE_BLOCK_FRAMES);
+		if (blockNsPerFrame > result.worstBlockNsPerFrame) {
+			result.worstBlockNsPerFrame = blockNsPerFrame;
+		}
+
+		// Everything named in the playing info is being mixed, fades and tails too
+		PlaybackFindAudios(api->GetPlayingInfo(), names, playing);
+
+		int voices = (int)playing.size();
+		int filesReferenced = 0;
+		for (std::vector<int>::iterator it=playing.begin(); it<playing.end(); ++it) {
+			profileAudioResult& ar = result.audios[*it];
+			ar.frames+= PROFILE_BLOCK_FRAMES;
+			ar.trackMixNs+= mixNs;
+			if (voices > ar.peakVoices) ar.peakVoices = voices;
+			filesReferenced+= ar.files;
+		}
+
+		if (voices > result.peakVoices) result.peakVoices = voices;
+		if (filesReferenced > result.peakFilesReferenced) result.peakFilesReferenced = filesReferenced;
+
+		if (api->IsPlaying() == false)
+			break;
+	}
+
+	return 0;
+}
+
+void TrackProfiler::WriteReport(FILE *f) const {
+	fprintf(f, "rate: %d Hz\n", sampleRate);
+	fprintf(f, "seed: %u\n", seed);
+	fprintf(f, "profiled: %d tracks in %.2f s\n", (int)results.size(), elapsedSeconds);
+
+	for (std::vector<profileTrackResult>::const_iterator it=results.begin(); it<results.end(); ++it) {
+		fprintf(f, "\ntrack: %s (%.1f s)\n", it->trackName.c_str(), (double)it->frames / sampleRate);
+		fprintf(f, "  mix: %.1f ns/frame, worst block %.1f ns/frame\n", NsPerFrame(it->mixNs, it->frames), it->worstBlockNsPerFrame);
+		fprintf(f, "  update: %.1f ns/frame\n", NsPerFrame(it->updateNs, it->frames));
+		fprintf(f, "  peak voices: %d, peak files referenced: %d\n", it->peakVoices, it->peakFilesReferenced);
+		fprintf(f, "  allocations while mixing: %llu (%llu bytes)\n", (unsigned long long)it->mixAllocs, (unsigned long long)it->mixAllocBytes);
+
+		fprintf(f, "  %-24s %5s %9s %9s %14s %6s\n", "audio", "files", "resampled", "played s", "track ns/frame", "voices");
+		for (std::vector<profileAudioResult>::const_iterator audio=it->audios.begin(); audio<it->audios.end(); ++audio) {
+			fprintf(f, "  %-24s %5d %9d %9.1f %14.1f %6d\n", audio->audioName.c_str(), audio->files, audio->resampledFiles, (double)audio->frames / sampleRate, NsPerFrame(audio->trackMixNs, audio->frames), audio->peakVoices);
+		}
+	}
+}
+
+void TrackProfiler::WriteJson(FILE *f) const {
+	fprintf(f, "{\n  \"rate\": %d,\n  \"seed\": %u,\n  \"elapsedSeconds\": %.3f,\n  \"tracks\": [", sampleRate, seed, elapsedSeconds);
+
+	for (size_t i=0; i<results.size(); i++) {
+		const profileTrackResult& r = results[i];
+		fprintf(f, "%s\n    {\"track\": ", i ? "," : "");
+		CliJsonString(f, r.trackName);
+		fprintf(f, ", \"seconds\": %.3f, \"mixNsPerFrame\": %.3f, \"worstBlockNsPerFrame\": %.3f, \"updateNsPerFrame\": %.3f, ", (double)r.frames / sampleRate, NsPerFrame(r.mixNs, r.frames), r.worstBlockNsPerFrame, NsPerFrame(r.updateNs, r.frames));
+		fprintf(f, "\"peakVoices\": %d, \"peakFilesReferenced\": %d, \"mixAllocs\": %llu, \"mixAllocBytes\": %llu, \"audios\": [", r.peakVoices, r.peakFilesReferenced, (unsigned long long)r.mixAllocs, (unsigned long long)r.mixAllocBytes);
+
+		for (size_t j=0; j<r.audios.size(); j++) {
+			const profileAudioResult& a = r.audios[j];
+			fprintf(f, "%s\n      {\"audio\": ", j ? "," : "");
+			CliJsonString(f, a.audioName);
+			fprintf(f, ", \"files\": %d, \"resampledFiles\": %d, \"seconds\": %.3f, \"trackMixNsPerFrameWhilePlaying\": %.3f, \"peakVoices\": %d}", a.files, a.resampledFiles, (double)a.frames / sampleRate, NsPerFrame(a.trackMixNs, a.frames), a.peakVoices);
+		}
+		fprintf(f, "\n    ]}");
+	}
+
+	fprintf(f, "\n  ]\n}\n");
+}
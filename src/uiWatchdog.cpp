@@ -0,0 +1,193 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "oamlCommon.h"
+
+
+// Must be created on the ui thread, that's the thread it watches
+UiWatchdog::UiWatchdog(wxFrame *_frame) : frame(_frame), quit(false) {
+	uiScope = TraceGetScopeName();
+
+	pendingMs = -1;
+	lastBeatMs = NowMs();
+	lastStatusMs = 0;
+	memset(&histogram, 0, sizeof(histogram));
+
+	Bind(EVENT_UI_HEARTBEAT, &UiWatchdog::OnHeartbeat, this);
+
+	thread = std::thread(&UiWatchdog::Run, this);
+}
+
+UiWatchdog::~UiWatchdog() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	cond.notify_all();
+	thread.join();
+}
+
+double UiWatchdog::NowMs() {
+	return TraceNowNs() / 1000000.0;
+}
+
+void UiWatchdog::Run() {
+	TraceSetThreadName("ui watchdog");
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while (quit == false) {
+		cond.wait_for(lock, std::chrono::milliseconds(UI_SAMPLE_MS));
+		if (quit)
+			break;
+
+		double now = NowMs();
+		if (pendingMs < 0) {
+			if (now - lastBeatMs >= UI_HEARTBEAT_MS) {
+				pendingMs = now;
+				wxQueueEvent(this, new wxThreadEvent(EVENT_UI_HEARTBEAT));
+
+				// Memory graphs for the trace, one sample per heartbeat
+				MemTraceCounters();
+			}
+		} else if (now - pendingMs >= UI_STALL_MS) {
+			samples[uiScope->load(std::memory_order_relaxed)]++;
+		}
+	}
+}
+
+void UiWatchdog::OnHeartbeat(wxThreadEvent& WXUNUSED(event)) {
+	double now = NowMs();
+	bool stalled = false;
+	uiStall stall;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (pendingMs < 0)
+			return;
+
+		double ms = now - pendingMs;
+
+		int bucket = 0;
+		while (bucket < UI_LATENCY_BUCKETS - 1 && ms >= (double)(1 << bucket)) {
+			bucket++;
+		}
+		histogram.counts[bucket]++;
+		histogram.total++;
+		histogram.sumMs+= ms;
+		if (ms > histogram.maxMs) histogram.maxMs = ms;
+
+		if (ms >= UI_STALL_MS) {
+			// Blame the scope seen most often while the heartbeat waited
+			const char *scope = NULL;
+			int best = 0;
+			stall.samples = 0;
+			for (std::map<const char*, int>::iterator it=samples.begin(); it!=samples.end(); ++it) {
+				stall.samples+= it->second;
+				if (it->first && it->second > best) {
+					scope = it->first;
+					best = it->second;
+				}
+			}
+
+			stall.startMs = pendingMs;
+			stall.durationMs = ms;
+			stall.scope = scope ? scope : "(untraced code)";
+
+			if (stalls.size() >= UI_STALL_HISTORY) {
+				stalls.erase(stalls.begin());
+			}
+			stalls.push_back(stall);
+			stalled = true;
+		}
+
+		samples.clear();
+		pendingMs = -1;
+		lastBeatMs = now;
+	}
+
+	if (stalled) {
+		fprintf(stderr, "oamlStudio: ui stalled for %.0f ms in %s\n", stall.durationMs, stall.scope.c_str());
+		if (TraceIsRecording()) {
+			TraceRecord("ui stall", (uint64_t)(stall.startMs * 1000000.0), (uint64_t)(now * 1000000.0));
+		}
+	}
+
+	if (stalled || now - lastStatusMs >= 1000) {
+		lastStatusMs = now;
+		UpdateStatus();
+	}
+}
+
+void UiWatchdog::UpdateStatus() {
+	uiLatencyHistogram hist;
+	std::vector<uiStall> list;
+	GetHistogram(hist);
+	GetStalls(list);
+
+	wxString str = wxString::Format("UI p50 %.0f p99 %.0f max %.0f ms", GetPercentileMs(hist, 50), GetPercentileMs(hist, 99), hist.maxMs);
+	if (list.size() > 0) {
+		const uiStall& last = list[list.size()-1];
+		str+= wxString::Format(", %d stalls, last %.0f ms in %s", (int)list.size(), last.durationMs, last.scope.c_str());
+	}
+
+	frame->SetStatusText(str, 1);
+}
+
+void UiWatchdog::GetHistogram(uiLatencyHistogram& out) {
+	std::lock_guard<std::mutex> lock(mutex);
+	out = histogram;
+}
+
+void UiWatchdog::GetStalls(std::vector<uiStall>& out) {
+	std::lock_guard<std::mutex> lock(mutex);
+	out = stalls;
+}
+
+void UiWatchdog::Reset() {
+	std::lock_guard<std::mutex> lock(mutex);
+	memset(&histogram, 0, sizeof(histogram));
+	stalls.clear();
+}
+
+// Upper bound of the bucket holding the p-th percentile, capped at the max
+double UiWatchdog::GetPercentileMs(const uiLatencyHistogram& hist, double p) {
+	if (hist.total == 0)
+		return 0;
+
+	uint64_t target = (uint64_t)(hist.total * p / 100.0);
+	if (target >= hist.total) target = hist.total - 1;
+
+	uint64_t count = 0;
+	for (int i=0; i<UI_LATENCY_BUCKETS; i++) {
+		count+= hist.counts[i];
+		if (count > target) {
+			double ms = (double)(1 << i);
+			return ms < hist.maxMs ? ms : hist.maxMs;
+		}
+	}
+
+	return hist.maxMs;
+}
@@ -23,12 +23,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 
-#include "oamlCommon.h"
+#include "oamlCore.h"
 
 enum {
 	WAVE_ID = 0x45564157,
 	RIFF_ID = 0x46464952,
+	RF64_ID = 0x34364652,
+	DS64_ID = 0x34367364,
 	FMT_ID  = 0x20746d66,
 	DATA_ID = 0x61746164,
 	CUE_ID  = 0x20657563,
@@ -69,6 +72,10 @@ wavFile::wavFile(oamlFileCallbacks *cbs) : audioFile(cbs) {
 
 	chunkSize = 0;
 	status = 0;
+
+	dataOffset = 0;
+	dataSize = 0;
+	ds64DataSize = 0;
 }
 
 wavFile::~wavFile() {
@@ -112,6 +119,7 @@ int wavFile::ReadChunk() {
 
 	switch (header.id) {
 		case RIFF_ID:
+		case RF64_ID:
 			int waveId;
 			if (fcbs->read(&waveId, 1, sizeof(int), fd) != sizeof(int))
 				return -1;
@@ -121,12 +129,36 @@ int wavFile::ReadChunk() {
 				return -1;
 			break;
 
+		case DS64_ID: {
+			// RF64 keeps the real data size here, the data chunk says 0xFFFFFFFF
+			unsigned char ds64[16];
+			if (header.size < sizeof(ds64) || fcbs->read(ds64, 1, sizeof(ds64), fd) != sizeof(ds64))
+				return -1;
+
+			ds64DataSize = 0;
+			for (int i=7; i>=0; i--) {
+				ds64DataSize = (ds64DataSize << 8) | ds64[8 + i];
+			}
+			fcbs->seek(fd, header.size - sizeof(ds64), SEEK_CUR);
+			break;
+		}
+
 		case FMT_ID:
 			fmtHeader fmt;
 			if (fcbs->read(&fmt, 1, sizeof(fmtHeader), fd) != sizeof(fmtHeader))
 				return -1;
 
-			if (header.size > sizeof(fmtHeader)) {
+			if (fmt.formatTag == 0xfffe && header.size >= sizeof(fmtHeader) + 24) {
+				// WAVE_FORMAT_EXTENSIBLE, the real format tag starts the subformat guid
+				unsigned char ext[24];
+				if (fcbs->read(ext, 1, sizeof(ext), fd) != sizeof(ext))
+					return -1;
+
+				fmt.formatTag = ext[8] | (ext[9] << 8);
+				if (header.size > sizeof(fmtHeader) + sizeof(ext)) {
+					fcbs->seek(fd, header.size - sizeof(fmtHeader) - sizeof(ext), SEEK_CUR);
+				}
+			} else if (header.size > sizeof(fmtHeader)) {
 				fcbs->seek(fd, header.size - sizeof(fmtHeader), SEEK_CUR);
 			}
 
@@ -152,8 +184,14 @@ int wavFile::ReadChunk() {
 			break;
 
 		case DATA_ID:
-			chunkSize = header.size;
-			totalSamples = chunkSize / (bitsPerSample/8);
+			dataOffset = fcbs->tell(fd);
+			dataSize = ClampToFile(header.size == 0xFFFFFFFF && ds64DataSize > 0 ? (int64_t)ds64DataSize : (int64_t)header.size);
+			chunkSize = dataSize;
+			if (bitsPerSample < 8 || dataSize / (bitsPerSample/8) > INT_MAX) {
+				fprintf(stderr, "wav: Unsupported data size\n");
+				return -1;
+			}
+			totalSamples = (int)(dataSize / (bitsPerSample/8));
 			status = 2;
 			break;
 
@@ -169,12 +207,21 @@ int wavFile::Read(char *buffer, int size) {
 	if (fd == NULL)
 		return -1;
 
+	// Whatever follows the data chunk isn't audio
+	if (status == 3)
+		return 0;
+
 	int bytesRead = 0;
 	while (size > 0) {
 		// Are we inside a data chunk?
 		if (status == 2) {
+			if (chunkSize <= 0) {
+				status = 3;
+				break;
+			}
+
 			// Let's keep reading data!
-			int ret = fcbs->read(buffer, 1, size, fd);
+			int ret = fcbs->read(buffer, 1, size < chunkSize ? size : (int)chunkSize, fd);
 			if (ret == 0) {
 				status = 3;
 				break;
@@ -193,49 +240,46 @@ int wavFile::Read(char *buffer, int size) {
 	return bytesRead;
 }
 
+int wavFile::SeekFrame(int64_t frame) {
+	if (fd == NULL || status < 2)
+		return -1;
+
+	int frameBytes = GetFrameBytes();
+	if (frame < 0 || frameBytes <= 0 || frame * frameBytes > dataSize)
+		return -1;
+
+	// Samples are fixed size, the frame is right where the arithmetic says.
+	// The file callbacks take a long, which may not reach that far.
+	int64_t pos = dataOffset + frame * frameBytes;
+	if (pos > LONG_MAX || fcbs->seek(fd, (long)pos, SEEK_SET) != 0)
+		return -1;
+
+	chunkSize = dataSize - frame * frameBytes;
+	status = 2;
+	return 0;
+}
+
 void wavFile::WriteToFile(const char *filename, ByteBuffer *buffer, int channels, unsigned int sampleRate, int bytesPerSample) {
 	ASSERT(filename != NULL);
 	ASSERT(buffer != NULL);
 
-	FILE *f = fopen(filename, "wb");
-	if (f == NULL)
+	wavWriter writer;
+	if (writer.Open(filename, channels, sampleRate, wavWriter::FormatFromBytesPerSample(bytesPerSample)) == -1)
 		return;
 
-	riffHeader riff = {
-		RIFF_ID,
-		36 + buffer->bytesRemaining(),
-		WAVE_ID,
-	};
-
-	wavHeader fmtHead = {
-		FMT_ID,
-		16,
-	};
-
-	fmtHeader fmt = {
-		1,
-		(unsigned short)(channels),
-		sampleRate,
-		sampleRate * channels * bytesPerSample,
-		(unsigned short)(channels * bytesPerSample),
-		(unsigned short)(8 * bytesPerSample),
-	};
-
-	wavHeader data = {
-		DATA_ID,
-		buffer->bytesRemaining(),
-	};
-
-	fwrite(&riff, 1, sizeof(riff), f);
-	fwrite(&fmtHead, 1, sizeof(fmtHead), f);
-	fwrite(&fmt, 1, sizeof(fmt), f);
-	fwrite(&data, 1, sizeof(data), f);
+	uint8_t block[65536];
 	while (buffer->bytesRemaining() > 0) {
-		unsigned char byte = buffer->get();
-		fwrite(&byte, 1, sizeof(byte), f);
+		uint32_t pos = buffer->getReadPos();
+		uint32_t size = buffer->bytesRemaining() > sizeof(block) ? sizeof(block) : buffer->bytesRemaining();
+
+		buffer->getBytes(block, size);
+		buffer->setReadPos(pos + size);
+
+		if (writer.Write(block, size) == -1)
+			break;
 	}
 
-	fclose(f);
+	writer.Close();
 }
 
 void wavFile::Close() {
@@ -0,0 +1,301 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2016 Marcelo Fernandez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "oamlCore.h"
+
+#ifdef _MSC_VER
+#define wavSeek _fseeki64
+#else
+#define wavSeek fseeko
+#endif
+
+// Big writes go straight to disk through a large stdio buffer
+#define WAV_WRITE_BUFFER	(1024 * 1024)
+
+// Body of a ds64 chunk: riff size, data size, sample count and an empty table
+#define DS64_SIZE	28
+
+static const uint8_t subformatPcm[16] = {
+	0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71
+};
+
+static const uint8_t subformatFloat[16] = {
+	0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71
+};
+
+// Default speaker layouts of WAVE_FORMAT_EXTENSIBLE by channel count: mono,
+// stereo, 3.0, quad, 5.0, 5.1, 6.1 and 7.1. Wider files leave them unassigned.
+static const uint32_t channelMasks[9] = {
+	0, 0x4, 0x3, 0x7, 0x33, 0x37, 0x3f, 0x13f, 0x63f
+};
+
+static void put16(uint8_t *p, uint16_t v) {
+	p[0] = v & 0xff;
+	p[1] = (v >> 8) & 0xff;
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+	for (int i=0; i<4; i++) p[i] = (v >> (i * 8)) & 0xff;
+}
+
+static void put64(uint8_t *p, uint64_t v) {
+	for (int i=0; i<8; i++) p[i] = (v >> (i * 8)) & 0xff;
+}
+
+
+wavWriter::wavWriter() {
+	f = NULL;
+	format = AF_FORMAT_SINT16;
+	channels = 0;
+	sampleRate = 0;
+	bytesPerSample = 2;
+	junkPos = 0;
+	dataPos = 0;
+	dataBytes = 0;
+}
+
+wavWriter::~wavWriter() {
+	Close();
+}
+
+int wavWriter::FormatFromBytesPerSample(int bytes) {
+	switch (bytes) {
+		case 3: return AF_FORMAT_SINT24;
+		case 4: return AF_FORMAT_SINT32;
+		default: return AF_FORMAT_SINT16;
+	}
+}
+
+int wavWriter::Open(const char *filename, int _channels, unsigned int _sampleRate, int _format) {
+	ASSERT(filename != NULL);
+
+	Close();
+
+	switch (_format) {
+		case AF_FORMAT_SINT16: bytesPerSample = 2; break;
+		case AF_FORMAT_SINT24: bytesPerSample = 3; break;
+		case AF_FORMAT_SINT32: bytesPerSample = 4; break;
+		case AF_FORMAT_FLOAT32: bytesPerSample = 4; break;
+		default:
+			return -1;
+	}
+
+	f = fopen(filename, "wb");
+	if (f == NULL)
+		return -1;
+
+	setvbuf(f, NULL, _IOFBF, WAV_WRITE_BUFFER);
+
+	format = _format;
+	channels = _channels;
+	sampleRate = _sampleRate;
+	dataBytes = 0;
+
+	if (WriteHeader() == -1) {
+		fclose(f);
+		f = NULL;
+		return -1;
+	}
+
+	return 0;
+}
+
+int wavWriter::WriteHeader() {
+	uint8_t buf[128];
+	uint8_t *p = buf;
+
+	// RIFF header, sizes are filled in by FinishHeader
+	memcpy(p, "RIFF", 4); put32(p + 4, 0); memcpy(p + 8, "WAVE", 4);
+	p+= 12;
+
+	// Room for a ds64 chunk in case this turns into RF64
+	junkPos = p - buf;
+	memcpy(p, "JUNK", 4); put32(p + 4, DS64_SIZE);
+	memset(p + 8, 0, DS64_SIZE);
+	p+= 8 + DS64_SIZE;
+
+	// WAVE_FORMAT_EXTENSIBLE is required past 16 bits or 2 channels
+	bool isFloat = format == AF_FORMAT_FLOAT32;
+	bool extensible = bytesPerSample > 2 || channels > 2;
+	uint16_t blockAlign = channels * bytesPerSample;
+
+	memcpy(p, "fmt ", 4);
+	put32(p + 4, extensible ? 40 : (isFloat ? 18 : 16));
+	put16(p + 8, extensible ? 0xfffe : (isFloat ? 3 : 1));
+	put16(p + 10, channels);
+	put32(p + 12, sampleRate);
+	put32(p + 16, sampleRate * blockAlign);
+	put16(p + 20, blockAlign);
+	put16(p + 22, bytesPerSample * 8);
+	p+= 24;
+
+	if (extensible) {
+		put16(p, 22);
+		put16(p + 2, bytesPerSample * 8);
+		put32(p + 4, channels > 0 && channels <= 8 ? channelMasks[channels] : 0);
+		memcpy(p + 8, isFloat ? subformatFloat : subformatPcm, 16);
+		p+= 24;
+	} else if (isFloat) {
+		put16(p, 0);
+		p+= 2;
+	}
+
+	memcpy(p, "data", 4); put32(p + 4, 0);
+	p+= 8;
+
+	dataPos = p - buf;
+	return fwrite(buf, 1, p - buf, f) == (size_t)(p - buf) ? 0 : -1;
+}
+
+int wavWriter::Write(const void *data, int bytes) {
+	if (f == NULL || bytes < 0)
+		return -1;
+
+	if (fwrite(data, 1, bytes, f) != (size_t)bytes)
+		return -1;
+
+	dataBytes+= bytes;
+	return bytes;
+}
+
+int wavWriter::WriteInt16(const int16_t *samples, int count) {
+	if (format == AF_FORMAT_SINT16)
+		return Write(samples, count * 2);
+
+	scratch.resize(count * bytesPerSample);
+	uint8_t *p = &scratch[0];
+	for (int i=0; i<count; i++) {
+		int32_t s = samples[i];
+		switch (format) {
+			case AF_FORMAT_SINT24:
+				p[0] = 0;
+				p[1] = s & 0xff;
+				p[2] = (s >> 8) & 0xff;
+				break;
+
+			case AF_FORMAT_SINT32:
+				put32(p, (uint32_t)(uint16_t)s << 16);
+				break;
+
+			case AF_FORMAT_FLOAT32:
+				{ float v = s / 32768.0f;
+				memcpy(p, &v, 4);
+				} break;
+		}
+		p+= bytesPerSample;
+	}
+
+	return Write(&scratch[0], count * bytesPerSample);
+}
+
+int wavWriter::WriteFloat(const float *samples, int count) {
+	if (format == AF_FORMAT_FLOAT32)
+		return Write(samples, count * 4);
+
+	scratch.resize(count * bytesPerSample);
+	uint8_t *p = &scratch[0];
+	for (int i=0; i<count; i++) {
+		float v = samples[i];
+		if (v > 1.0f) v = 1.0f;
+		if (v < -1.0f) v = -1.0f;
+
+		switch (format) {
+			case AF_FORMAT_SINT16:
+				put16(p, (uint16_t)(int16_t)(v * 32767.0f));
+				break;
+
+			case AF_FORMAT_SINT24:
+				{ int32_t s = (int32_t)(v * 8388607.0f);
+				p[0] = s & 0xff;
+				p[1] = (s >> 8) & 0xff;
+				p[2] = (s >> 16) & 0xff;
+				} break;
+
+			case AF_FORMAT_SINT32:
+				put32(p, (uint32_t)(int32_t)(v * 2147483647.0));
+				break;
+		}
+		p+= bytesPerSample;
+	}
+
+	return Write(&scratch[0], count * bytesPerSample);
+}
+
+int wavWriter::FinishHeader() {
+	// Chunks are word aligned
+	if (dataBytes & 1) {
+		fputc(0, f);
+	}
+
+	unsigned long long riffBytes = dataPos - 8 + dataBytes + (dataBytes & 1);
+	uint8_t buf[8 + DS64_SIZE];
+
+	if (riffBytes <= 0xffffffffULL) {
+		put32(buf, (uint32_t)riffBytes);
+		if (wavSeek(f, 4, SEEK_SET) != 0 || fwrite(buf, 1, 4, f) != 4)
+			return -1;
+
+		put32(buf, (uint32_t)dataBytes);
+		if (wavSeek(f, dataPos - 4, SEEK_SET) != 0 || fwrite(buf, 1, 4, f) != 4)
+			return -1;
+
+		return 0;
+	}
+
+	// Too big for RIFF, the real sizes go into the ds64 chunk
+	memcpy(buf, "RF64", 4);
+	put32(buf + 4, 0xffffffff);
+	if (wavSeek(f, 0, SEEK_SET) != 0 || fwrite(buf, 1, 8, f) != 8)
+		return -1;
+
+	memcpy(buf, "ds64", 4);
+	put32(buf + 4, DS64_SIZE);
+	put64(buf + 8, riffBytes);
+	put64(buf + 16, dataBytes);
+	put64(buf + 24, dataBytes / (channels * bytesPerSample));
+	put32(buf + 32, 0);
+	if (wavSeek(f, junkPos, SEEK_SET) != 0 || fwrite(buf, 1, sizeof(buf), f) != sizeof(buf))
+		return -1;
+
+	put32(buf, 0xffffffff);
+	if (wavSeek(f, dataPos - 4, SEEK_SET) != 0 || fwrite(buf, 1, 4, f) != 4)
+		return -1;
+
+	return 0;
+}
+
+int wavWriter::Close() {
+	if (f == NULL)
+		return 0;
+
+	int ret = FinishHeader();
+	if (fclose(f) != 0) {
+		ret = -1;
+	}
+	f = NULL;
+
+	return ret;
+}
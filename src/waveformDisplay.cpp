@@ -52,14 +52,41 @@ void RenderTimer::Notify() {
 }
 
 
-WaveformDisplay::WaveformDisplay(wxFrame* parent) : wxPanel(parent) {
+PlayheadTimer::PlayheadTimer(WaveformDisplay* pane) : wxTimer() {
+	PlayheadTimer::pane = pane;
+}
+
+void PlayheadTimer::Notify() {
+	pane->UpdatePlayhead();
+}
+
+
+WaveformDisplay::WaveformDisplay(wxFrame* parent) : wxPanel(parent), cacheMem(MEM_WIDGETS) {
 	handle = NULL;
 	timer = NULL;
+	playheadTimer = NULL;
+	previewSession = 0;
+	skipLeftUp = false;
+	cacheValid = false;
+	msPerBar = 0;
+	playX = -1;
+	playBar = -1;
+	barX0 = 0;
+	barX1 = 0;
+	selected = false;
+	decoded = false;
+	bytesPerSec = 0;
+	samplesPerPixel = 1;
+
+	MemAddObjects(MEM_WIDGETS, "WaveformDisplay", 1);
 
 	Bind(wxEVT_PAINT, &WaveformDisplay::OnPaint, this);
 	Bind(wxEVT_LEFT_UP, &WaveformDisplay::OnLeftUp, this);
+	Bind(wxEVT_LEFT_DCLICK, &WaveformDisplay::OnLeftDClick, this);
 	Bind(wxEVT_RIGHT_UP, &WaveformDisplay::OnRightUp, this);
 	Bind(wxEVT_COMMAND_MENU_SELECTED, &WaveformDisplay::OnMenuEvent, this, ID_RemoveAudio);
+	Bind(wxEVT_COMMAND_MENU_SELECTED, &WaveformDisplay::OnMenuEvent, this, ID_AuditionAudio);
+	Bind(wxEVT_COMMAND_MENU_SELECTED, &WaveformDisplay::OnMenuEvent, this, ID_StopAudition);
 	Bind(wxEVT_ERASE_BACKGROUND, &WaveformDisplay::OnEraseBackground, this);
 }
 
@@ -69,86 +96,53 @@ WaveformDisplay::~WaveformDisplay() {
 		timer = NULL;
 	}
 
+	if (playheadTimer) {
+		if (IsAuditioning()) {
+			studioAudio->GetPreview()->Stop();
+		}
+
+		delete playheadTimer;
+		playheadTimer = NULL;
+	}
+
 	if (handle) {
 		delete handle;
 		handle = NULL;
 	}
-}
-
-int WaveformDisplay::read32() {
-	int ret = 0;
-
-	ASSERT(handle != NULL);
-
-	switch (handle->GetFormat()) {
-		case AF_FORMAT_SINT8:
-			ret|= ((unsigned int)buffer.get())<<23;
-			break;
-
-		case AF_FORMAT_SINT16:
-			ret|= ((unsigned int)buffer.getShort())<<16;
-			break;
 
-		case AF_FORMAT_SINT24:
-			ret|= ((unsigned int)buffer.get())<<8;
-			ret|= ((unsigned int)buffer.get())<<16;
-			ret|= ((unsigned int)buffer.get())<<24;
-			break;
-
-		case AF_FORMAT_SINT32:
-			ret|= ((unsigned int)buffer.getInt());
-			break;
-
-		case AF_FORMAT_FLOAT32:
-			ret|= ((int)(buffer.getFloat() * 8388608) & 0x00ffffff);
-			break;
-	}
-
-	return ret;
+	MemAddObjects(MEM_WIDGETS, "WaveformDisplay", -1);
 }
 
 void WaveformDisplay::SetSource(std::string _filename, std::string _audioName, bool sfxMode) {
+	TRACE_SCOPE("WaveformDisplay::SetSource");
 	filename = _filename;
 	audioName = _audioName;
 
-	buffer.clear();
-	peaksL.clear();
-	peaksR.clear();
-	peakl = 0;
-	peakr = 0;
-	count = 0;
-
-	std::string ext = filename.substr(filename.find_last_of(".") + 1);
-	if (ext == "ogg") {
-		handle = (audioFile*)new oggFile(&studioCbs);
-	} else if (ext == "aif" || ext == "aiff") {
-		handle = (audioFile*)new aifFile(&studioCbs);
-	} else if (ext == "wav" || ext == "wave") {
-		handle = new wavFile(&studioCbs);
-	} else {
+	decoded = false;
+	cacheValid = false;
+
+	peaks.SetMemoryFile(filename);
+	cacheMem.SetFile(filename);
+
+	if (handle) {
+		delete handle;
+	}
+
+	handle = CreateAudioFile(filename, &studioCbs);
+	if (handle == NULL) {
 		fprintf(stderr, "oamlStudio: Unknown audio format: '%s'\n", filename.c_str());
 		return;
 	}
 
-	if (handle == NULL || handle->Open(filename.c_str()) == -1) {
+	if (handle->Open(filename.c_str()) == -1) {
 		fprintf(stderr, "oamlStudio: Error opening: '%s'\n", filename.c_str());
 		return;
 	}
 
-	int samplesDiv;
 	int w = 1;
-	if (sfxMode) {
-		samplesDiv = 1000;
-	} else {
-		unsigned int totalSecs = (handle->GetTotalSamples() / handle->GetChannels()) / handle->GetSamplesPerSec();
-		if (totalSecs < 10) {
-			samplesDiv = 20;
-		} else {
-			samplesDiv = 10;
-		}
-	}
+	samplesPerPixel = PeakBuilder::GetSamplesPerPixel(handle, sfxMode, &w);
+	MemSetDecodedSize(filename, (int64_t)handle->GetTotalSamples() * handle->GetBytesPerSample());
 
-	w = (handle->GetTotalSamples() / handle->GetChannels()) / (handle->GetSamplesPerSec() / samplesDiv);
 	wxSize size(w, 100);
 	SetSize(size);
 	SetMinSize(size);
@@ -156,6 +150,17 @@ void WaveformDisplay::SetSource(std::string _filename, std::string _audioName, b
 
 	PostSizeEventToParent();
 
+	peaks.Reset(handle->GetFormat(), handle->GetBytesPerSample(), samplesPerPixel);
+
+	// The project loader usually has the peaks ready for us already
+	if (peakCache.Get(filename, samplesPerPixel, peaks.GetPeaksL(), peaks.GetPeaksR())) {
+		peaks.UpdateMemory();
+		decoded = true;
+		Refresh();
+		SetStatusText(_("Ready"));
+		return;
+	}
+
 	bytesPerSec = handle->GetSamplesPerSec() * handle->GetBytesPerSample() * handle->GetChannels();
 
 	if (timer == NULL) {
@@ -164,18 +169,159 @@ void WaveformDisplay::SetSource(std::string _filename, std::string _audioName, b
 
 	timer->Start(10);
 
-//	topWnd->SetStatusText(_("Reading.."));
+	SetStatusText(_("Reading.."));
+}
+
+void WaveformDisplay::OnLeftUp(wxMouseEvent& evt) {
+	TRACE_SCOPE("WaveformDisplay::OnLeftUp");
+	// While auditioning, clicking moves the playback position. The button
+	// release ending a double click already started it right there.
+	if (skipLeftUp) {
+		skipLeftUp = false;
+	} else if (IsAuditioning()) {
+		studioAudio->GetPreview()->Seek(previewSession, (long long)evt.GetX() * samplesPerPixel);
+		UpdatePlayhead();
+	}
+
+	// Ctrl/Cmd or Shift click adds/removes us from the current selection
+	eventBus->PostSelectAudio(audioName, filename, evt.CmdDown() || evt.ShiftDown());
+}
+
+void WaveformDisplay::OnLeftDClick(wxMouseEvent& evt) {
+	TRACE_SCOPE("WaveformDisplay::OnLeftDClick");
+	skipLeftUp = true;
+	Audition((long long)evt.GetX() * samplesPerPixel);
+}
+
+void WaveformDisplay::Audition(long long frame) {
+	if (handle == NULL)
+		return;
+
+	if (studioAudio == NULL || studioAudio->IsOpen() == false) {
+		SetStatusText(_("Auditioning needs the studio audio device"));
+		return;
+	}
+
+	previewSession = studioAudio->GetPreview()->Play(filename, frame);
+
+	if (playheadTimer == NULL) {
+		playheadTimer = new PlayheadTimer(this);
+	}
+	playheadTimer->Start(PLAYHEAD_RATE);
+	UpdatePlayhead();
+}
+
+bool WaveformDisplay::IsAuditioning() const {
+	return studioAudio && studioAudio->GetPreview()->IsPlaying(previewSession);
+}
+
+void WaveformDisplay::UpdatePlayhead() {
+	if (IsAuditioning()) {
+		SetPlayFrame(studioAudio->GetPreview()->GetPosition());
+	} else {
+		// Finished or another audition took over
+		if (playheadTimer) {
+			playheadTimer->Stop();
+		}
+		SetPlayFrame(-1);
+	}
+}
+
+void WaveformDisplay::SetPlayTime(double ms, double _msPerBar) {
+	// An audition owns the playhead while it lasts
+	if (IsAuditioning())
+		return;
+
+	if (ms < 0 || handle == NULL) {
+		SetPlayFrame(-1);
+		return;
+	}
+
+	msPerBar = _msPerBar;
+
+	int channels = handle->GetChannels() > 0 ? handle->GetChannels() : 1;
+	long long totalFrames = handle->GetTotalSamples() / channels;
+	long long frame = (long long)(ms * handle->GetSamplesPerSec() / 1000.0);
+
+	// Loops start over from the beginning
+	if (totalFrames > 0) {
+		frame%= totalFrames;
+	}
+
+	SetPlayFrame(frame);
 }
 
-void WaveformDisplay::OnLeftUp(wxMouseEvent& WXUNUSED(evt)) {
-	wxCommandEvent event(EVENT_SELECT_AUDIO);
-	event.SetString(wxString(audioName)+wxString(filename));
-	event.SetInt(audioName.length());
-	wxPostEvent(GetParent(), event);
+void WaveformDisplay::SetPlayFrame(long long frame) {
+	int x = -1;
+	int bar = -1;
+	int x0 = 0;
+	int x1 = 0;
+
+	if (frame >= 0 && samplesPerPixel > 0) {
+		x = (int)(frame / samplesPerPixel);
+
+		if (msPerBar > 0 && handle) {
+			double framesPerBar = msPerBar * handle->GetSamplesPerSec() / 1000.0;
+			bar = (int)(frame / framesPerBar);
+			x0 = (int)(bar * framesPerBar / samplesPerPixel);
+			x1 = (int)((bar + 1) * framesPerBar / samplesPerPixel);
+		}
+	}
+
+	if (x == playX && bar == playBar)
+		return;
+
+	// Invalidate where the cursor was and where it goes, nothing else
+	bool barChanged = bar != playBar;
+	RefreshPlayhead(barChanged);
+
+	playX = x;
+	playBar = bar;
+	barX0 = x0;
+	barX1 = x1;
+
+	RefreshPlayhead(barChanged);
+}
+
+void WaveformDisplay::RefreshPlayhead(bool bar) {
+	if (playX < 0)
+		return;
+
+	int h = GetClientSize().GetHeight();
+	RefreshRect(wxRect(playX - 1, 0, 3, h), false);
+
+	if (bar && playBar >= 0) {
+		RefreshRect(wxRect(barX0, 0, barX1 - barX0 + 1, PLAYHEAD_BAR_HEIGHT), false);
+		RefreshRect(wxRect(barX0, h - 20, 40, 20), false);
+	}
+}
+
+void WaveformDisplay::DrawPlayhead(wxDC& dc, int h) {
+	if (playX < 0)
+		return;
+
+	if (playBar >= 0) {
+		dc.SetPen(*wxTRANSPARENT_PEN);
+		dc.SetBrush(wxBrush(wxColor(255, 200, 0)));
+		dc.DrawRectangle(barX0, 0, barX1 - barX0, PLAYHEAD_BAR_HEIGHT);
+
+		dc.SetTextForeground(wxColor(255, 200, 0));
+		dc.DrawText(wxString::Format("%d", playBar + 1), barX0 + 3, h - 18);
+	}
+
+	dc.SetPen(wxPen(wxColor(255, 255, 255), 1));
+	dc.DrawLine(playX, 0, playX, h);
 }
 
 void WaveformDisplay::OnRightUp(wxMouseEvent& WXUNUSED(evt)) {
+	TRACE_SCOPE("WaveformDisplay::OnRightUp");
 	wxMenu menu(wxT(""));
+	if (IsAuditioning()) {
+		menu.Append(ID_StopAudition, wxT("&Stop Audition"));
+	} else {
+		menu.Append(ID_AuditionAudio, wxT("&Audition"));
+	}
+	menu.AppendSeparator();
 //	menu.Append(ID_AddLayer, wxT("&Add Layer"));
 	menu.Append(ID_RemoveAudio, wxT("&Remove Audio"));
 	PopupMenu(&menu);
@@ -185,6 +331,7 @@ void WaveformDisplay::OnEraseBackground(wxEraseEvent& WXUNUSED(evt)) {
 }
 
 void WaveformDisplay::OnMenuEvent(wxCommandEvent& event) {
+	TRACE_SCOPE("WaveformDisplay::OnMenuEvent");
 	switch (event.GetId()) {
 		case ID_AddLayer:
 			{ wxCommandEvent event(EVENT_ADD_LAYER);
@@ -192,6 +339,17 @@ void WaveformDisplay::OnMenuEvent(wxCommandEvent& event) {
 			wxPostEvent(GetParent(), event);
 			} break;
 
+		case ID_AuditionAudio:
+			Audition(0);
+			break;
+
+		case ID_StopAudition:
+			if (IsAuditioning()) {
+				studioAudio->GetPreview()->Stop();
+			}
+			UpdatePlayhead();
+			break;
+
 		case ID_RemoveAudio:
 			{ wxCommandEvent event(EVENT_REMOVE_AUDIO_FILE);
 			event.SetString(wxString(filename));
@@ -201,52 +359,55 @@ void WaveformDisplay::OnMenuEvent(wxCommandEvent& event) {
 }
 
 void WaveformDisplay::OnPaint(wxPaintEvent&  WXUNUSED(evt)) {
+	TRACE_SCOPE("WaveformDisplay::OnPaint");
+	wxPaintDC dc(this);
+
 	if (handle == NULL || handle->GetTotalSamples() == 0)
 		return;
 
-	wxBufferedPaintDC dc(this);
-
-	wxSize size = GetSize();
-	samplesPerPixel = (handle->GetTotalSamples() / handle->GetChannels()) / size.GetWidth();
-
-	char buf[1024];
-	int totalToRead = bytesPerSec;
-	int toRead = totalToRead > 1024 ? 1024 : totalToRead;
-	bool done = false;
-	while (toRead > 0) {
-		int bytesRead = handle->Read(buf, toRead);
-		if (bytesRead <= 0) {
-			done = true;
+	if (decoded == false) {
+		decoded = peaks.Decode(handle, bytesPerSec);
+		if (decoded) {
 			timer->Stop();
-			break;
+			peakCache.Put(filename, samplesPerPixel, peaks.GetPeaksL(), peaks.GetPeaksR());
+			SetStatusText(_("Ready"));
 		}
+		cacheValid = false;
+	}
+
+	wxSize size = GetClientSize();
+	int w = size.GetWidth();
+	int h = size.GetHeight();
+	if (w <= 0 || h <= 0)
+		return;
 
-		buffer.putBytes((uint8_t*)buf, bytesRead);
+	if (cacheValid == false || cache.GetWidth() != w || cache.GetHeight() != h) {
+		RenderCache(w, h);
+	}
 
-		totalToRead-= bytesRead;
-		toRead = totalToRead > 1024 ? 1024 : totalToRead;
+	// Only copy what was invalidated, usually just the strips around the playhead
+	wxMemoryDC memDC(cache);
+	for (wxRegionIterator it(GetUpdateRegion()); it; ++it) {
+		wxRect rect = it.GetRect();
+		dc.Blit(rect.x, rect.y, rect.width, rect.height, &memDC, rect.x, rect.y);
 	}
+	memDC.SelectObject(wxNullBitmap);
 
-	while (buffer.bytesRemaining() >= (uint32_t)(handle->GetBytesPerSample() * 2)) {
-		int sl = abs(read32() >> 16);
-		int sr = abs(read32() >> 16);
+	DrawPlayhead(dc, h);
+}
 
-		if (sl > peakl) peakl = sl;
-		if (sr > peakr) peakr = sr;
-		count++;
+void WaveformDisplay::RenderCache(int w, int h) {
+	TRACE_SCOPE("WaveformDisplay::RenderCache");
+	if (cache.IsOk() == false || cache.GetWidth() != w || cache.GetHeight() != h) {
+		cache.Create(w, h);
+		cacheMem.Set((int64_t)w * h * 4);
+	}
 
-		if (count > samplesPerPixel) {
-			peaksL.push_back(peakl);
-			peaksR.push_back(peakr);
+	wxMemoryDC dc(cache);
 
-			peakl = 0;
-			peakr = 0;
-			count = 0;
-		}
-	}
+	std::vector<int>& peaksL = peaks.GetPeaksL();
+	std::vector<int>& peaksR = peaks.GetPeaksR();
 
-	int w = size.GetWidth();
-	int h = size.GetHeight();
 	int h2 = h/2;
 
 	dc.SetBrush(*wxBLACK_BRUSH);
@@ -269,15 +430,25 @@ void WaveformDisplay::OnPaint(wxPaintEvent&  WXUNUSED(evt)) {
 	dc.SetTextForeground(wxColor(228, 228, 228));
 	dc.DrawText(filename.c_str(), 10, 10);
 
-	if (done) {
-		SetStatusText(_("Ready"));
-	} else {
-		SetStatusText(_("Reading.."));
+	if (selected) {
+		dc.SetBrush(*wxTRANSPARENT_BRUSH);
+		dc.SetPen(wxPen(wxColor(255, 200, 0), 3));
+		dc.DrawRectangle(0, 0, w, h);
 	}
+
+	dc.SelectObject(wxNullBitmap);
+	cacheValid = true;
+}
+
+void WaveformDisplay::SetSelected(bool value) {
+	if (selected == value)
+		return;
+
+	selected = value;
+	cacheValid = false;
+	Refresh();
 }
 
 void WaveformDisplay::SetStatusText(wxString status) {
-	wxCommandEvent event(EVENT_SET_STATUS_TEXT);
-	event.SetString(status);
-	wxPostEvent(GetParent(), event);
+	eventBus->PostStatusText(status);
 }